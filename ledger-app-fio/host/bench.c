@@ -0,0 +1,247 @@
+// Microbenchmarks of the pure-C kernels of the app core on the host, see README.md.
+//
+//   ./build/bench                    prints ns/op and writes build/bench.json
+//   ./build/bench baseline.json      writes the results elsewhere
+//
+// Heap allocations are counted by wrapping malloc (see the Makefile),
+// the firmware has no heap so every kernel should report 0.
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "os.h"
+#include "io.h"
+#include "bip44.h"
+#include "eos_utils.h"
+#include "fio.h"
+#include "hexUtils.h"
+#include "textUtils.h"
+#include "txParser.h"
+
+// keep each measurement at least this long
+#define MIN_DURATION_NS 100000000ull
+
+static volatile size_t allocations;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size)
+{
+	allocations++;
+	return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+	allocations++;
+	return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+	allocations++;
+	return __real_realloc(ptr, size);
+}
+
+// results are written here so that the kernels cannot be optimized away
+static volatile uint8_t sink;
+
+// inputs decoded once by setup()
+static uint8_t publicKey[65];
+static uint8_t compressedKeyWithChecksum[37];
+static uint8_t derSignature[72];
+static uint8_t transferTx[300];
+static size_t transferTxSize;
+static uint8_t twoTransfersTx[300];
+static size_t twoTransfersTxSize;
+
+// the transfer of txParser_test.c
+#define TX_HEADER_HEX "1c312a6122116655443300000000"
+#define TRANSFER_HEX \
+	"0000980ad20ca85be0e1d195ba85e7cd" \
+	"01" "2084460d5fe5f332" "00000000a8ed3232" \
+	"5d" \
+	"35" "46494f385052653457525a4a6a356d6b656d367156474b79764e466750734e6e6a4e4e366b50686836456143707a4356696e354a6a" \
+	"1400000000000000" "4433221100000000" \
+	"2084460d5fe5f332" \
+	"0e" "726577617264734077616c6c6574"
+
+static void setup()
+{
+	decode_hex(
+	        "04"
+	        "9d4b7f8a6d9c5b8c0d5b6f0f3ac8d0f7a0e6b1a4f9e2b9c3e8d1c6f2a5b4e3d2"
+	        "11c2d3e4f5a6b7c8d9e0f1a2b3c4d5e6f7a8b9c0d1e2f3a4b5c6d7e8f9a0b1c2",
+	        publicKey, sizeof(publicKey)
+	);
+	decode_hex(
+	        "039d4b7f8a6d9c5b8c0d5b6f0f3ac8d0f7a0e6b1a4f9e2b9c3e8d1c6f2a5b4e3d2" "1a2b3c4d",
+	        compressedKeyWithChecksum, sizeof(compressedKeyWithChecksum)
+	);
+	decode_hex(
+	        "3045"
+	        "0221" "00e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"
+	        "0220" "2cf24dba5fb0a30e26e83b2ac5b9e29e1b161e5c1fa7425e73043362938b9824",
+	        derSignature, sizeof(derSignature)
+	);
+	transferTxSize = decode_hex(TX_HEADER_HEX "01" TRANSFER_HEX "00", transferTx, sizeof(transferTx));
+	twoTransfersTxSize = decode_hex(
+	                             TX_HEADER_HEX "02" TRANSFER_HEX TRANSFER_HEX "00",
+	                             twoTransfersTx, sizeof(twoTransfersTx)
+	                     );
+}
+
+static void bench_b58enc()
+{
+	char out[60];
+	uint32_t outSize = sizeof(out);
+	b58enc(compressedKeyWithChecksum, sizeof(compressedKeyWithChecksum), out, &outSize);
+	sink = out[0];
+}
+
+static void bench_public_key_to_wif()
+{
+	char out[60];
+	public_key_to_wif(publicKey, sizeof(publicKey), out, sizeof(out));
+	sink = out[0];
+}
+
+static void bench_name_to_string()
+{
+	char out[NAME_STRING_MAX_LENGTH];
+	// aftyershcu22
+	name_to_string(0x32f3e55f0d468420ull, out, sizeof(out));
+	sink = out[0];
+}
+
+static void bench_str_formatFIOAmount()
+{
+	char out[40];
+	str_formatFIOAmount(123456789012345678ull, out, sizeof(out));
+	sink = out[0];
+}
+
+static void bench_bip44_printToStr()
+{
+	const bip44_path_t path = {
+		.path = {44 | HARDENED_BIP32, 235 | HARDENED_BIP32, 0 | HARDENED_BIP32, 0, 0},
+		.length = 5,
+	};
+	char out[BIP44_MAX_PATH_STRING_LENGTH];
+	bip44_printToStr(&path, out, sizeof(out));
+	sink = out[0];
+}
+
+static void bench_ecdsa_der_to_sig()
+{
+	uint8_t sig[64];
+	ecdsa_der_to_sig(derSignature, sig);
+	sink = sig[0];
+}
+
+static void parse(const uint8_t* tx, size_t txSize)
+{
+	tx_parser_context_t ctx;
+	txParser_init(&ctx, NETWORK_TESTNET);
+	size_t offset = 0;
+	while (offset < txSize) {
+		offset += txParser_process(&ctx, tx + offset, txSize - offset);
+	}
+	sink = (uint8_t) ctx.output.amount;
+}
+
+static void bench_txParser_transfer()
+{
+	parse(transferTx, transferTxSize);
+}
+
+static void bench_txParser_twoTransfers()
+{
+	parse(twoTransfersTx, twoTransfersTxSize);
+}
+
+typedef struct {
+	const char* name;
+	void (*run)();
+} kernel_t;
+
+static const kernel_t kernels[] = {
+	{"b58enc", bench_b58enc},
+	{"public_key_to_wif", bench_public_key_to_wif},
+	{"name_to_string", bench_name_to_string},
+	{"str_formatFIOAmount", bench_str_formatFIOAmount},
+	{"bip44_printToStr", bench_bip44_printToStr},
+	{"ecdsa_der_to_sig", bench_ecdsa_der_to_sig},
+	{"txParser (1 action)", bench_txParser_transfer},
+	{"txParser (2 actions)", bench_txParser_twoTransfers},
+};
+
+typedef struct {
+	uint64_t iterations;
+	double nsPerOp;
+	double allocationsPerOp;
+} result_t;
+
+static uint64_t now_ns()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t) t.tv_sec * 1000000000ull + (uint64_t) t.tv_nsec;
+}
+
+static result_t measure(const kernel_t* kernel)
+{
+	// warm up
+	kernel->run();
+
+	uint64_t iterations = 1;
+	while (true) {
+		size_t allocationsBefore = allocations;
+		uint64_t start = now_ns();
+		for (uint64_t i = 0; i < iterations; i++) {
+			kernel->run();
+		}
+		uint64_t elapsed = now_ns() - start;
+		if (elapsed >= MIN_DURATION_NS) {
+			result_t result = {
+				.iterations = iterations,
+				.nsPerOp = (double) elapsed / (double) iterations,
+				.allocationsPerOp = (double) (allocations - allocationsBefore) / (double) iterations,
+			};
+			return result;
+		}
+		iterations *= 2;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* outPath = argc > 1 ? argv[1] : "build/bench.json";
+	// as main.c does before it dispatches an APDU
+	io_state = IO_EXPECT_NONE;
+	setup();
+
+	FILE* out = fopen(outPath, "w");
+	if (out == NULL) {
+		perror(outPath);
+		return EXIT_FAILURE;
+	}
+	fprintf(out, "{\n  \"kernels\": [\n");
+	for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+		result_t result = measure(&kernels[i]);
+		printf("%-24s %10.1f ns/op %6.1f allocations/op\n", kernels[i].name, result.nsPerOp, result.allocationsPerOp);
+		fprintf(
+		        out,
+		        "    {\"name\": \"%s\", \"iterations\": %llu, \"nsPerOp\": %.1f, \"allocationsPerOp\": %.1f}%s\n",
+		        kernels[i].name, (unsigned long long) result.iterations, result.nsPerOp, result.allocationsPerOp,
+		        i + 1 < sizeof(kernels) / sizeof(kernels[0]) ? "," : ""
+		);
+	}
+	fprintf(out, "  ]\n}\n");
+	fclose(out);
+	printf("Results saved to %s\n", outPath);
+	return EXIT_SUCCESS;
+}
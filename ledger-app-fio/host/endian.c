@@ -0,0 +1,13 @@
+// The device build inlines everything from endian.h. Without the optimizations
+// the host may not, so one translation unit has to provide the external definitions.
+
+#include "endian.h"
+
+extern inline void u1be_write(uint8_t* outBuffer, uint8_t value);
+extern inline void u2be_write(uint8_t* outBuffer, uint16_t value);
+extern inline void u4be_write(uint8_t* outBuffer, uint32_t value);
+extern inline void u8be_write(uint8_t* outBuffer, uint64_t value);
+extern inline uint8_t u1be_read(const uint8_t* inBuffer);
+extern inline uint16_t u2be_read(const uint8_t* inBuffer);
+extern inline uint32_t u4be_read(const uint8_t* inBuffer);
+extern inline uint64_t u8be_read(const uint8_t* inBuffer);
@@ -0,0 +1,38 @@
+// Runs the DEVEL test suites of the app on the host, see README.md.
+//
+//   ./build/runTests       prints only the result
+//   ./build/runTests -v    also prints the PRINTF output of the tests
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "os.h"
+#include "errors.h"
+#include "io.h"
+#include "runTests.h"
+
+int main(int argc, char** argv)
+{
+	shim_set_verbose(argc > 1 && strcmp(argv[1], "-v") == 0);
+
+	// as main.c does before it dispatches an APDU
+	io_state = IO_EXPECT_NONE;
+
+	volatile int result = EXIT_FAILURE;
+	BEGIN_TRY {
+		TRY {
+			runTests();
+			result = EXIT_SUCCESS;
+		}
+		CATCH_OTHER(e) {
+			fprintf(stderr, "Tests failed with exception 0x%x, run with -v to see the failed assertion\n", e);
+		}
+		FINALLY {
+		}
+	} END_TRY;
+
+	if (result == EXIT_SUCCESS) {
+		printf("All tests passed\n");
+	}
+	return result;
+}
@@ -0,0 +1,12 @@
+#ifndef H_FIO_HOST_SHIM_BAGL
+#define H_FIO_HOST_SHIM_BAGL
+
+typedef struct {
+	struct {
+		unsigned char type;
+		unsigned char userid;
+	} component;
+	const char* text;
+} bagl_element_t;
+
+#endif // H_FIO_HOST_SHIM_BAGL
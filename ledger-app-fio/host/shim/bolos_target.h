@@ -0,0 +1,8 @@
+#ifndef H_FIO_HOST_SHIM_BOLOS_TARGET
+#define H_FIO_HOST_SHIM_BOLOS_TARGET
+// The host build pretends to be a Nano S so that target-specific code paths
+// in the app core resolve the same way as on the most constrained device.
+#ifndef TARGET_NANOS
+#define TARGET_NANOS 1
+#endif
+#endif // H_FIO_HOST_SHIM_BOLOS_TARGET
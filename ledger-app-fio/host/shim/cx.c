@@ -0,0 +1,244 @@
+// Host implementation of the BOLOS cx_* crypto calls used by the app core.
+// Hashes use the OpenSSL primitives the device firmware implements in hardware.
+
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include <stdlib.h>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+#include <openssl/rand.h>
+#include <openssl/ripemd.h>
+#include <openssl/sha.h>
+
+#include "os.h"
+
+_Static_assert(sizeof(SHA256_CTX) <= sizeof(((cx_sha256_t*) 0)->state), "SHA256_CTX does not fit");
+_Static_assert(sizeof(RIPEMD160_CTX) <= sizeof(((cx_ripemd160_t*) 0)->state), "RIPEMD160_CTX does not fit");
+
+static void check(int ok, const char* what)
+{
+	if (!ok) {
+		fprintf(stderr, "%s failed\n", what);
+		abort();
+	}
+}
+
+int cx_sha256_init(cx_sha256_t* hash)
+{
+	hash->header.algo = CX_SHA256;
+	hash->header.counter = 0;
+	check(SHA256_Init((SHA256_CTX*) hash->state), "SHA256_Init");
+	return CX_SHA256;
+}
+
+int cx_ripemd160_init(cx_ripemd160_t* hash)
+{
+	hash->header.algo = CX_RIPEMD160;
+	hash->header.counter = 0;
+	check(RIPEMD160_Init((RIPEMD160_CTX*) hash->state), "RIPEMD160_Init");
+	return CX_RIPEMD160;
+}
+
+int cx_hash(cx_hash_t* hash, int mode, const unsigned char* in, unsigned int len,
+            unsigned char* out, unsigned int out_len)
+{
+	hash->counter++;
+	switch (hash->algo) {
+	case CX_SHA256: {
+		SHA256_CTX* ctx = (SHA256_CTX*) ((cx_sha256_t*) hash)->state;
+		check(SHA256_Update(ctx, in, len), "SHA256_Update");
+		if (!(mode & CX_LAST)) return 0;
+		check(out_len >= SHA256_DIGEST_LENGTH, "output size");
+		check(SHA256_Final(out, ctx), "SHA256_Final");
+		return SHA256_DIGEST_LENGTH;
+	}
+	case CX_RIPEMD160: {
+		RIPEMD160_CTX* ctx = (RIPEMD160_CTX*) ((cx_ripemd160_t*) hash)->state;
+		check(RIPEMD160_Update(ctx, in, len), "RIPEMD160_Update");
+		if (!(mode & CX_LAST)) return 0;
+		check(out_len >= RIPEMD160_DIGEST_LENGTH, "output size");
+		check(RIPEMD160_Final(out, ctx), "RIPEMD160_Final");
+		return RIPEMD160_DIGEST_LENGTH;
+	}
+	default:
+		check(0, "unsupported hash");
+		return 0;
+	}
+}
+
+// HMAC (RFC 2104) on top of the hash above
+static void hmac_start(cx_hmac_sha256_t* hmac)
+{
+	unsigned char ipad[SHA256_CBLOCK];
+	for (size_t i = 0; i < sizeof(ipad); i++) {
+		ipad[i] = hmac->key[i] ^ 0x36;
+	}
+	cx_sha256_init(&hmac->inner);
+	cx_hash(&hmac->inner.header, 0, ipad, sizeof(ipad), NULL, 0);
+}
+
+int cx_hmac_sha256_init(cx_hmac_sha256_t* hmac, const unsigned char* key, unsigned int key_len)
+{
+	hmac->header.algo = CX_SHA256;
+	hmac->header.counter = 0;
+	memset(hmac->key, 0, sizeof(hmac->key));
+	if (key_len > sizeof(hmac->key)) {
+		SHA256(key, key_len, hmac->key);
+	} else {
+		memcpy(hmac->key, key, key_len);
+	}
+	hmac_start(hmac);
+	return CX_SHA256;
+}
+
+int cx_hmac(cx_hmac_t* hmac, int mode, const unsigned char* in, unsigned int len,
+            unsigned char* mac, unsigned int mac_len)
+{
+	check(hmac->header.algo == CX_SHA256, "unsupported hmac");
+	hmac->header.counter++;
+	cx_hash(&hmac->inner.header, 0, in, len, NULL, 0);
+	if (!(mode & CX_LAST)) return 0;
+
+	unsigned char innerHash[SHA256_DIGEST_LENGTH];
+	cx_hash(&hmac->inner.header, CX_LAST, NULL, 0, innerHash, sizeof(innerHash));
+
+	unsigned char opad[SHA256_CBLOCK];
+	for (size_t i = 0; i < sizeof(opad); i++) {
+		opad[i] = hmac->key[i] ^ 0x5c;
+	}
+	cx_sha256_t outer;
+	cx_sha256_init(&outer);
+	cx_hash(&outer.header, 0, opad, sizeof(opad), NULL, 0);
+	unsigned char result[SHA256_DIGEST_LENGTH];
+	cx_hash(&outer.header, CX_LAST, innerHash, sizeof(innerHash), result, sizeof(result));
+
+	unsigned int length = mac_len < sizeof(result) ? mac_len : sizeof(result);
+	memcpy(mac, result, length);
+	// ready for another message with the same key, as on the device
+	hmac_start(hmac);
+	return (int) length;
+}
+
+int cx_ecfp_init_private_key(cx_curve_t curve, const unsigned char* rawkey, unsigned int key_len,
+                             cx_ecfp_private_key_t* pvkey)
+{
+	check(key_len <= sizeof(pvkey->d), "private key size");
+	pvkey->curve = curve;
+	pvkey->d_len = key_len;
+	if (rawkey != NULL) {
+		memcpy(pvkey->d, rawkey, key_len);
+	}
+	return (int) key_len;
+}
+
+int cx_ecfp_init_public_key(cx_curve_t curve, const unsigned char* rawkey, unsigned int key_len,
+                            cx_ecfp_public_key_t* key)
+{
+	check(key_len <= sizeof(key->W), "public key size");
+	key->curve = curve;
+	key->W_len = key_len;
+	if (rawkey != NULL) {
+		memcpy(key->W, rawkey, key_len);
+	}
+	return (int) key_len;
+}
+
+// Only computes the public key of the given private key, it never generates one
+int cx_ecfp_generate_pair(cx_curve_t curve, cx_ecfp_public_key_t* pubkey,
+                          cx_ecfp_private_key_t* privkey, int keepprivate)
+{
+	check(curve == CX_CURVE_SECP256K1 && keepprivate, "key generation");
+
+	EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+	BN_CTX* ctx = BN_CTX_new();
+	BIGNUM* key = BN_bin2bn(privkey->d, (int) privkey->d_len, NULL);
+	EC_POINT* point = EC_POINT_new(group);
+	check(group && ctx && key && point, "allocation");
+	check(EC_POINT_mul(group, point, key, NULL, NULL, ctx), "EC_POINT_mul");
+	check(EC_POINT_point2oct(group, point, POINT_CONVERSION_UNCOMPRESSED, pubkey->W, sizeof(pubkey->W), ctx) == 65,
+	      "EC_POINT_point2oct");
+	pubkey->curve = curve;
+	pubkey->W_len = 65;
+
+	EC_POINT_free(point);
+	BN_clear_free(key);
+	BN_CTX_free(ctx);
+	EC_GROUP_free(group);
+	return 0;
+}
+
+// Modular arithmetic on big endian numbers of len bytes
+
+typedef int (*bn_mod_op_t)(BIGNUM*, const BIGNUM*, const BIGNUM*, const BIGNUM*, BN_CTX*);
+
+static void math_mod_op(bn_mod_op_t op,
+                        unsigned char* r, const unsigned char* a, unsigned int len_a,
+                        const unsigned char* b, unsigned int len_b,
+                        const unsigned char* m, unsigned int len)
+{
+	BN_CTX* ctx = BN_CTX_new();
+	BIGNUM* bnA = BN_bin2bn(a, (int) len_a, NULL);
+	BIGNUM* bnB = BN_bin2bn(b, (int) len_b, NULL);
+	BIGNUM* bnM = BN_bin2bn(m, (int) len, NULL);
+	BIGNUM* bnR = BN_new();
+	check(ctx && bnA && bnB && bnM && bnR, "allocation");
+	check(op(bnR, bnA, bnB, bnM, ctx), "modular operation");
+	check(BN_bn2binpad(bnR, r, (int) len) == (int) len, "BN_bn2binpad");
+	BN_free(bnR);
+	BN_free(bnM);
+	BN_free(bnB);
+	BN_free(bnA);
+	BN_CTX_free(ctx);
+}
+
+void cx_math_multm(unsigned char* r, const unsigned char* a, const unsigned char* b,
+                   const unsigned char* m, unsigned int len)
+{
+	math_mod_op(BN_mod_mul, r, a, len, b, len, m, len);
+}
+
+void cx_math_addm(unsigned char* r, const unsigned char* a, const unsigned char* b,
+                  const unsigned char* m, unsigned int len)
+{
+	math_mod_op(BN_mod_add, r, a, len, b, len, m, len);
+}
+
+void cx_math_powm(unsigned char* r, const unsigned char* a, const unsigned char* e,
+                  unsigned int len_e, const unsigned char* m, unsigned int len)
+{
+	math_mod_op(BN_mod_exp, r, a, len, e, len_e, m, len);
+}
+
+// r = a - b, returns the borrow
+int cx_math_sub(unsigned char* r, const unsigned char* a, const unsigned char* b, unsigned int len)
+{
+	int borrow = 0;
+	for (unsigned int i = len; i-- > 0;) {
+		int difference = a[i] - b[i] - borrow;
+		borrow = difference < 0;
+		r[i] = (unsigned char) (difference + (borrow << 8));
+	}
+	return borrow;
+}
+
+int cx_math_is_zero(const unsigned char* a, unsigned int len)
+{
+	for (unsigned int i = 0; i < len; i++) {
+		if (a[i] != 0) return 0;
+	}
+	return 1;
+}
+
+unsigned char* cx_rng(unsigned char* buffer, unsigned int len)
+{
+	check(RAND_bytes(buffer, (int) len), "RAND_bytes");
+	return buffer;
+}
+
+uint32_t cx_rng_u32(void)
+{
+	uint32_t value;
+	cx_rng((unsigned char*) &value, sizeof(value));
+	return value;
+}
@@ -0,0 +1,96 @@
+#ifndef H_FIO_HOST_SHIM_CX
+#define H_FIO_HOST_SHIM_CX
+
+// Host implementation of the subset of the BOLOS cx_* crypto API used by the app,
+// backed by OpenSSL (see cx.c).
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CX_APILEVEL 10
+
+#define CX_LAST (1 << 0)
+#define CX_RND_PROVIDED (4 << 9)
+#define CX_NO_CANONICAL (1 << 13)
+#define CX_ECCINFO_PARITY_ODD 1
+#define CX_ECCINFO_xGTn 2
+
+typedef enum {
+	CX_NONE = 0,
+	CX_RIPEMD160 = 2,
+	CX_SHA256 = 3,
+} cx_md_t;
+
+typedef enum {
+	CX_CURVE_NONE = 0,
+	CX_CURVE_SECP256K1 = 0x21,
+} cx_curve_t;
+
+typedef struct {
+	cx_md_t algo;
+	unsigned int counter;
+} cx_hash_t;
+
+// The hash states are opaque here, cx.c keeps OpenSSL contexts in them
+typedef struct {
+	cx_hash_t header;
+	uint64_t state[16];
+} cx_sha256_t;
+
+typedef struct {
+	cx_hash_t header;
+	uint64_t state[16];
+} cx_ripemd160_t;
+
+typedef struct {
+	cx_hash_t header;
+	unsigned char key[64];
+	cx_sha256_t inner;
+} cx_hmac_sha256_t;
+
+typedef cx_hmac_sha256_t cx_hmac_t;
+
+typedef struct {
+	cx_curve_t curve;
+	unsigned int d_len;
+	unsigned char d[32];
+} cx_ecfp_private_key_t;
+
+typedef struct {
+	cx_curve_t curve;
+	unsigned int W_len;
+	unsigned char W[65];
+} cx_ecfp_public_key_t;
+
+int cx_sha256_init(cx_sha256_t* hash);
+int cx_ripemd160_init(cx_ripemd160_t* hash);
+int cx_hash(cx_hash_t* hash, int mode, const unsigned char* in, unsigned int len,
+            unsigned char* out, unsigned int out_len);
+
+int cx_hmac_sha256_init(cx_hmac_sha256_t* hmac, const unsigned char* key, unsigned int key_len);
+int cx_hmac(cx_hmac_t* hmac, int mode, const unsigned char* in, unsigned int len,
+            unsigned char* mac, unsigned int mac_len);
+
+int cx_ecfp_init_private_key(cx_curve_t curve, const unsigned char* rawkey, unsigned int key_len,
+                             cx_ecfp_private_key_t* pvkey);
+int cx_ecfp_init_public_key(cx_curve_t curve, const unsigned char* rawkey, unsigned int key_len,
+                            cx_ecfp_public_key_t* key);
+int cx_ecfp_generate_pair(cx_curve_t curve, cx_ecfp_public_key_t* pubkey,
+                          cx_ecfp_private_key_t* privkey, int keepprivate);
+int cx_ecdsa_sign(const cx_ecfp_private_key_t* pvkey, int mode, cx_md_t hashID,
+                  const unsigned char* hash, unsigned int hash_len,
+                  unsigned char* sig, unsigned int sig_len, unsigned int* info);
+
+void cx_math_multm(unsigned char* r, const unsigned char* a, const unsigned char* b,
+                   const unsigned char* m, unsigned int len);
+void cx_math_addm(unsigned char* r, const unsigned char* a, const unsigned char* b,
+                  const unsigned char* m, unsigned int len);
+void cx_math_powm(unsigned char* r, const unsigned char* a, const unsigned char* e,
+                  unsigned int len_e, const unsigned char* m, unsigned int len);
+int cx_math_sub(unsigned char* r, const unsigned char* a, const unsigned char* b, unsigned int len);
+int cx_math_is_zero(const unsigned char* a, unsigned int len);
+
+unsigned char* cx_rng(unsigned char* buffer, unsigned int len);
+uint32_t cx_rng_u32(void);
+
+#endif // H_FIO_HOST_SHIM_CX
@@ -0,0 +1,170 @@
+// Host implementation of the BOLOS os_* calls used by the app core.
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/obj_mac.h>
+
+#include "os.h"
+
+// the mnemonic the DEVEL tests expect, see keyDerivation_test.c
+#define DEFAULT_MNEMONIC \
+	"abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about"
+
+static try_context_t* currentTryContext;
+
+try_context_t* try_context_get(void)
+{
+	return currentTryContext;
+}
+
+try_context_t* try_context_set(try_context_t* context)
+{
+	try_context_t* previous = currentTryContext;
+	currentTryContext = context;
+	return previous;
+}
+
+void os_longjmp(unsigned int exception)
+{
+	if (currentTryContext == NULL) {
+		fprintf(stderr, "Uncaught exception 0x%x\n", exception);
+		exit(EXIT_FAILURE);
+	}
+	longjmp(currentTryContext->jmp_buf, exception);
+}
+
+static int verbose;
+
+void shim_set_verbose(int enabled)
+{
+	verbose = enabled;
+}
+
+void shim_printf(const char* format, ...)
+{
+	if (!verbose) return;
+	va_list args;
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+}
+
+unsigned int os_global_pin_is_validated(void)
+{
+	return BOLOS_UX_OK;
+}
+
+void os_sched_exit(unsigned int exit_code)
+{
+	exit((int) exit_code);
+}
+
+void os_boot(void)
+{
+	currentTryContext = NULL;
+}
+
+unsigned int os_serial(unsigned char* serial, unsigned int maxlength)
+{
+	static const unsigned char HOST_SERIAL[] = {'F', 'I', 'O', 'H', 'O', 'S', 'T'};
+	unsigned int length = maxlength < sizeof(HOST_SERIAL) ? maxlength : sizeof(HOST_SERIAL);
+	memcpy(serial, HOST_SERIAL, length);
+	return length;
+}
+
+void io_seproxyhal_se_reset(void)
+{
+	fprintf(stderr, "Device reset\n");
+	abort();
+}
+
+static void check(int ok, const char* what)
+{
+	if (!ok) {
+		fprintf(stderr, "%s failed\n", what);
+		abort();
+	}
+}
+
+// BIP39 seed of FIO_HOST_MNEMONIC (or the test mnemonic), computed once
+static const unsigned char* seed(void)
+{
+	static unsigned char seed[64];
+	static int initialized;
+	if (!initialized) {
+		const char* mnemonic = getenv("FIO_HOST_MNEMONIC");
+		if (mnemonic == NULL) mnemonic = DEFAULT_MNEMONIC;
+		check(PKCS5_PBKDF2_HMAC(
+		              mnemonic, (int) strlen(mnemonic),
+		              (const unsigned char*) "mnemonic", 8,
+		              2048, EVP_sha512(), sizeof(seed), seed
+		      ), "PBKDF2");
+		initialized = 1;
+	}
+	return seed;
+}
+
+// BIP32 private key derivation (CKDpriv) on secp256k1
+void os_perso_derive_node_bip32(
+        int curve,
+        const uint32_t* path, unsigned int pathLength,
+        unsigned char* privateKey, unsigned char* chain
+)
+{
+	check(curve == CX_CURVE_SECP256K1, "curve");
+
+	unsigned char node[64];
+	unsigned int nodeLength = 0;
+	check(HMAC(EVP_sha512(), "Bitcoin seed", 12, seed(), 64, node, &nodeLength) != NULL, "HMAC");
+
+	EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+	BN_CTX* ctx = BN_CTX_new();
+	BIGNUM* order = BN_new();
+	BIGNUM* key = BN_new();
+	BIGNUM* tweak = BN_new();
+	EC_POINT* point = EC_POINT_new(group);
+	check(group && ctx && order && key && tweak && point, "allocation");
+	check(EC_GROUP_get_order(group, order, ctx), "EC_GROUP_get_order");
+
+	for (unsigned int i = 0; i < pathLength; i++) {
+		// 0x00 || key or the compressed public key, followed by the index
+		unsigned char data[33 + 4];
+		if (path[i] & 0x80000000) {
+			data[0] = 0;
+			memcpy(data + 1, node, 32);
+		} else {
+			check(BN_bin2bn(node, 32, key) != NULL, "BN_bin2bn");
+			check(EC_POINT_mul(group, point, key, NULL, NULL, ctx), "EC_POINT_mul");
+			check(EC_POINT_point2oct(group, point, POINT_CONVERSION_COMPRESSED, data, 33, ctx) == 33, "EC_POINT_point2oct");
+		}
+		data[33] = (unsigned char) (path[i] >> 24);
+		data[34] = (unsigned char) (path[i] >> 16);
+		data[35] = (unsigned char) (path[i] >> 8);
+		data[36] = (unsigned char) path[i];
+
+		unsigned char child[64];
+		check(HMAC(EVP_sha512(), node + 32, 32, data, sizeof(data), child, &nodeLength) != NULL, "HMAC");
+
+		check(BN_bin2bn(child, 32, tweak) != NULL && BN_bin2bn(node, 32, key) != NULL, "BN_bin2bn");
+		check(BN_mod_add(key, key, tweak, order, ctx), "BN_mod_add");
+		check(BN_bn2binpad(key, node, 32) == 32, "BN_bn2binpad");
+		memcpy(node + 32, child + 32, 32);
+	}
+
+	memcpy(privateKey, node, 32);
+	if (chain != NULL) {
+		memcpy(chain, node + 32, 32);
+	}
+
+	EC_POINT_free(point);
+	BN_free(tweak);
+	BN_clear_free(key);
+	BN_free(order);
+	BN_CTX_free(ctx);
+	EC_GROUP_free(group);
+	explicit_bzero(node, sizeof(node));
+}
@@ -0,0 +1,119 @@
+#ifndef H_FIO_HOST_SHIM_OS
+#define H_FIO_HOST_SHIM_OS
+
+// Minimal stand-in for the parts of the BOLOS SDK os.h used by the app core.
+// Exceptions follow the SDK's setjmp-based TRY/CATCH implementation.
+
+#include <setjmp.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "bolos_target.h"
+
+typedef unsigned short exception_t;
+
+typedef struct try_context_s try_context_t;
+struct try_context_s {
+	jmp_buf jmp_buf;
+	try_context_t* previous;
+	volatile exception_t ex;
+};
+
+try_context_t* try_context_get(void);
+try_context_t* try_context_set(try_context_t* context);
+void os_longjmp(unsigned int exception) __attribute__((noreturn));
+
+#define BEGIN_TRY_L(L) \
+	{ \
+		try_context_t __try##L;
+
+#define TRY_L(L) \
+	__try##L.ex = setjmp(__try##L.jmp_buf); \
+	if (__try##L.ex == 0) { \
+		__try##L.previous = try_context_set(&__try##L);
+
+#define CATCH_L(L, x) \
+	goto __FINALLY##L; \
+	} \
+	else if (__try##L.ex == x) { \
+		__try##L.ex = 0; \
+		try_context_set(__try##L.previous);
+
+#define CATCH_OTHER_L(L, e) \
+	goto __FINALLY##L; \
+	} \
+	else { \
+		exception_t e; \
+		e = __try##L.ex; \
+		__try##L.ex = 0; \
+		try_context_set(__try##L.previous);
+
+#define CATCH_ALL_L(L) \
+	goto __FINALLY##L; \
+	} \
+	else { \
+		__try##L.ex = 0; \
+		try_context_set(__try##L.previous);
+
+#define FINALLY_L(L) \
+	goto __FINALLY##L; \
+	} \
+	__FINALLY##L: \
+	if (try_context_get() == &__try##L) { \
+		try_context_set(__try##L.previous); \
+	}
+
+#define END_TRY_L(L) \
+	if (__try##L.ex != 0) { \
+		THROW_L(L, __try##L.ex); \
+	} \
+	}
+
+#define THROW_L(L, x) os_longjmp(x)
+
+#define BEGIN_TRY BEGIN_TRY_L(EX)
+#define TRY TRY_L(EX)
+#define CATCH(x) CATCH_L(EX, x)
+#define CATCH_OTHER(e) CATCH_OTHER_L(EX, e)
+#define CATCH_ALL CATCH_ALL_L(EX)
+#define FINALLY FINALLY_L(EX)
+#define END_TRY END_TRY_L(EX)
+#define THROW(x) THROW_L(EX, x)
+
+#define EXCEPTION_IO_RESET 0x10
+#define INVALID_PARAMETER 2
+
+#define PIC(x) (x)
+#define U4BE(buf, off) \
+	((((uint32_t) (buf)[off]) << 24) | (((uint32_t) (buf)[off + 1]) << 16) | \
+	 (((uint32_t) (buf)[off + 2]) << 8) | ((uint32_t) (buf)[off + 3]))
+
+#define BOLOS_UX_OK 0xB0105011
+
+#ifndef PRINTF
+void shim_printf(const char* format, ...);
+#define PRINTF shim_printf
+#endif
+
+// PRINTF output is dropped unless enabled
+void shim_set_verbose(int verbose);
+
+void explicit_bzero(void* s, size_t len);
+
+unsigned int os_global_pin_is_validated(void);
+void os_sched_exit(unsigned int exit_code);
+void os_boot(void);
+unsigned int os_serial(unsigned char* serial, unsigned int maxlength);
+void io_seproxyhal_se_reset(void);
+
+void os_perso_derive_node_bip32(
+        int curve,
+        const uint32_t* path, unsigned int pathLength,
+        unsigned char* privateKey, unsigned char* chain
+);
+
+#include "cx.h"
+
+#endif // H_FIO_HOST_SHIM_OS
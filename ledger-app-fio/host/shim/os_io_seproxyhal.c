@@ -0,0 +1,70 @@
+// Host stand-in for the SEPROXYHAL I/O layer. There is no MCU to talk to,
+// responses sent by the app are kept for the caller to inspect.
+
+#include "os_io_seproxyhal.h"
+
+unsigned char G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+unsigned char G_io_apdu_media = IO_APDU_MEDIA_USB_HID;
+
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len)
+{
+	(void) channel_and_flags;
+	(void) tx_len;
+	// nothing to receive, the response stays in G_io_apdu_buffer
+	return 0;
+}
+
+static void (*heartbeat_handler)(void);
+
+void shim_set_heartbeat_handler(void (*handler)(void))
+{
+	heartbeat_handler = handler;
+}
+
+void io_seproxyhal_io_heartbeat(void)
+{
+	if (heartbeat_handler != NULL) {
+		heartbeat_handler();
+	}
+}
+
+void io_seproxyhal_general_status(void)
+{
+}
+
+unsigned int io_seproxyhal_spi_is_status_sent(void)
+{
+	return 1;
+}
+
+void io_seproxyhal_spi_send(const unsigned char* buffer, unsigned short length)
+{
+	(void) buffer;
+	(void) length;
+}
+
+unsigned short io_seproxyhal_spi_recv(unsigned char* buffer, unsigned short maxlength, unsigned int flags)
+{
+	(void) buffer;
+	(void) maxlength;
+	(void) flags;
+	return 0;
+}
+
+void io_seproxyhal_display_default(const bagl_element_t* element)
+{
+	(void) element;
+}
+
+void io_seproxyhal_init(void)
+{
+}
+
+void reset(void)
+{
+}
+
+void USB_power(unsigned char enabled)
+{
+	(void) enabled;
+}
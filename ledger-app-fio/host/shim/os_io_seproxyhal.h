@@ -0,0 +1,47 @@
+#ifndef H_FIO_HOST_SHIM_OS_IO_SEPROXYHAL
+#define H_FIO_HOST_SHIM_OS_IO_SEPROXYHAL
+
+// Host stand-in for the SEPROXYHAL I/O layer. APDUs never leave the process.
+
+#include "os.h"
+#include "bagl.h"
+
+#define IO_APDU_BUFFER_SIZE (5 + 255)
+#define IO_SEPROXYHAL_BUFFER_SIZE_B 128
+
+extern unsigned char G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+extern unsigned char G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
+extern unsigned char G_io_apdu_media;
+
+#define CHANNEL_APDU 0
+#define CHANNEL_KEYBOARD 1
+#define CHANNEL_SPI 2
+#define IO_RESET_AFTER_REPLIED 0x80
+#define IO_RECEIVE_DATA 0x40
+#define IO_RETURN_AFTER_TX 0x20
+#define IO_ASYNCH_REPLY 0x10
+#define IO_FLAGS 0xF8
+
+#define IO_APDU_MEDIA_USB_HID 1
+
+#define SEPROXYHAL_TAG_BUTTON_PUSH_EVENT 0x05
+#define SEPROXYHAL_TAG_FINGER_EVENT 0x0C
+#define SEPROXYHAL_TAG_DISPLAY_PROCESSED_EVENT 0x0D
+#define SEPROXYHAL_TAG_STATUS_EVENT 0x0E
+#define SEPROXYHAL_TAG_TICKER_EVENT 0x0F
+#define SEPROXYHAL_TAG_STATUS_EVENT_FLAG_USB_POWERED 0x00000008
+
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len);
+void io_seproxyhal_io_heartbeat(void);
+// stands in for the events the MCU delivers during a heartbeat, NULL for none
+void shim_set_heartbeat_handler(void (*handler)(void));
+void io_seproxyhal_general_status(void);
+unsigned int io_seproxyhal_spi_is_status_sent(void);
+void io_seproxyhal_spi_send(const unsigned char* buffer, unsigned short length);
+unsigned short io_seproxyhal_spi_recv(unsigned char* buffer, unsigned short maxlength, unsigned int flags);
+void io_seproxyhal_display_default(const bagl_element_t* element);
+void io_seproxyhal_init(void);
+void reset(void);
+void USB_power(unsigned char enabled);
+
+#endif // H_FIO_HOST_SHIM_OS_IO_SEPROXYHAL
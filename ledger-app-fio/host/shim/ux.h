@@ -0,0 +1,40 @@
+#ifndef H_FIO_HOST_SHIM_UX
+#define H_FIO_HOST_SHIM_UX
+
+// The host build has no screen. UX macros collapse to no-ops; UI flows are
+// driven by the tests calling the registered callbacks directly.
+
+#include "os_io_seproxyhal.h"
+
+typedef struct {
+	unsigned int callback_interval_ms;
+} ux_state_t;
+
+extern ux_state_t ux;
+
+typedef struct ux_menu_entry_s {
+	const void* menu;
+	void (*callback)(unsigned int);
+	unsigned int userid;
+	const void* icon;
+	const char* line1;
+	const char* line2;
+	char text_x;
+	char icon_x;
+} ux_menu_entry_t;
+
+#define UX_MENU_DISPLAY(current_entry, menu_entries, menu_preprocessor) do {} while(0)
+#define UX_MENU_END {NULL, NULL, 0, NULL, NULL, NULL, 0, 0}
+
+#define UX_CALLBACK_SET_INTERVAL(ms) (ux.callback_interval_ms = (ms))
+#define UX_DISPLAY(elements, preprocessor) do {} while(0)
+#define UX_REDISPLAY() do {} while(0)
+#define UX_INIT() do {} while(0)
+#define UX_BUTTON_PUSH_EVENT(buf) do {} while(0)
+#define UX_FINGER_EVENT(buf) do {} while(0)
+#define UX_DEFAULT_EVENT() do {} while(0)
+#define UX_DISPLAYED_EVENT(cb) do {} while(0)
+#define UX_ALLOWED 1
+#define UX_TICKER_EVENT(buf, cb) do cb while(0)
+
+#endif // H_FIO_HOST_SHIM_UX
@@ -0,0 +1,30 @@
+// The screen-less counterpart of main.c's ui_idle and uiHelpers_nanos.c.
+// Nothing is displayed, flows waiting for the user just stay waiting.
+
+#include "uiHelpers.h"
+#include "io.h"
+#include "earlyWitness.h"
+#include "state.h"
+
+// provided by the linker script on the device
+unsigned int app_stack_canary = APP_STACK_CANARY_MAGIC;
+
+void ui_idle(void)
+{
+	currentInstruction = -1;
+	io_clear_background_task();
+	earlyWitness_wipe();
+	nanos_clear_timer();
+}
+
+void ui_displayBusy()
+{
+}
+
+void ui_displayPrompt_run()
+{
+}
+
+void ui_displayPaginatedText_run()
+{
+}
@@ -0,0 +1,167 @@
+#ifdef DEVEL
+
+#include "benchmark.h"
+#include "bip44.h"
+#include "endian.h"
+#include "eos_utils.h"
+#include "hash.h"
+#include "keyDerivation.h"
+#include "signTransaction.h"
+#include "uiHelpers.h"
+
+// Apps have no access to a cycle counter and the ticker count advances
+// only between APDUs, so the host times the APDU and subtracts the time
+// of a call with zero iterations (see Fio.benchmark in the SDK).
+
+// Arbitrary key for the kernels which do not need the seed
+static const uint8_t BENCHMARK_PRIVATE_KEY[32] = {
+	0x1c, 0x31, 0x2a, 0x61, 0x22, 0x11, 0x66, 0x55, 0x44, 0x33, 0x20, 0x84, 0x46, 0x0d, 0x5f, 0xe5,
+	0xf3, 0x32, 0x00, 0x00, 0x98, 0x0a, 0xd2, 0x0c, 0xa8, 0x5b, 0xe0, 0xe1, 0xd1, 0x95, 0xba, 0x85,
+};
+
+// Keep the device responsive during long runs
+#define BENCHMARK_HEARTBEAT_ITERATIONS 16
+
+typedef struct {
+	private_key_t privateKey;
+	public_key_t publicKey;
+	uint8_t message[256];
+	uint8_t hash[SHA_256_SIZE];
+	uint8_t nonce[32];
+	uint8_t V[33];
+	uint8_t K[32];
+	uint8_t signature[100];
+	char base58[60];
+} benchmark_context_t;
+
+static bool isValidKernel(uint8_t kernel)
+{
+	switch (kernel) {
+	case BENCHMARK_BIP32_DERIVATION:
+	case BENCHMARK_GENERATE_PAIR:
+	case BENCHMARK_ECDSA_SIGN:
+	case BENCHMARK_RNG_RFC6979:
+	case BENCHMARK_SHA_256_64:
+	case BENCHMARK_SHA_256_256:
+	case BENCHMARK_RIPEMD_160:
+	case BENCHMARK_BASE58:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Inputs of the kernels, prepared outside of the measured loop
+static void setup(benchmark_context_t* ctx)
+{
+	for (size_t i = 0; i < SIZEOF(ctx->message); i++) {
+		ctx->message[i] = (uint8_t) i;
+	}
+	cx_ecfp_init_private_key(CX_CURVE_SECP256K1, BENCHMARK_PRIVATE_KEY, SIZEOF(BENCHMARK_PRIVATE_KEY), &ctx->privateKey);
+	sha_256_hash(ctx->message, SHA_256_BLOCK_SIZE, ctx->hash, SIZEOF(ctx->hash));
+	rng_rfc6979(
+	        ctx->nonce, ctx->hash, ctx->privateKey.d, ctx->privateKey.d_len,
+	        SECP256K1_N, 32, ctx->V, ctx->K
+	);
+}
+
+static void runKernel(benchmark_kernel_t kernel, benchmark_context_t* ctx)
+{
+	switch (kernel) {
+	case BENCHMARK_BIP32_DERIVATION: {
+		const bip44_path_t path = {
+			.path = {44 | HARDENED_BIP32, 235 | HARDENED_BIP32, 0 | HARDENED_BIP32, 0, 0},
+			.length = 5,
+		};
+		derivePrivateKey(&path, &ctx->privateKey);
+		break;
+	}
+	case BENCHMARK_GENERATE_PAIR:
+		cx_ecfp_init_public_key(CX_CURVE_SECP256K1, NULL, 0, &ctx->publicKey);
+		cx_ecfp_generate_pair(CX_CURVE_SECP256K1, &ctx->publicKey, &ctx->privateKey, 1);
+		break;
+	case BENCHMARK_ECDSA_SIGN: {
+		// the nonce is passed in the output buffer as in signTransaction.c
+		memcpy(ctx->signature, ctx->nonce, SIZEOF(ctx->nonce));
+		uint32_t infos;
+		cx_ecdsa_sign(
+		        &ctx->privateKey, CX_NO_CANONICAL | CX_RND_PROVIDED | CX_LAST, CX_SHA256,
+		        ctx->hash, SIZEOF(ctx->hash),
+		        ctx->signature, SIZEOF(ctx->signature),
+		        &infos
+		);
+		break;
+	}
+	case BENCHMARK_RNG_RFC6979:
+		rng_rfc6979(
+		        ctx->nonce, ctx->hash, ctx->privateKey.d, ctx->privateKey.d_len,
+		        SECP256K1_N, 32, ctx->V, ctx->K
+		);
+		break;
+	case BENCHMARK_SHA_256_64:
+		sha_256_hash(ctx->message, 64, ctx->hash, SIZEOF(ctx->hash));
+		break;
+	case BENCHMARK_SHA_256_256:
+		sha_256_hash(ctx->message, 256, ctx->hash, SIZEOF(ctx->hash));
+		break;
+	case BENCHMARK_RIPEMD_160: {
+		// the checksum of a compressed public key in public_key_to_wif()
+		cx_ripemd160_t ripemd;
+		cx_ripemd160_init(&ripemd);
+		cx_hash(&ripemd.header, CX_LAST, ctx->message, COMPRESSED_PUBLIC_KEY_SIZE, ctx->hash, 20);
+		break;
+	}
+	case BENCHMARK_BASE58: {
+		// key with checksum as in public_key_to_wif()
+		uint32_t size = SIZEOF(ctx->base58);
+		b58enc(ctx->message, COMPRESSED_PUBLIC_KEY_SIZE + 4, ctx->base58, &size);
+		break;
+	}
+	default:
+		ASSERT(false);
+	}
+}
+
+void benchmark_handleAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t *wireDataBuffer,
+        size_t wireDataSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(isValidKernel(p1), ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 4, ERR_INVALID_REQUEST_PARAMETERS);
+
+	const uint32_t iterations = u4be_read(wireDataBuffer);
+	VALIDATE(iterations <= BENCHMARK_MAX_ITERATIONS, ERR_INVALID_REQUEST_PARAMETERS);
+
+	benchmark_context_t ctx;
+	BEGIN_TRY {
+		TRY {
+			setup(&ctx);
+			for (uint32_t i = 0; i < iterations; i++) {
+				if (i % BENCHMARK_HEARTBEAT_ITERATIONS == 0) {
+					io_seproxyhal_io_heartbeat();
+				}
+				runKernel((benchmark_kernel_t) p1, &ctx);
+			}
+		}
+		FINALLY {
+			explicit_bzero(&ctx, SIZEOF(ctx));
+		}
+	} END_TRY;
+
+	struct {
+		uint8_t kernel;
+		uint8_t iterations[4];
+	} response;
+	response.kernel = p1;
+	u4be_write(response.iterations, iterations);
+
+	io_send_buf(SUCCESS, (uint8_t*) &response, SIZEOF(response));
+	ui_idle();
+}
+
+#endif // DEVEL
@@ -0,0 +1,27 @@
+#ifdef DEVEL
+
+#ifndef H_FIO_APP_BENCHMARK
+#define H_FIO_APP_BENCHMARK
+
+#include "handlers.h"
+
+// Kernels which can be run by the benchmark INS (0xF3), passed in P1
+typedef enum {
+	BENCHMARK_BIP32_DERIVATION = 0x00,
+	BENCHMARK_GENERATE_PAIR = 0x01,
+	BENCHMARK_ECDSA_SIGN = 0x02,
+	BENCHMARK_RNG_RFC6979 = 0x03,
+	BENCHMARK_SHA_256_64 = 0x04,
+	BENCHMARK_SHA_256_256 = 0x05,
+	BENCHMARK_RIPEMD_160 = 0x06,
+	BENCHMARK_BASE58 = 0x07,
+} benchmark_kernel_t;
+
+// keeps a single APDU within a few minutes even for the slowest kernels
+#define BENCHMARK_MAX_ITERATIONS 10000
+
+handler_fn_t benchmark_handleAPDU;
+
+#endif // H_FIO_APP_BENCHMARK
+
+#endif // DEVEL
@@ -53,6 +53,18 @@ bool bip44_hasValidFIOPrefix(const bip44_path_t* pathSpec)
 #undef CHECK
 }
 
+// FIO account: exactly /44'/235'/0'
+bool bip44_isFIOAccountPath(const bip44_path_t* pathSpec)
+{
+#define CHECK(cond) if (!(cond)) return false
+	CHECK(pathSpec->length == BIP44_I_CHAIN);
+	CHECK(pathSpec->path[BIP44_I_PURPOSE] == (PURPOSE_FIO | HARDENED_BIP32));
+	CHECK(pathSpec->path[BIP44_I_COIN_TYPE] == (COIN_TYPE_FIO | HARDENED_BIP32));
+	CHECK(pathSpec->path[BIP44_I_ACCOUNT] == (0 | HARDENED_BIP32));
+	return true;
+#undef CHECK
+}
+
 // Address
 
 bool bip44_containsAddress(const bip44_path_t* pathSpec)
@@ -73,12 +85,32 @@ bool bip44_hasReasonableAddress(const bip44_path_t* pathSpec)
 	return (address <= MAX_REASONABLE_ADDRESS);
 }
 
+bool bip44_hasReasonableAddressRange(const bip44_path_t* pathSpec, uint32_t count)
+{
+	if (!bip44_hasReasonableAddress(pathSpec)) return false;
+	if (count == 0) return false;
+	const uint32_t address = bip44_getAddressValue(pathSpec);
+	// written this way to avoid overflow
+	return (count - 1 <= MAX_REASONABLE_ADDRESS - address);
+}
+
 // Further
 bool bip44_containsMoreThanAddress(const bip44_path_t* pathSpec)
 {
 	return (pathSpec->length > BIP44_I_ADDRESS + 1);
 }
 
+bool bip44_isEqual(const bip44_path_t* pathSpec1, const bip44_path_t* pathSpec2)
+{
+	if (pathSpec1->length != pathSpec2->length) return false;
+	ASSERT(pathSpec1->length <= ARRAY_LEN(pathSpec1->path));
+
+	for (size_t i = 0; i < pathSpec1->length; i++) {
+		if (pathSpec1->path[i] != pathSpec2->path[i]) return false;
+	}
+	return true;
+}
+
 // returns the length of the resulting string
 size_t bip44_printToStr(const bip44_path_t* pathSpec, char* out, size_t outSize)
 {
@@ -129,7 +161,6 @@ size_t bip44_printToStr(const bip44_path_t* pathSpec, char* out, size_t outSize)
 void bip44_PRINTF(const bip44_path_t* pathSpec)
 {
 	char tmp[1 + BIP44_MAX_PATH_STRING_LENGTH];
-	SIZEOF(*pathSpec);
 	bip44_printToStr(pathSpec, tmp, SIZEOF(tmp));
 	PRINTF("%s", tmp);
 };
@@ -36,12 +36,18 @@ enum {
 
 
 bool bip44_hasValidFIOPrefix(const bip44_path_t* pathSpec);
+bool bip44_isFIOAccountPath(const bip44_path_t* pathSpec);
 
 bool bip44_containsAddress(const bip44_path_t* pathSpec);
+uint32_t bip44_getAddressValue(const bip44_path_t* pathSpec);
 bool bip44_hasReasonableAddress(const bip44_path_t* pathSpec);
+// checks all addresses from pathSpec up to pathSpec + count - 1
+bool bip44_hasReasonableAddressRange(const bip44_path_t* pathSpec, uint32_t count);
 
 bool bip44_containsMoreThanAddress(const bip44_path_t* pathSpec);
 
+bool bip44_isEqual(const bip44_path_t* pathSpec1, const bip44_path_t* pathSpec2);
+
 bool isHardened(uint32_t value);
 uint32_t unharden(uint32_t value);
 
@@ -29,8 +29,34 @@ void testcase_printToStr(const uint32_t* path, uint32_t pathLen, size_t outputSi
 	EXPECT_EQ_BYTES(result, expected, expectedSize);
 }
 
+static void test_isEqual()
+{
+	PRINTF("test_bip44_isEqual\n");
+
+	const uint32_t path[] = {HD + 44, HD + 235, HD + 0, 0, 7};
+	const uint32_t otherPath[] = {HD + 44, HD + 235, HD + 0, 0, 8};
+	bip44_path_t pathSpec1, pathSpec2;
+	explicit_bzero(&pathSpec1, SIZEOF(pathSpec1));
+	explicit_bzero(&pathSpec2, SIZEOF(pathSpec2));
+
+	pathSpec_init(&pathSpec1, path, ARRAY_LEN(path));
+	pathSpec_init(&pathSpec2, path, ARRAY_LEN(path));
+	EXPECT_EQ(bip44_isEqual(&pathSpec1, &pathSpec2), true);
+
+	// elements beyond the length do not matter
+	pathSpec_init(&pathSpec2, otherPath, ARRAY_LEN(otherPath));
+	EXPECT_EQ(bip44_isEqual(&pathSpec1, &pathSpec2), false);
+	pathSpec1.length = pathSpec2.length = 4;
+	EXPECT_EQ(bip44_isEqual(&pathSpec1, &pathSpec2), true);
+
+	pathSpec2.length = 3;
+	EXPECT_EQ(bip44_isEqual(&pathSpec1, &pathSpec2), false);
+}
+
 void run_bip44_test()
 {
+	test_isEqual();
+
 #define TESTCASE(path_, outputSize_, expected_) \
 	{ \
 		uint32_t path[] = { UNWRAP path_ }; \
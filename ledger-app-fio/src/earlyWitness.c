@@ -0,0 +1,131 @@
+#include "earlyWitness.h"
+#include "eos_utils.h"
+#include "io.h"
+
+typedef enum {
+	EARLY_WITNESS_NONE = 0,
+	EARLY_WITNESS_DERIVE_PRIVATE_KEY = 1,
+	EARLY_WITNESS_DERIVE_PUBLIC_KEY = 2,
+	EARLY_WITNESS_READY = 3,
+	EARLY_WITNESS_FAILED = 4,
+} early_witness_state_t;
+
+static struct {
+	early_witness_state_t state;
+	const bip44_path_t* pathSpec;
+	char* pubkeyWif;
+	size_t pubkeyWifSize;
+	private_key_t privateKey;
+} earlyWitness;
+
+// The derivation syscalls send heartbeats and so process nested events,
+// which may run ui_idle() and wipe the state in the middle of a step.
+// Once set, nothing is written back until the next earlyWitness_start().
+static bool wiped;
+
+void earlyWitness_wipe()
+{
+	explicit_bzero(&earlyWitness, SIZEOF(earlyWitness));
+	wiped = true;
+}
+
+// Each step is one expensive syscall, so that a ticker slice stays short.
+// Returns true when the key pair is ready or the state was wiped meanwhile.
+static bool earlyWitness_step()
+{
+	const bip44_path_t* pathSpec = earlyWitness.pathSpec;
+	private_key_t privateKey;
+
+	switch (earlyWitness.state) {
+
+	case EARLY_WITNESS_DERIVE_PRIVATE_KEY:
+		derivePrivateKey(pathSpec, &privateKey);
+		if (!wiped) {
+			memcpy(&earlyWitness.privateKey, &privateKey, SIZEOF(privateKey));
+			earlyWitness.state = EARLY_WITNESS_DERIVE_PUBLIC_KEY;
+		}
+		explicit_bzero(&privateKey, SIZEOF(privateKey));
+		return wiped;
+
+	case EARLY_WITNESS_DERIVE_PUBLIC_KEY: {
+		char* pubkeyWif = earlyWitness.pubkeyWif;
+		const size_t pubkeyWifSize = earlyWitness.pubkeyWifSize;
+		memcpy(&privateKey, &earlyWitness.privateKey, SIZEOF(privateKey));
+		public_key_t publicKey;
+		derivePublicKeyFromPrivateKey(pathSpec, &privateKey, &publicKey);
+		explicit_bzero(&privateKey, SIZEOF(privateKey));
+		if (!wiped) {
+			public_key_to_wif(publicKey.W, SIZEOF(publicKey.W), pubkeyWif, pubkeyWifSize);
+			earlyWitness.state = EARLY_WITNESS_READY;
+		}
+		return true;
+	}
+
+	case EARLY_WITNESS_READY:
+		return true;
+
+	default:
+		ASSERT(false);
+		return true;
+	}
+}
+
+// runs on ticker events, errors are not reported here,
+// the derivation is repeated when the key is taken
+static bool earlyWitness_backgroundTask()
+{
+	bool done = true;
+	BEGIN_TRY {
+		TRY {
+			done = earlyWitness_step();
+		}
+		CATCH(EXCEPTION_IO_RESET) {
+			// main() has to restart the io loop
+			earlyWitness_wipe();
+			THROW(EXCEPTION_IO_RESET);
+		}
+		CATCH_OTHER(e) {
+			TRACE("Early witness derivation failed: 0x%x", (unsigned) e);
+			explicit_bzero(&earlyWitness.privateKey, SIZEOF(earlyWitness.privateKey));
+			if (!wiped) {
+				earlyWitness.state = EARLY_WITNESS_FAILED;
+			}
+			done = true;
+		}
+		FINALLY {
+		}
+	}
+	END_TRY;
+	return done;
+}
+
+void earlyWitness_start(const bip44_path_t* pathSpec, char* pubkeyWif, size_t pubkeyWifSize)
+{
+	earlyWitness_wipe();
+	earlyWitness.state = EARLY_WITNESS_DERIVE_PRIVATE_KEY;
+	earlyWitness.pathSpec = pathSpec;
+	earlyWitness.pubkeyWif = pubkeyWif;
+	earlyWitness.pubkeyWifSize = pubkeyWifSize;
+	wiped = false;
+	io_set_background_task(earlyWitness_backgroundTask);
+}
+
+void earlyWitness_take(private_key_t* privateKey)
+{
+	io_clear_background_task();
+
+	// wiped by ui_idle() since the start
+	VALIDATE(!wiped, ERR_INVALID_STATE);
+
+	if (earlyWitness.state == EARLY_WITNESS_FAILED) {
+		// derive again to report the error
+		earlyWitness.state = EARLY_WITNESS_DERIVE_PRIVATE_KEY;
+	}
+	TRACE("Early witness state: %d", (int) earlyWitness.state);
+	while (!earlyWitness_step()) {
+	}
+	VALIDATE(!wiped, ERR_INVALID_STATE);
+
+	memcpy(privateKey, &earlyWitness.privateKey, SIZEOF(*privateKey));
+	earlyWitness_wipe();
+}
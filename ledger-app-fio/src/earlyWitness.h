@@ -0,0 +1,27 @@
+#ifndef H_FIO_APP_EARLY_WITNESS
+#define H_FIO_APP_EARLY_WITNESS
+
+#include "common.h"
+#include "bip44.h"
+#include "keyDerivation.h"
+
+// Derives the witness key pair of signTransaction in io background task slices
+// (see io_set_background_task) while the user reviews the transaction.
+// The state lives outside of instructionState so that ui_idle() can wipe it
+// regardless of the current instruction.
+
+// starts the derivation, the WIF of the public key is written to pubkeyWif;
+// pathSpec and pubkeyWif must stay valid until the key is taken or wiped
+void earlyWitness_start(const bip44_path_t* pathSpec, char* pubkeyWif, size_t pubkeyWifSize);
+
+// moves the derived key to privateKey, finishing the derivation if needed
+void earlyWitness_take(private_key_t* privateKey);
+
+// wipes the derived key, safe to call at any time
+void earlyWitness_wipe();
+
+#ifdef DEVEL
+void run_earlyWitness_test();
+#endif // DEVEL
+
+#endif // H_FIO_APP_EARLY_WITNESS
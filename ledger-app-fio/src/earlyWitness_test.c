@@ -0,0 +1,192 @@
+#ifdef DEVEL
+
+#include "earlyWitness.h"
+#include "eos_utils.h"
+#include "fio.h"
+#include "io.h"
+#include "pubkeyCache.h"
+#include "testUtils.h"
+#include "uiHelpers.h"
+#include "utils.h"
+
+static void pathSpec_init(bip44_path_t* pathSpec, const uint32_t* pathArray, uint32_t pathLength)
+{
+	explicit_bzero(pathSpec, SIZEOF(*pathSpec));
+	pathSpec->length = pathLength;
+	memmove(pathSpec->path, pathArray, pathLength * 4);
+}
+
+static void pathSpec_initWitness(bip44_path_t* pathSpec)
+{
+	const uint32_t path[] = { HARDENED_BIP32 + 44, HARDENED_BIP32 + 235, HARDENED_BIP32 + 0, 0, 0 };
+	pathSpec_init(pathSpec, path, ARRAY_LEN(path));
+}
+
+static void expectWitness(const bip44_path_t* pathSpec, const private_key_t* privateKey, const char* pubkeyWif)
+{
+	private_key_t expectedPrivateKey;
+	public_key_t expectedPublicKey;
+	deriveKeyPair(pathSpec, &expectedPrivateKey, &expectedPublicKey);
+	char expectedWif[MAX_WIF_PUBKEY_LENGTH];
+	public_key_to_wif(expectedPublicKey.W, SIZEOF(expectedPublicKey.W), expectedWif, SIZEOF(expectedWif));
+
+	EXPECT_EQ(privateKey->d_len, expectedPrivateKey.d_len);
+	EXPECT_EQ_BYTES(privateKey->d, expectedPrivateKey.d, expectedPrivateKey.d_len);
+	EXPECT_EQ(strcmp(pubkeyWif, expectedWif), 0);
+}
+
+static void testTake()
+{
+	PRINTF("earlyWitness testTake\n");
+
+	bip44_path_t pathSpec;
+	pathSpec_initWitness(&pathSpec);
+	char pubkeyWif[MAX_WIF_PUBKEY_LENGTH] = {0};
+
+	// nothing derived in the background yet
+	earlyWitness_start(&pathSpec, pubkeyWif, SIZEOF(pubkeyWif));
+	private_key_t privateKey;
+	earlyWitness_take(&privateKey);
+	expectWitness(&pathSpec, &privateKey, pubkeyWif);
+
+	// the key is handed out only once
+	EXPECT_THROWS(earlyWitness_take(&privateKey), ERR_INVALID_STATE);
+}
+
+static void testTakeRejected()
+{
+	PRINTF("earlyWitness testTakeRejected\n");
+
+	// no address
+	const uint32_t path[] = { HARDENED_BIP32 + 44, HARDENED_BIP32 + 235, HARDENED_BIP32 + 0, 0 };
+	bip44_path_t pathSpec;
+	pathSpec_init(&pathSpec, path, ARRAY_LEN(path));
+	char pubkeyWif[MAX_WIF_PUBKEY_LENGTH] = {0};
+
+	earlyWitness_start(&pathSpec, pubkeyWif, SIZEOF(pubkeyWif));
+	private_key_t privateKey;
+	EXPECT_THROWS(earlyWitness_take(&privateKey), ERR_REJECTED_BY_POLICY);
+	ui_idle();
+}
+
+// The tests below need the events of the host shim.
+#ifdef FIO_HOST
+
+static void tick()
+{
+	G_io_seproxyhal_spi_buffer[0] = SEPROXYHAL_TAG_TICKER_EVENT;
+	io_event(CHANNEL_SPI);
+}
+
+static void throwIoReset()
+{
+	THROW(EXCEPTION_IO_RESET);
+}
+
+static void testBackground()
+{
+	PRINTF("earlyWitness testBackground\n");
+
+	bip44_path_t pathSpec;
+	pathSpec_initWitness(&pathSpec);
+	char pubkeyWif[MAX_WIF_PUBKEY_LENGTH] = {0};
+
+	earlyWitness_start(&pathSpec, pubkeyWif, SIZEOF(pubkeyWif));
+	// one syscall per tick
+	tick();
+	EXPECT_EQ(pubkeyWif[0], 0);
+	tick();
+	EXPECT_EQ((pubkeyWif[0] != 0), true);
+	// nothing left to do
+	tick();
+
+	private_key_t privateKey;
+	earlyWitness_take(&privateKey);
+	expectWitness(&pathSpec, &privateKey, pubkeyWif);
+}
+
+static void testBackgroundRejected()
+{
+	PRINTF("earlyWitness testBackgroundRejected\n");
+
+	const uint32_t path[] = { HARDENED_BIP32 + 44, HARDENED_BIP32 + 235, HARDENED_BIP32 + 0, 0 };
+	bip44_path_t pathSpec;
+	pathSpec_init(&pathSpec, path, ARRAY_LEN(path));
+	char pubkeyWif[MAX_WIF_PUBKEY_LENGTH] = {0};
+
+	earlyWitness_start(&pathSpec, pubkeyWif, SIZEOF(pubkeyWif));
+	// the error is kept for the take, the task is done
+	tick();
+	tick();
+	EXPECT_EQ(pubkeyWif[0], 0);
+
+	private_key_t privateKey;
+	EXPECT_THROWS(earlyWitness_take(&privateKey), ERR_REJECTED_BY_POLICY);
+	ui_idle();
+}
+
+static void testIoReset()
+{
+	PRINTF("earlyWitness testIoReset\n");
+
+	bip44_path_t pathSpec;
+	pathSpec_initWitness(&pathSpec);
+	char pubkeyWif[MAX_WIF_PUBKEY_LENGTH] = {0};
+
+	earlyWitness_start(&pathSpec, pubkeyWif, SIZEOF(pubkeyWif));
+	shim_set_heartbeat_handler(throwIoReset);
+	// passed on to main() instead of being swallowed as a failed derivation
+	EXPECT_THROWS(tick(), EXCEPTION_IO_RESET);
+	shim_set_heartbeat_handler(NULL);
+
+	// wiped, the task is gone
+	tick();
+	EXPECT_EQ(pubkeyWif[0], 0);
+	private_key_t privateKey;
+	EXPECT_THROWS(earlyWitness_take(&privateKey), ERR_INVALID_STATE);
+	ui_idle();
+}
+
+static void testWipedDuringStep()
+{
+	PRINTF("earlyWitness testWipedDuringStep\n");
+
+	bip44_path_t pathSpec;
+	pathSpec_initWitness(&pathSpec);
+	char pubkeyWif[MAX_WIF_PUBKEY_LENGTH] = {0};
+	private_key_t privateKey;
+
+	// during the private key derivation
+	earlyWitness_start(&pathSpec, pubkeyWif, SIZEOF(pubkeyWif));
+	shim_set_heartbeat_handler(ui_idle);
+	tick();
+	shim_set_heartbeat_handler(NULL);
+	EXPECT_THROWS(earlyWitness_take(&privateKey), ERR_INVALID_STATE);
+
+	// during the public key derivation, which a cached key would skip
+	pubkeyCache_clear();
+	earlyWitness_start(&pathSpec, pubkeyWif, SIZEOF(pubkeyWif));
+	tick();
+	shim_set_heartbeat_handler(ui_idle);
+	tick();
+	shim_set_heartbeat_handler(NULL);
+	EXPECT_EQ(pubkeyWif[0], 0);
+	EXPECT_THROWS(earlyWitness_take(&privateKey), ERR_INVALID_STATE);
+	ui_idle();
+}
+
+#endif // FIO_HOST
+
+void run_earlyWitness_test()
+{
+	testTake();
+	testTakeRejected();
+	#ifdef FIO_HOST
+	testBackground();
+	testBackgroundRejected();
+	testIoReset();
+	testWipedDuringStep();
+	#endif // FIO_HOST
+}
+
+#endif // DEVEL
@@ -169,52 +169,80 @@ unsigned char const BASE58ALPHABET[58] = {
     'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'm',
     'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z'};
 
-bool b58enc(uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz)
+// The number is kept in little-endian limbs of 5 base58 digits each,
+// so the inner loop runs 5 times less often than with one digit per byte
+// and the input is consumed 4 bytes at a time.
+#define B58_LIMB_BASE 656356768u // 58^5
+#define B58_DIGITS_PER_LIMB 5
+// log(256) / log(58^5) < 0.2731
+#define B58ENC_MAX_LIMBS (B58ENC_MAX_INPUT_SIZE * 2731 / 10000 + 2)
+
+bool b58enc(const uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz)
 {
-	int carry;
-	uint32_t i, j, high, zcount = 0;
-	uint32_t size;
-	
+	uint32_t zcount = 0;
 	while (zcount < binsz && !bin[zcount])
 		++zcount;
-	
-	size = (binsz - zcount) * 138 / 100 + 1;
-	uint8_t buf[size];
-	memset(buf, 0, size);
-	
-	for (i = zcount, high = size - 1; i < binsz; ++i, high = j)
-	{
-		for (carry = bin[i], j = size - 1; (j > high) || carry; --j)
-		{
-			ASSERT(j < size);
-			carry += 256 * buf[j];
-			buf[j] = carry % 58;
-			carry /= 58;
-			if (!j) {
-				// Otherwise j wraps to maxint which is > high
-				break;
-			}
+
+	ASSERT(binsz - zcount <= B58ENC_MAX_INPUT_SIZE);
+
+	uint32_t limbs[B58ENC_MAX_LIMBS];
+	uint32_t numLimbs = 0;
+
+	for (uint32_t i = zcount; i < binsz; ) {
+		// the first chunk takes the leftover bytes, the rest are whole words
+		uint32_t chunkSize = (binsz - i) % 4;
+		if (chunkSize == 0)
+			chunkSize = 4;
+
+		uint64_t carry = 0;
+		for (uint32_t k = 0; k < chunkSize; ++k, ++i)
+			carry = (carry << 8) | bin[i];
+
+		// limbs = limbs * 256^chunkSize + chunk
+		for (uint32_t j = 0; j < numLimbs; ++j) {
+			carry += (uint64_t) limbs[j] << (8 * chunkSize);
+			limbs[j] = (uint32_t) (carry % B58_LIMB_BASE);
+			carry /= B58_LIMB_BASE;
 		}
+		while (carry) {
+			ASSERT(numLimbs < B58ENC_MAX_LIMBS);
+			limbs[numLimbs++] = (uint32_t) (carry % B58_LIMB_BASE);
+			carry /= B58_LIMB_BASE;
+		}
+	}
+
+	// all limbs but the most significant one have exactly 5 digits
+	uint32_t numDigits = 0;
+	if (numLimbs > 0) {
+		numDigits = (numLimbs - 1) * B58_DIGITS_PER_LIMB;
+		for (uint32_t top = limbs[numLimbs - 1]; top; top /= 58)
+			++numDigits;
 	}
-	
-	for (j = 0; j < size && !buf[j]; ++j);
-	
-	if (*b58sz <= zcount + size - j)
+
+	if (*b58sz <= zcount + numDigits)
 	{
-		*b58sz = zcount + size - j + 1;
+		*b58sz = zcount + numDigits + 1;
 		return false;
 	}
-	
+
 	if (zcount)
 		memset(b58, '1', zcount);
-	for (i = zcount; j < size; ++i, ++j) {
-		ASSERT(buf[j] < 58);
-		ASSERT(i < *b58sz);
-		b58[i] = BASE58ALPHABET[buf[j]];
+
+	uint32_t pos = zcount + numDigits;
+	b58[pos] = '\0';
+	*b58sz = pos + 1;
+
+	for (uint32_t j = 0; j < numLimbs; ++j) {
+		uint32_t limb = limbs[j];
+		const bool isTop = (j + 1 == numLimbs);
+		for (uint32_t d = 0; d < B58_DIGITS_PER_LIMB && (limb || !isTop); ++d) {
+			ASSERT(pos > zcount);
+			b58[--pos] = BASE58ALPHABET[limb % 58];
+			limb /= 58;
+		}
 	}
-	b58[i] = '\0';
-	*b58sz = i + 1;
-	
+	ASSERT(pos == zcount);
+
 	return true;
 }
 
@@ -31,6 +31,19 @@ void rng_rfc6979(unsigned char *rnd,
                  const unsigned char *q, unsigned int q_len,
                  unsigned char *V, unsigned char *K);
 
+// significant bytes, leading zero bytes are not limited
+#define B58ENC_MAX_INPUT_SIZE 64
+
+// Writes a NUL-terminated string. On success *b58sz is set to its size including the terminator,
+// if the output buffer is too small, returns false and sets *b58sz to the required size.
+bool b58enc(const uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz);
+
+uint32_t compressed_public_key_to_wif(const uint8_t *publicKey, uint32_t keyLength, char *out, uint32_t outLength);
+
 uint32_t public_key_to_wif(const uint8_t *publicKey, uint32_t keyLength, char *out, uint32_t outLength);
 
+#ifdef DEVEL
+void run_eos_utils_test();
+#endif // DEVEL
+
 #endif
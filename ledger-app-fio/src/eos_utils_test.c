@@ -0,0 +1,167 @@
+#ifdef DEVEL
+
+#include "eos_utils.h"
+#include "hexUtils.h"
+#include "testUtils.h"
+#include "utils.h"
+
+static void testcase_b58enc(const char* inputHex, const char* expected)
+{
+	PRINTF("testcase_b58enc %s\n", inputHex);
+
+	uint8_t input[2 * B58ENC_MAX_INPUT_SIZE];
+	size_t inputSize = decode_hex(inputHex, input, SIZEOF(input));
+
+	char output[200];
+	uint32_t outputSize = SIZEOF(output);
+	EXPECT_EQ(b58enc(input, inputSize, output, &outputSize), true);
+	EXPECT_EQ(outputSize, strlen(expected) + 1);
+	EXPECT_EQ_BYTES(expected, output, outputSize);
+}
+
+static void test_b58enc()
+{
+	testcase_b58enc("", "");
+	testcase_b58enc("00", "1");
+	testcase_b58enc("0000", "11");
+	testcase_b58enc("61", "2g");
+	testcase_b58enc("626262", "a3gV");
+	testcase_b58enc("48656c6c6f20576f726c6421", "2NEpo7TZRRrLZSi2U");
+	testcase_b58enc("0000287fb4cd", "11233QC4");
+	testcase_b58enc(
+	        "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+	        "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+	        "67rpwLCuS5DGA8KGZXKsVQ7dnPb9goRLoKfgGbLfQg9WoLUgNY77E2jT11fem3coV9nAkguBACzrU1iyZM4B8roQ"
+	);
+
+	// all zeros, leading zeros and 0xff..ff of the max significant size
+	testcase_b58enc(
+	        "0000000000000000000000000000000000000000000000000000000000000000"
+	        "0000000000000000000000000000000000000000000000000000000000000000",
+	        "1111111111111111111111111111111111111111111111111111111111111111"
+	);
+	testcase_b58enc("000000ff", "1115Q");
+	testcase_b58enc("00000001", "1112");
+	testcase_b58enc(
+	        "00000000"
+	        "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+	        "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff",
+	        "1111"
+	        "67rpwLCuS5DGA8KGZXKsVQ7dnPb9goRLoKfgGbLfQg9WoLUgNY77E2jT11fem3coV9nAkguBACzrU1iyZM4B8roQ"
+	);
+
+	{
+		// output buffer too small, required size includes the terminating zero
+		const uint8_t input[] = {0x00, 0x00, 0x28, 0x7f, 0xb4, 0xcd};
+		char output[8];
+		uint32_t outputSize = SIZEOF(output);
+		EXPECT_EQ(b58enc(input, SIZEOF(input), output, &outputSize), false);
+		EXPECT_EQ(outputSize, 9);
+	}
+}
+
+// the former byte-wise encoder, kept as a reference for the limb encoder
+static bool b58enc_reference(const uint8_t *bin, uint32_t binsz, char *b58, uint32_t *b58sz)
+{
+	static const char alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+	uint32_t zcount = 0;
+	while (zcount < binsz && !bin[zcount])
+		++zcount;
+
+	uint8_t buf[2 * B58ENC_MAX_INPUT_SIZE];
+	const uint32_t size = (binsz - zcount) * 138 / 100 + 1;
+	ASSERT(size <= SIZEOF(buf));
+	memset(buf, 0, size);
+
+	uint32_t high = size - 1;
+	for (uint32_t i = zcount; i < binsz; ++i) {
+		uint32_t j = size - 1;
+		for (int carry = bin[i]; (j > high) || carry; --j) {
+			carry += 256 * buf[j];
+			buf[j] = carry % 58;
+			carry /= 58;
+			if (!j)
+				break;
+		}
+		high = j;
+	}
+
+	uint32_t j = 0;
+	while (j < size && !buf[j])
+		++j;
+
+	if (*b58sz <= zcount + size - j) {
+		*b58sz = zcount + size - j + 1;
+		return false;
+	}
+
+	memset(b58, '1', zcount);
+	uint32_t i = zcount;
+	for (; j < size; ++i, ++j)
+		b58[i] = alphabet[buf[j]];
+	b58[i] = '\0';
+	*b58sz = i + 1;
+	return true;
+}
+
+static void test_b58enc_random()
+{
+	PRINTF("test_b58enc_random\n");
+
+	// xorshift, the same inputs on every run
+	uint32_t state = 0x12345678;
+	for (unsigned n = 0; n < 2000; n++) {
+		uint8_t input[8 + B58ENC_MAX_INPUT_SIZE];
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		const uint32_t zeros = state % 8;
+		const uint32_t inputSize = zeros + (state >> 8) % (B58ENC_MAX_INPUT_SIZE + 1);
+		for (uint32_t i = 0; i < inputSize; i++) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			// some 0x00 and 0xff runs
+			input[i] = (i < zeros) ? 0x00 : (state % 4 == 0) ? 0xff : (uint8_t) (state >> 8);
+		}
+
+		char expected[200];
+		uint32_t expectedSize = SIZEOF(expected);
+		EXPECT_EQ(b58enc_reference(input, inputSize, expected, &expectedSize), true);
+
+		char output[200];
+		uint32_t outputSize = SIZEOF(output);
+		EXPECT_EQ(b58enc(input, inputSize, output, &outputSize), true);
+		EXPECT_EQ(outputSize, expectedSize);
+		EXPECT_EQ_BYTES(expected, output, outputSize);
+
+		// one byte short reports the same required size
+		outputSize = expectedSize - 1;
+		EXPECT_EQ(b58enc(input, inputSize, output, &outputSize), false);
+		EXPECT_EQ(outputSize, expectedSize);
+	}
+}
+
+static void test_compressed_public_key_to_wif()
+{
+	PRINTF("test_compressed_public_key_to_wif\n");
+
+	uint8_t publicKey[33];
+	decode_hex("03a9a222bc3b1a5a58ada17d10069b3961ebd0f917d4b2106031a061915ca9cc24", publicKey, SIZEOF(publicKey));
+
+	const char* expected = "FIO87wawwaniQzqWPmNaCqGkiUNmCAhq9PiGUVNKKjRMTYgoBfKYa";
+	char wif[60];
+	uint32_t wifSize = compressed_public_key_to_wif(publicKey, SIZEOF(publicKey), wif, SIZEOF(wif));
+	EXPECT_EQ(wifSize, strlen(expected) + 1);
+	EXPECT_EQ_BYTES(expected, wif, wifSize);
+}
+
+void run_eos_utils_test()
+{
+	PRINTF("Running eos utils tests\n");
+	test_b58enc();
+	test_b58enc_random();
+	test_compressed_public_key_to_wif();
+}
+
+#endif // DEVEL
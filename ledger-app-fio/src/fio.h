@@ -30,6 +30,9 @@ void uint8array_name_to_string(uint8_t *value, size_t valueSize, char *out, size
 #define MAX_WIF_PUBKEY_LENGTH 55
 #define MAX_TPID_LENGTH 21
 
+// actions in a single transaction, the count fits into a single-byte varuint
+#define MAX_TX_ACTIONS 50
+
 #define MAX_SINGLE_BYTE_LENGTH 127
 
 #endif // H_FIO_APP_FIO
@@ -0,0 +1,103 @@
+#include "state.h"
+#include "securityPolicy.h"
+#include "uiHelpers.h"
+#include "uiScreens.h"
+#include "getAccountPublicKey.h"
+#include "utils.h"
+
+static int16_t RESPONSE_READY_MAGIC = 23457;
+
+static ins_get_account_key_context_t* ctx = &(instructionState.getAccountKeyContext);
+
+static int UI_STEP_NONE = 0;
+
+enum {
+	GET_ACCOUNT_KEY_UI_STEP_DISPLAY_PATH = 400,
+	GET_ACCOUNT_KEY_UI_STEP_CONFIRM,
+	GET_ACCOUNT_KEY_UI_STEP_RESPOND,
+	GET_ACCOUNT_KEY_UI_STEP_INVALID,
+} ;
+
+static void getAccountPublicKey_ui_runStep()
+{
+	TRACE("UI step %d", ctx->ui_step);
+	ui_callback_fn_t* this_fn = getAccountPublicKey_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step, this_fn);
+
+	UI_STEP(GET_ACCOUNT_KEY_UI_STEP_DISPLAY_PATH) {
+		ui_displayPathScreen("Export account key", &ctx->pathSpec, this_fn);
+	}
+	UI_STEP(GET_ACCOUNT_KEY_UI_STEP_CONFIRM) {
+		ui_displayPrompt(
+		        "Confirm export",
+		        "account public key?",
+		        this_fn,
+		        respond_with_user_reject
+		);
+	}
+	UI_STEP(GET_ACCOUNT_KEY_UI_STEP_RESPOND) {
+		ASSERT(ctx->responseReadyMagic == RESPONSE_READY_MAGIC);
+
+		const public_key_t* pubKey = &ctx->extPubKey.pubKey;
+		const chain_code_t* chainCode = &ctx->extPubKey.chainCode;
+		STATIC_ASSERT(SIZEOF(pubKey->W) + SIZEOF(chainCode->code) <= SIZEOF(G_io_apdu_buffer) - 2, "response too long");
+
+		memmove(G_io_apdu_buffer, pubKey->W, SIZEOF(pubKey->W));
+		memmove(G_io_apdu_buffer + SIZEOF(pubKey->W), chainCode->code, SIZEOF(chainCode->code));
+		io_send_buf(SUCCESS, G_io_apdu_buffer, SIZEOF(pubKey->W) + SIZEOF(chainCode->code));
+
+		ctx->responseReadyMagic = 0; // just for safety
+		ui_displayBusy(); // needs to happen after I/O
+
+		TRACE("Export done.");
+
+		ui_idle();
+	}
+	UI_STEP_END(GET_ACCOUNT_KEY_UI_STEP_INVALID);
+}
+
+void getAccountPublicKey_handleAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t* wireDataBuffer,
+        size_t wireDataSize,
+        bool isNewCall
+)
+{
+	VALIDATE(isNewCall, ERR_INVALID_STATE);
+	VALIDATE(p1 == P1_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+
+	explicit_bzero(ctx, SIZEOF(*ctx));
+	ctx->ui_step = UI_STEP_NONE;
+
+	{
+		// parse
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		size_t parsedSize = bip44_parseFromWire(&ctx->pathSpec, wireDataBuffer, wireDataSize);
+		VALIDATE(parsedSize == wireDataSize, ERR_INVALID_DATA);
+	}
+
+	security_policy_t policy = policyForGetAccountPublicKey(&ctx->pathSpec);
+	TRACE("Policy: %d", (int) policy);
+	ENSURE_NOT_DENIED(policy);
+
+	{
+		// Calculation
+		deriveExtendedPublicKey(&ctx->pathSpec, &ctx->extPubKey);
+		ctx->responseReadyMagic = RESPONSE_READY_MAGIC;
+	}
+
+	switch (policy) {
+#	define  CASE(policy, step) case policy: {ctx->ui_step = step; break;}
+		CASE(POLICY_PROMPT_BEFORE_RESPONSE, GET_ACCOUNT_KEY_UI_STEP_DISPLAY_PATH);
+#	undef   CASE
+	default:
+		ASSERT(false);
+	}
+
+	getAccountPublicKey_ui_runStep();
+}
@@ -0,0 +1,20 @@
+#ifndef H_FIO_APP_GET_ACCOUNT_PUBLIC_KEY
+#define H_FIO_APP_GET_ACCOUNT_PUBLIC_KEY
+
+#include "common.h"
+#include "handlers.h"
+#include "bip44.h"
+#include "keyDerivation.h"
+
+typedef struct {
+	bip44_path_t pathSpec;
+	extended_public_key_t extPubKey;
+
+	uint16_t responseReadyMagic;
+
+	int ui_step;
+} ins_get_account_key_context_t;
+
+handler_fn_t getAccountPublicKey_handleAPDU;
+
+#endif // H_FIO_APP_GET_ACCOUNT_PUBLIC_KEY
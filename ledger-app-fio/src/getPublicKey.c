@@ -5,6 +5,8 @@
 #include "getPublicKey.h"
 #include "utils.h"
 #include "eos_utils.h"
+#include "endian.h"
+#include "lastResponse.h"
 
 static int16_t RESPONSE_READY_MAGIC = 23456;
 
@@ -30,6 +32,12 @@ static void advanceStage()
 		ui_idle(); // we are done with this key export
 		break;
 
+	case GET_KEY_STAGE_BATCH:
+		if (ctx->remainingKeys > 0) break; // waiting for P1_BATCH_NEXT
+		ctx->stage = GET_KEY_STAGE_NONE;
+		ui_idle(); // we are done with the whole batch
+		break;
+
 	default:
 		ASSERT(false);
 	}
@@ -64,7 +72,7 @@ static void getPublicKey_ui_runStep()
 		ui_displayPathScreen("Export public key", &ctx->pathSpec, this_fn);
 	}
 	UI_STEP(GET_KEY_UI_STEP_DISPLAY_PUBKEY) {
-		ui_displayPubkeyScreen("Public key", &ctx->pubKey, this_fn);
+		ui_displayPubkeyScreen("Public key", ctx->pubKeyWif, this_fn);
 	}
 	UI_STEP(GET_KEY_UI_STEP_CONFIRM) {
 		ui_displayPrompt(
@@ -77,11 +85,13 @@ static void getPublicKey_ui_runStep()
 	UI_STEP(GET_KEY_UI_STEP_RESPOND) {
 		ASSERT(ctx->responseReadyMagic == RESPONSE_READY_MAGIC);
 
-		memmove(G_io_apdu_buffer, ctx->pubKey.W, SIZEOF(ctx->pubKey.W));
-		uint32_t wifkeylen = public_key_to_wif(ctx->pubKey.W, SIZEOF(ctx->pubKey.W), 
-				(char *)G_io_apdu_buffer + SIZEOF(ctx->pubKey.W), MAX_WIF_PUBKEY_LENGTH);
 		//we do not copy trailing 0
-		io_send_buf(SUCCESS, G_io_apdu_buffer, SIZEOF(ctx->pubKey.W) + wifkeylen - 1);
+		const size_t wifLength = strlen(ctx->pubKeyWif);
+		STATIC_ASSERT(SIZEOF(ctx->pubKey.W) + SIZEOF(ctx->pubKeyWif) <= SIZEOF(G_io_apdu_buffer), "response too long");
+		memmove(G_io_apdu_buffer, ctx->pubKey.W, SIZEOF(ctx->pubKey.W));
+		memmove(G_io_apdu_buffer + SIZEOF(ctx->pubKey.W), ctx->pubKeyWif, wifLength);
+		lastResponse_save(G_io_apdu_buffer, SIZEOF(ctx->pubKey.W) + wifLength);
+		io_send_buf(SUCCESS, G_io_apdu_buffer, SIZEOF(ctx->pubKey.W) + wifLength);
 
 		ctx->responseReadyMagic = 0; // just for safety
 		ui_displayBusy(); // needs to happen after I/O
@@ -111,6 +121,11 @@ static void runGetPublicKeyUIFlow()
 		        & ctx->pathSpec,
 		        & ctx->pubKey
 		);
+		// shared by the display and the response
+		public_key_to_wif(
+		        ctx->pubKey.W, SIZEOF(ctx->pubKey.W),
+		        ctx->pubKeyWif, SIZEOF(ctx->pubKeyWif)
+		);
 		ctx->responseReadyMagic = RESPONSE_READY_MAGIC;
 	}
 
@@ -127,6 +142,126 @@ static void runGetPublicKeyUIFlow()
 	getPublicKey_ui_runStep();
 }
 
+// ============================== Batch export ==============================
+
+// derives up to MAX_PUBLIC_KEYS_PER_RESPONSE keys, starting at ctx->pathSpec,
+// and sends them in compressed form
+static void respondWithNextBatchChunk()
+{
+	ASSERT(ctx->stage == GET_KEY_STAGE_BATCH);
+	ASSERT(ctx->remainingKeys > 0);
+
+	STATIC_ASSERT(MAX_PUBLIC_KEYS_PER_RESPONSE * COMPRESSED_PUBLIC_KEY_SIZE <= SIZEOF(G_io_apdu_buffer) - 2, "response too long");
+
+	const size_t numKeys = (ctx->remainingKeys < MAX_PUBLIC_KEYS_PER_RESPONSE)
+	                       ? ctx->remainingKeys
+	                       : MAX_PUBLIC_KEYS_PER_RESPONSE;
+	size_t responseSize = 0;
+
+	for (size_t i = 0; i < numKeys; i++) {
+		// do not let a large scan evict the keys the wallet keeps asking for
+		derivePublicKeyUncached(&ctx->pathSpec, &ctx->pubKey);
+		extractCompressedPublicKey(
+		        &ctx->pubKey,
+		        G_io_apdu_buffer + responseSize,
+		        COMPRESSED_PUBLIC_KEY_SIZE
+		);
+		responseSize += COMPRESSED_PUBLIC_KEY_SIZE;
+
+		ctx->remainingKeys--;
+		// overflow was excluded when parsing the request
+		ctx->pathSpec.path[BIP44_I_ADDRESS]++;
+	}
+	explicit_bzero(&ctx->pubKey, SIZEOF(ctx->pubKey));
+
+	io_send_buf(SUCCESS, G_io_apdu_buffer, responseSize);
+	ui_displayBusy(); // needs to happen after I/O
+
+	TRACE("Batch chunk sent, %d keys remaining", (int) ctx->remainingKeys);
+
+	advanceStage();
+}
+
+enum {
+	GET_KEYS_UI_STEP_WARNING = 300,
+	GET_KEYS_UI_STEP_DISPLAY_PATH,
+	GET_KEYS_UI_STEP_DISPLAY_COUNT,
+	GET_KEYS_UI_STEP_CONFIRM,
+	GET_KEYS_UI_STEP_RESPOND,
+	GET_KEYS_UI_STEP_INVALID,
+} ;
+
+static void getPublicKeysBatch_ui_runStep()
+{
+	TRACE("UI step %d", ctx->ui_step);
+	ui_callback_fn_t* this_fn = getPublicKeysBatch_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step, this_fn);
+
+	UI_STEP(GET_KEYS_UI_STEP_WARNING) {
+		ui_displayPaginatedText(
+		        "Unusual request",
+		        "Proceed with care",
+		        this_fn
+		);
+	}
+	UI_STEP(GET_KEYS_UI_STEP_DISPLAY_PATH) {
+		ui_displayPathScreen("Export keys from", &ctx->pathSpec, this_fn);
+	}
+	UI_STEP(GET_KEYS_UI_STEP_DISPLAY_COUNT) {
+		ui_displayUint64Screen("Number of keys", ctx->numKeys, this_fn);
+	}
+	UI_STEP(GET_KEYS_UI_STEP_CONFIRM) {
+		ui_displayPrompt(
+		        "Confirm export",
+		        "public keys?",
+		        this_fn,
+		        respond_with_user_reject
+		);
+	}
+	UI_STEP(GET_KEYS_UI_STEP_RESPOND) {
+		respondWithNextBatchChunk();
+	}
+	UI_STEP_END(GET_KEYS_UI_STEP_INVALID);
+}
+
+static void handleBatchInit(uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	{
+		// parse
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		size_t parsedSize = bip44_parseFromWire(&ctx->pathSpec, wireDataBuffer, wireDataSize);
+		VALIDATE(wireDataSize == parsedSize + 4, ERR_INVALID_DATA);
+		ctx->numKeys = u4be_read(wireDataBuffer + parsedSize);
+		ctx->remainingKeys = ctx->numKeys;
+	}
+
+	// Check security policy
+	security_policy_t policy = policyForGetPublicKeysBatch(&ctx->pathSpec, ctx->numKeys);
+	TRACE("Policy: %d", (int) policy);
+	ENSURE_NOT_DENIED(policy);
+
+	switch (policy) {
+#	define  CASE(policy, step) case policy: {ctx->ui_step = step; break;}
+		CASE(POLICY_PROMPT_WARN_UNUSUAL,    GET_KEYS_UI_STEP_WARNING);
+		CASE(POLICY_ALLOW_WITHOUT_PROMPT,   GET_KEYS_UI_STEP_RESPOND);
+#	undef   CASE
+	default:
+		ASSERT(false);
+	}
+
+	getPublicKeysBatch_ui_runStep();
+}
+
+static void handleBatchNext(uint8_t* wireDataBuffer MARK_UNUSED, size_t wireDataSize)
+{
+	CHECK_STAGE(GET_KEY_STAGE_BATCH);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_DATA);
+
+	respondWithNextBatchChunk();
+}
+
 // ============================== MAIN HANDLER ==============================
 
 void getPublicKey_handleAPDU(
@@ -137,16 +272,34 @@ void getPublicKey_handleAPDU(
         bool isNewCall
 )
 {
-	VALIDATE(isNewCall, ERR_INVALID_STATE);
-	VALIDATE(p1 == P1_SHOW_PUBKEY || p1 == P1_DO_NOT_SHOW_PUBKEY, ERR_INVALID_REQUEST_PARAMETERS);
 	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+
+	if (p1 == P1_BATCH_NEXT) {
+		VALIDATE(!isNewCall, ERR_INVALID_STATE);
+		handleBatchNext(wireDataBuffer, wireDataSize);
+		return;
+	}
+
+	// an abandoned batch export is treated like an unfinished call of another instruction
+	// so that the host can transparently retry
+	VALIDATE(isNewCall || ctx->stage != GET_KEY_STAGE_BATCH, ERR_STILL_IN_CALL);
+	VALIDATE(isNewCall, ERR_INVALID_STATE);
 
 	explicit_bzero(ctx, SIZEOF(*ctx));
-	ctx->stage = GET_KEY_STAGE_INIT;
 	ctx->ui_step = UI_STEP_NONE;
 
+	if (p1 == P1_BATCH_INIT) {
+		ctx->stage = GET_KEY_STAGE_BATCH;
+		handleBatchInit(wireDataBuffer, wireDataSize);
+		return;
+	}
+
+	VALIDATE(p1 == P1_SHOW_PUBKEY || p1 == P1_DO_NOT_SHOW_PUBKEY, ERR_INVALID_REQUEST_PARAMETERS);
+
+	ctx->stage = GET_KEY_STAGE_INIT;
+
 	CHECK_STAGE(GET_KEY_STAGE_INIT);
-	ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 
 	{
 		ctx->show_or_not = p1;
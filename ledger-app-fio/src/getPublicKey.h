@@ -5,17 +5,24 @@
 #include "handlers.h"
 #include "bip44.h"
 #include "keyDerivation.h"
+#include "fio.h"
 
 #define MAX_PUBLIC_KEYS 1000
 
+// 7 * 33 bytes fits into a single response APDU
+#define MAX_PUBLIC_KEYS_PER_RESPONSE 7
+
 typedef enum {
 	GET_KEY_STAGE_NONE = 0,
 	GET_KEY_STAGE_INIT = 20,
+	GET_KEY_STAGE_BATCH = 21,
 } get_key_stage_t;
 
 typedef enum {
 	P1_SHOW_PUBKEY = 1,
 	P1_DO_NOT_SHOW_PUBKEY = 2,
+	P1_BATCH_INIT = 3,
+	P1_BATCH_NEXT = 4,
 } get_key_p1_t;
 
 typedef struct {
@@ -24,6 +31,11 @@ typedef struct {
 
 	bip44_path_t pathSpec;
 	public_key_t pubKey;
+	char pubKeyWif[MAX_WIF_PUBKEY_LENGTH]; // null terminated
+
+	// batch export only; pathSpec is the next key to be derived
+	uint32_t numKeys;
+	uint32_t remainingKeys;
 
 	uint16_t responseReadyMagic;
 
@@ -6,9 +6,17 @@
 #include "handlers.h"
 #include "getVersion.h"
 #include "getSerial.h"
+#include "lastResponse.h"
 #include "getPublicKey.h"
+#include "getAccountPublicKey.h"
 #include "signTransaction.h"
+#include "signingSession.h"
 #include "runTests.h"
+#include "benchmark.h"
+#include "profiler.h"
+#include "stackUsage.h"
+#include "pubkeyCache.h"
+#include "uiHelpers.h"
 
 // The APDU protocol uses a single-byte instruction code (INS) to specify
 // which command should be executed. We'll use this code to dispatch on a
@@ -20,18 +28,29 @@ handler_fn_t* lookupHandler(uint8_t ins)
 		// 0x0* -  app status calls
 		CASE(0x00, getVersion_handleAPDU);
 		CASE(0x01, getSerial_handleAPDU);
+		CASE(0x02, lastResponse_handleAPDU);
 
 		// 0x1* -  public-key related
 		CASE(0x10, getPublicKey_handleAPDU);
+		CASE(0x11, getAccountPublicKey_handleAPDU);
 
 		// 0x2* -  transaction related
 		CASE(0x20, signTransaction_handleAPDU);
+		CASE(0x21, signingSession_handleAPDU);
 
 		#ifdef DEVEL
 		// 0xF* -  debug_mode related
 		CASE(0xF0, handleRunTests);
-		//   0xF1  reserved for INS_SET_HEADLESS_INTERACTION
+		#ifdef HEADLESS
+		CASE(0xF1, ui_handleSetHeadlessInteractionAPDU);
+		#endif // HEADLESS
+		CASE(0xF2, pubkeyCache_handleGetStatsAPDU);
+		CASE(0xF3, benchmark_handleAPDU);
+		CASE(0xF5, stackUsage_handleGetStackUsageAPDU);
 		#endif // DEVEL
+		#ifdef PROFILING
+		CASE(0xF4, profiler_handleGetProfileAPDU);
+		#endif // PROFILING
 #	undef   CASE
 	default:
 		return NULL;
@@ -0,0 +1,81 @@
+#include "hash.h"
+
+#ifdef DEVEL
+#define COUNT_SYSCALL(ctx) ((ctx)->syscallCount++)
+#define COUNT_APPEND(ctx) ((ctx)->appendCount++)
+#else
+#define COUNT_SYSCALL(ctx)
+#define COUNT_APPEND(ctx)
+#endif // DEVEL
+
+void sha_256_buffered_init(sha_256_buffered_context_t* ctx)
+{
+	explicit_bzero(ctx, SIZEOF(*ctx));
+	sha_256_init(&ctx->hashContext);
+}
+
+static void flushBuffer(sha_256_buffered_context_t* ctx)
+{
+	if (ctx->bufferSize == 0) return;
+
+	sha_256_append(&ctx->hashContext, ctx->buffer, ctx->bufferSize);
+	COUNT_SYSCALL(ctx);
+	ctx->bufferSize = 0;
+}
+
+void sha_256_buffered_append(sha_256_buffered_context_t* ctx, const uint8_t* inBuffer, size_t inSize)
+{
+	ASSERT(ctx->hashContext.initialized_magic == HASH_CONTEXT_INITIALIZED_MAGIC);
+	ASSERT(inSize < BUFFER_SIZE_PARANOIA);
+	ASSERT(ctx->bufferSize < SIZEOF(ctx->buffer));
+	COUNT_APPEND(ctx);
+
+	// top up the pending block first
+	if (ctx->bufferSize > 0) {
+		size_t chunkSize = SIZEOF(ctx->buffer) - ctx->bufferSize;
+		if (chunkSize > inSize) chunkSize = inSize;
+
+		memmove(ctx->buffer + ctx->bufferSize, inBuffer, chunkSize);
+		ctx->bufferSize += chunkSize;
+		inBuffer += chunkSize;
+		inSize -= chunkSize;
+
+		if (ctx->bufferSize < SIZEOF(ctx->buffer)) return;
+		flushBuffer(ctx);
+	}
+
+	// whole blocks do not need to be copied
+	const size_t directSize = inSize - inSize % SHA_256_BLOCK_SIZE;
+	if (directSize > 0) {
+		sha_256_append(&ctx->hashContext, inBuffer, directSize);
+		COUNT_SYSCALL(ctx);
+		inBuffer += directSize;
+		inSize -= directSize;
+	}
+
+	ASSERT(inSize < SIZEOF(ctx->buffer));
+	memmove(ctx->buffer, inBuffer, inSize);
+	ctx->bufferSize = inSize;
+}
+
+void sha_256_buffered_finalize(sha_256_buffered_context_t* ctx, uint8_t* outBuffer, size_t outSize)
+{
+	ASSERT(ctx->hashContext.initialized_magic == HASH_CONTEXT_INITIALIZED_MAGIC);
+	ASSERT(outSize == SHA_256_SIZE);
+
+	// the rest of the data goes with the final call
+	cx_hash(
+	        & ctx->hashContext.cx_ctx.header,
+	        CX_LAST,
+	        ctx->buffer,
+	        ctx->bufferSize,
+	        outBuffer,
+	        SHA_256_SIZE
+	);
+	COUNT_SYSCALL(ctx);
+
+	TRACE("SHA-256: %d appends, %d syscalls", (int) ctx->appendCount, (int) ctx->syscallCount);
+
+	explicit_bzero(ctx->buffer, SIZEOF(ctx->buffer));
+	ctx->bufferSize = 0;
+}
@@ -20,13 +20,13 @@ typedef struct {
 	cx_sha256_t cx_ctx;
 } sha_256_context_t;
 
-static __attribute__((always_inline, unused)) void sha_256_init(sha_256_context_t* ctx)
+static inline __attribute__((always_inline, unused)) void sha_256_init(sha_256_context_t* ctx)
 {
 	cx_sha256_init(&ctx->cx_ctx);
 	ctx->initialized_magic = HASH_CONTEXT_INITIALIZED_MAGIC;
 }
 
-static __attribute__((always_inline, unused)) void sha_256_append(sha_256_context_t* ctx,
+static inline __attribute__((always_inline, unused)) void sha_256_append(sha_256_context_t* ctx,
         const uint8_t* inBuffer, size_t inSize)
 {
 	ASSERT(ctx->initialized_magic == HASH_CONTEXT_INITIALIZED_MAGIC);
@@ -40,10 +40,9 @@ static __attribute__((always_inline, unused)) void sha_256_append(sha_256_contex
 	);
 }
 
-static __attribute__((always_inline, unused)) void sha_256_finalize(sha_256_context_t* ctx,
+static inline __attribute__((always_inline, unused)) void sha_256_finalize(sha_256_context_t* ctx,
         uint8_t* outBuffer, size_t outSize)
 {
-	\
 	ASSERT(ctx->initialized_magic == HASH_CONTEXT_INITIALIZED_MAGIC);
 	ASSERT(outSize == SHA_256_SIZE);
 	cx_hash(
@@ -57,7 +56,7 @@ static __attribute__((always_inline, unused)) void sha_256_finalize(sha_256_cont
 }
 
 /* Convenience function to make all in one step */
-static __attribute__((always_inline, unused)) void sha_256_hash(const uint8_t* inBuffer, size_t inSize,
+static inline __attribute__((always_inline, unused)) void sha_256_hash(const uint8_t* inBuffer, size_t inSize,
         uint8_t* outBuffer, size_t outSize )
 {
 	ASSERT(inSize < BUFFER_SIZE_PARANOIA);
@@ -70,5 +69,29 @@ static __attribute__((always_inline, unused)) void sha_256_hash(const uint8_t* i
 	sha_256_finalize(&ctx, outBuffer, outSize);
 }
 
+// Buffered variant for many small appends (e.g. transaction serialization).
+// Every cx_hash call is a syscall, so appends are collected into a block
+// and passed to the OS only once the block is full or at finalize.
+enum {
+	SHA_256_BLOCK_SIZE = 64,
+};
+
+typedef struct {
+	sha_256_context_t hashContext;
+	uint8_t buffer[SHA_256_BLOCK_SIZE];
+	uint8_t bufferSize;
+	#ifdef DEVEL
+	uint16_t appendCount;
+	uint16_t syscallCount;
+	#endif // DEVEL
+} sha_256_buffered_context_t;
+
+void sha_256_buffered_init(sha_256_buffered_context_t* ctx);
+void sha_256_buffered_append(sha_256_buffered_context_t* ctx, const uint8_t* inBuffer, size_t inSize);
+void sha_256_buffered_finalize(sha_256_buffered_context_t* ctx, uint8_t* outBuffer, size_t outSize);
+
+#ifdef DEVEL
+void run_hash_test();
+#endif // DEVEL
 
 #endif // H_FIO_APP_HASH
@@ -0,0 +1,93 @@
+#ifdef DEVEL
+
+#include "hash.h"
+#include "testUtils.h"
+#include "utils.h"
+
+// appends data in fragments of the given sizes (cyclically)
+static void testcase_bufferedHash(const uint8_t* data, size_t dataSize, const size_t* fragmentSizes, size_t numFragmentSizes)
+{
+	PRINTF("testcase_bufferedHash %d bytes\n", (int) dataSize);
+
+	sha_256_buffered_context_t ctx;
+	sha_256_buffered_init(&ctx);
+
+	size_t offset = 0;
+	for (size_t i = 0; offset < dataSize; i++) {
+		size_t fragmentSize = fragmentSizes[i % numFragmentSizes];
+		if (fragmentSize > dataSize - offset) fragmentSize = dataSize - offset;
+		sha_256_buffered_append(&ctx, data + offset, fragmentSize);
+		offset += fragmentSize;
+	}
+
+	uint8_t result[SHA_256_SIZE];
+	sha_256_buffered_finalize(&ctx, result, SIZEOF(result));
+
+	uint8_t expected[SHA_256_SIZE];
+	sha_256_hash(data, dataSize, expected, SIZEOF(expected));
+
+	EXPECT_EQ_BYTES(expected, result, SIZEOF(expected));
+
+	// at most one syscall per block (plus finalize)
+	EXPECT_EQ((ctx.syscallCount <= dataSize / SHA_256_BLOCK_SIZE + 1), true);
+}
+
+// the appends of signing a transfer field by field, 207 bytes in total
+static void testTransferSyscalls(const uint8_t* data, size_t dataSize)
+{
+	PRINTF("testTransferSyscalls\n");
+
+	const size_t appendSizes[] = {
+		32, // chain id
+		4, 2, 4, 4, 1, // header
+		16, // action header
+		1, 8, 8, // authorization
+		1, 1, 53, 8, 8, 8, 1, 14, // transfer data, tpid rewards@wallet
+		1, // extensions
+		32, // zeros
+	};
+
+	sha_256_buffered_context_t ctx;
+	sha_256_buffered_init(&ctx);
+
+	size_t offset = 0;
+	ITERATE(appendSize, appendSizes) {
+		ASSERT(offset + *appendSize <= dataSize);
+		sha_256_buffered_append(&ctx, data + offset, *appendSize);
+		offset += *appendSize;
+	}
+	EXPECT_EQ(offset, 207);
+
+	uint8_t result[SHA_256_SIZE];
+	sha_256_buffered_finalize(&ctx, result, SIZEOF(result));
+
+	// one syscall per append without buffering
+	EXPECT_EQ(ctx.appendCount, ARRAY_LEN(appendSizes));
+	// three full blocks and the final one
+	EXPECT_EQ(ctx.syscallCount, 4);
+}
+
+void run_hash_test()
+{
+	PRINTF("Running hash tests\n");
+
+	uint8_t data[300];
+	for (size_t i = 0; i < SIZEOF(data); i++) {
+		data[i] = (uint8_t) (i * 7 + 3);
+	}
+
+	const size_t ones[] = {1};
+	const size_t mixed[] = {1, 2, 4, 8, 32, 3};
+	const size_t large[] = {5, 130};
+
+	testcase_bufferedHash(data, 0, ones, ARRAY_LEN(ones));
+	testcase_bufferedHash(data, 63, ones, ARRAY_LEN(ones));
+	testcase_bufferedHash(data, 64, ones, ARRAY_LEN(ones));
+	testcase_bufferedHash(data, 200, ones, ARRAY_LEN(ones));
+	testcase_bufferedHash(data, 200, mixed, ARRAY_LEN(mixed));
+	testcase_bufferedHash(data, SIZEOF(data), large, ARRAY_LEN(large));
+
+	testTransferSyscalls(data, SIZEOF(data));
+}
+
+#endif // DEVEL
@@ -1,5 +1,6 @@
 #include "io.h"
 #include "common.h"
+#include "profiler.h"
 
 io_state_t io_state;
 
@@ -36,6 +37,43 @@ void nanos_set_timer(int ms, timeout_callback_fn_t* cb)
 #define HANDLE_UX_TICKER_EVENT(ux_allowed) do {} while(0)
 #endif
 
+static uint32_t ticker_count;
+
+uint32_t io_get_ticker_count()
+{
+	return ticker_count;
+}
+
+static background_task_fn_t* background_task;
+static bool background_task_cleared;
+
+void io_set_background_task(background_task_fn_t* task)
+{
+	ASSERT(background_task == NULL);
+	background_task = task;
+}
+
+void io_clear_background_task()
+{
+	background_task = NULL;
+	background_task_cleared = true;
+}
+
+static void run_background_task_slice()
+{
+	background_task_fn_t* task = background_task;
+	if (task == NULL) return;
+
+	// the task may process nested events (heartbeats during key derivation),
+	// so it is detached while running to prevent reentrancy
+	background_task = NULL;
+	background_task_cleared = false;
+	bool done = task();
+	if (!done && !background_task_cleared) {
+		background_task = task;
+	}
+}
+
 void CHECK_RESPONSE_SIZE(unsigned int tx)
 {
 	// Note(ppershing): we do both checks due to potential overflows
@@ -52,7 +90,9 @@ void _io_send_G_io_apdu_buffer(uint16_t code, uint16_t tx)
 	CHECK_RESPONSE_SIZE(tx);
 	G_io_apdu_buffer[tx++] = code >> 8;
 	G_io_apdu_buffer[tx++] = code & 0xFF;
+	PROFILE_BEGIN(PROFILE_PHASE_IO_SEND);
 	io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
+	PROFILE_END(PROFILE_PHASE_IO_SEND, 0);
 
 	// From now on we can receive new APDU
 	io_state = IO_EXPECT_IO;
@@ -105,6 +145,8 @@ unsigned char io_event(unsigned char channel MARK_UNUSED)
 		break;
 
 	case SEPROXYHAL_TAG_TICKER_EVENT:
+		ticker_count++;
+		run_background_task_slice();
 		UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {
 			TRACE("timer");
 			HANDLE_UX_TICKER_EVENT(UX_ALLOWED);
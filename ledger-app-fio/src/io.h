@@ -48,4 +48,17 @@ void nanos_clear_timer();
 // does not actually work anymore in Nano X
 #endif
 
+// Number of ticker events since the app started, a coarse clock
+// (the device has no real time clock). Ticker events come every 100 ms.
+#define TICKER_INTERVAL_MS 100
+uint32_t io_get_ticker_count();
+
+// Work done in slices on ticker events while the user reviews the screens,
+// independent of the timer above so that it works on both devices.
+// The task returns true when it has finished, it is then cleared.
+// The task must not throw.
+typedef bool background_task_fn_t();
+void io_set_background_task(background_task_fn_t* task);
+void io_clear_background_task();
+
 #endif // H_FIO_APP_IO
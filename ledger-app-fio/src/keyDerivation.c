@@ -9,16 +9,18 @@
 #include "endian.h"
 #include "fio.h"
 #include "securityPolicy.h"
+#include "pubkeyCache.h"
+#include "profiler.h"
 
 #define PRIVATE_KEY_SEED_LEN 32
 
-void derivePrivateKey(
+// chainCode is optional
+static void deriveNode(
         const bip44_path_t* pathSpec,
-        private_key_t* privateKey
+        private_key_t* privateKey,
+        chain_code_t* chainCode
 )
 {
-	ENSURE_NOT_DENIED(policyDerivePrivateKey(pathSpec));
-
 	// Sanity check
 	ASSERT(pathSpec->length < ARRAY_LEN(pathSpec->path));
 
@@ -29,14 +31,16 @@ void derivePrivateKey(
 		TRY {
 			STATIC_ASSERT(CX_APILEVEL >= 5, "unsupported api level");
 
+			PROFILE_BEGIN(PROFILE_PHASE_DERIVE);
 			io_seproxyhal_io_heartbeat();
 			os_perso_derive_node_bip32(
 			        CX_CURVE_SECP256K1,
 			        pathSpec->path,
 			        pathSpec->length,
 			        privateKeySeed,
-			        NULL);
+			        (chainCode == NULL) ? NULL : chainCode->code);
 			io_seproxyhal_io_heartbeat();
+			PROFILE_END(PROFILE_PHASE_DERIVE, 0);
 
 			cx_ecfp_init_private_key(CX_CURVE_SECP256K1, privateKeySeed, 32, privateKey);
 		}
@@ -46,7 +50,54 @@ void derivePrivateKey(
 	} END_TRY;
 }
 
-void derivePublicKey(
+static void generatePublicKey(
+        private_key_t* privateKey,
+        public_key_t* publicKey
+)
+{
+	// We should do cx_ecfp_generate_pair here, but it does not work in SDK < 1.5.4,
+	// should work with the new SDK
+	PROFILE_BEGIN(PROFILE_PHASE_DERIVE);
+	io_seproxyhal_io_heartbeat();
+	cx_ecfp_init_public_key(CX_CURVE_SECP256K1, NULL, 0, publicKey);
+	cx_ecfp_generate_pair(CX_CURVE_SECP256K1, publicKey, privateKey, 1); //1 - private key preserved
+	io_seproxyhal_io_heartbeat();
+	PROFILE_END(PROFILE_PHASE_DERIVE, 0);
+}
+
+void derivePrivateKey(
+        const bip44_path_t* pathSpec,
+        private_key_t* privateKey
+)
+{
+	ENSURE_NOT_DENIED(policyDerivePrivateKey(pathSpec));
+
+	deriveNode(pathSpec, privateKey, NULL);
+}
+
+void deriveKeyPair(
+        const bip44_path_t* pathSpec,
+        private_key_t* privateKey,
+        public_key_t* publicKey
+)
+{
+	derivePrivateKey(pathSpec, privateKey);
+	derivePublicKeyFromPrivateKey(pathSpec, privateKey, publicKey);
+}
+
+void derivePublicKeyFromPrivateKey(
+        const bip44_path_t* pathSpec,
+        private_key_t* privateKey,
+        public_key_t* publicKey
+)
+{
+	if (pubkeyCache_get(pathSpec, publicKey)) return;
+
+	generatePublicKey(privateKey, publicKey);
+	pubkeyCache_put(pathSpec, publicKey);
+}
+
+void derivePublicKeyUncached(
         const bip44_path_t* pathSpec,
         public_key_t * publicKey
 )
@@ -55,15 +106,57 @@ void derivePublicKey(
 	BEGIN_TRY {
 		TRY {
 			derivePrivateKey(pathSpec, &privateKey);
-			// We should do cx_ecfp_generate_pair here, but it does not work in SDK < 1.5.4,
-			// should work with the new SDK
-			io_seproxyhal_io_heartbeat();
-			cx_ecfp_init_public_key(CX_CURVE_SECP256K1, NULL, 0, publicKey);
-			cx_ecfp_generate_pair(CX_CURVE_SECP256K1, publicKey, &privateKey, 1); //1 - private key preserved
-			io_seproxyhal_io_heartbeat();
+			generatePublicKey(&privateKey, publicKey);
+		}
+		FINALLY {
+			explicit_bzero(&privateKey, SIZEOF(privateKey));
+		}
+	} END_TRY;
+}
+
+void derivePublicKey(
+        const bip44_path_t* pathSpec,
+        public_key_t * publicKey
+)
+{
+	// the cache only contains keys which passed the policy, but let us not rely on it
+	ENSURE_NOT_DENIED(policyDerivePrivateKey(pathSpec));
+
+	if (pubkeyCache_get(pathSpec, publicKey)) return;
+
+	derivePublicKeyUncached(pathSpec, publicKey);
+	pubkeyCache_put(pathSpec, publicKey);
+}
+
+void deriveExtendedPublicKey(
+        const bip44_path_t* pathSpec,
+        extended_public_key_t* out
+)
+{
+	ENSURE_NOT_DENIED(policyDeriveExtendedPublicKey(pathSpec));
+
+	private_key_t privateKey;
+	BEGIN_TRY {
+		TRY {
+			deriveNode(pathSpec, &privateKey, &out->chainCode);
+			generatePublicKey(&privateKey, &out->pubKey);
 		}
 		FINALLY {
 			explicit_bzero(&privateKey, SIZEOF(privateKey));
 		}
 	} END_TRY;
 }
+
+void extractCompressedPublicKey(
+        const public_key_t* publicKey,
+        uint8_t* outBuffer, size_t outSize
+)
+{
+	ASSERT(outSize == COMPRESSED_PUBLIC_KEY_SIZE);
+	ASSERT(publicKey->W_len == SIZEOF(publicKey->W));
+	// uncompressed key is 0x04 || x || y
+	ASSERT(publicKey->W[0] == 0x04);
+
+	outBuffer[0] = (publicKey->W[64] & 0x01) ? 0x03 : 0x02;
+	memmove(outBuffer + 1, publicKey->W + 1, PUBLIC_KEY_SIZE);
+}
@@ -8,6 +8,7 @@
 
 #define PUBLIC_KEY_SIZE      (32)
 #define CHAIN_CODE_SIZE      (32)
+#define COMPRESSED_PUBLIC_KEY_SIZE (1 + PUBLIC_KEY_SIZE)
 
 typedef cx_ecfp_private_key_t private_key_t;
 typedef cx_ecfp_public_key_t public_key_t;
@@ -16,6 +17,11 @@ typedef struct {
 	uint8_t code[CHAIN_CODE_SIZE];
 } chain_code_t;
 
+typedef struct {
+	public_key_t pubKey;
+	chain_code_t chainCode;
+} extended_public_key_t;
+
 void derivePrivateKey(
         const bip44_path_t* pathSpec,
         private_key_t* privateKey // output
@@ -27,6 +33,40 @@ void derivePublicKey(
         public_key_t* out
 );
 
+// Same as derivePublicKey() but bypasses the public key cache, e.g. for bulk export
+void derivePublicKeyUncached(
+        const bip44_path_t* pathSpec,
+        public_key_t* out
+);
+
+// Derives both keys with a single BIP32 derivation.
+// Caller is responsible for wiping privateKey, also in case of an exception.
+void deriveKeyPair(
+        const bip44_path_t* pathSpec,
+        private_key_t* privateKey, // output
+        public_key_t* publicKey // output
+);
+
+// Second half of deriveKeyPair(), privateKey must be derived from pathSpec.
+// Allows the two expensive steps to be run separately.
+void derivePublicKeyFromPrivateKey(
+        const bip44_path_t* pathSpec,
+        private_key_t* privateKey,
+        public_key_t* publicKey // output
+);
+
+// public key and chain code of the account node (44'/235'/0')
+void deriveExtendedPublicKey(
+        const bip44_path_t* pathSpec,
+        extended_public_key_t* out
+);
+
+// SEC1 compressed form, i.e. parity prefix (0x02/0x03) followed by x coordinate
+void extractCompressedPublicKey(
+        const public_key_t* publicKey,
+        uint8_t* outBuffer, size_t outSize
+);
+
 
 #ifdef DEVEL
 void run_key_derivation_test();
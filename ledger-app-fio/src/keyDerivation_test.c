@@ -120,6 +120,113 @@ void testPublicKeyDerivation()
 #undef TESTCASE
 }
 
+void testKeyPairDerivation()
+{
+	PRINTF("testKeyPairDerivation\n");
+
+	uint32_t path[] = { HD + 44, HD + 235, HD + 0, 0, 0 };
+	bip44_path_t pathSpec;
+	pathSpec_init(&pathSpec, path, ARRAY_LEN(path));
+
+	private_key_t privateKey;
+	public_key_t publicKey;
+	deriveKeyPair(&pathSpec, &privateKey, &publicKey);
+
+	uint8_t expectedPrivateKey[32];
+	decode_hex(
+	        "4d597899db76e87933e7c6841c2d661810f070bad20487ef20eb84e182695a3a",
+	        expectedPrivateKey, SIZEOF(expectedPrivateKey)
+	);
+	EXPECT_EQ_BYTES(expectedPrivateKey, privateKey.d, SIZEOF(expectedPrivateKey));
+	explicit_bzero(&privateKey, SIZEOF(privateKey));
+
+	public_key_t expectedPublicKey;
+	derivePublicKey(&pathSpec, &expectedPublicKey);
+	EXPECT_EQ_BYTES(expectedPublicKey.W, publicKey.W, SIZEOF(publicKey.W));
+}
+
+void testcase_compressPublicKey(uint32_t* path, uint32_t pathLen, const char* expectedHex)
+{
+	PRINTF("testcase_compressPublicKey ");
+
+	bip44_path_t pathSpec;
+	pathSpec_init(&pathSpec, path, pathLen);
+	bip44_PRINTF(&pathSpec);
+	PRINTF("\n");
+
+	public_key_t publicKey;
+	derivePublicKey(&pathSpec, &publicKey);
+
+	uint8_t compressed[COMPRESSED_PUBLIC_KEY_SIZE];
+	extractCompressedPublicKey(&publicKey, compressed, SIZEOF(compressed));
+	TRACE_BUFFER(compressed, SIZEOF(compressed));
+
+	uint8_t expected[COMPRESSED_PUBLIC_KEY_SIZE];
+	decode_hex(expectedHex, expected, SIZEOF(expected));
+
+	EXPECT_EQ_BYTES(expected, compressed, SIZEOF(expected));
+}
+
+void testPublicKeyCompression()
+{
+#define TESTCASE(path_, expectedHex_) \
+	{ \
+		uint32_t path[] = { UNWRAP path_ }; \
+		testcase_compressPublicKey(path, ARRAY_LEN(path), expectedHex_); \
+	}
+
+	// odd y coordinate
+	TESTCASE(
+	        (HD + 44, HD + 235, HD + 0, 0, 0),
+	        "03a9a222bc3b1a5a58ada17d10069b3961ebd0f917d4b2106031a061915ca9cc24"
+	)
+
+	// even y coordinate
+	TESTCASE(
+	        (HD + 44, HD + 235, HD + 0, 0, 2000),
+	        "0284e52dfea57b8f1787488a356374cd8e8515b8ad8db3dd4f9088d8e42ed2fb6d"
+	);
+
+#undef TESTCASE
+}
+
+void testExtendedPublicKeyDerivation()
+{
+	PRINTF("testExtendedPublicKeyDerivation\n");
+
+	uint32_t path[] = { HD + 44, HD + 235, HD + 0 };
+	bip44_path_t pathSpec;
+	pathSpec_init(&pathSpec, path, ARRAY_LEN(path));
+
+	extended_public_key_t extPubKey;
+	deriveExtendedPublicKey(&pathSpec, &extPubKey);
+	TRACE_BUFFER(extPubKey.pubKey.W, SIZEOF(extPubKey.pubKey.W));
+	TRACE_BUFFER(extPubKey.chainCode.code, SIZEOF(extPubKey.chainCode.code));
+
+	uint8_t expectedPubKey[65];
+	decode_hex(
+	        "0474d88195367ea0c4415faf0988dfdce8250abe4ce29368dc378ddfd6f116544c1b5e08cce8edba905eb6809810b7bcef80075103fc2fba447fa01f5da6d90869",
+	        expectedPubKey, SIZEOF(expectedPubKey)
+	);
+	EXPECT_EQ_BYTES(expectedPubKey, extPubKey.pubKey.W, SIZEOF(expectedPubKey));
+
+	uint8_t expectedChainCode[CHAIN_CODE_SIZE];
+	decode_hex(
+	        "73938768a3f36543ad7657e4ddc66377d5d5de797241651a33d346325e200573",
+	        expectedChainCode, SIZEOF(expectedChainCode)
+	);
+	EXPECT_EQ_BYTES(expectedChainCode, extPubKey.chainCode.code, SIZEOF(expectedChainCode));
+
+	// only the account node may be exported
+	uint32_t addressPath[] = { HD + 44, HD + 235, HD + 0, 0, 0 };
+	pathSpec_init(&pathSpec, addressPath, ARRAY_LEN(addressPath));
+	EXPECT_THROWS(deriveExtendedPublicKey(&pathSpec, &extPubKey), ERR_REJECTED_BY_POLICY);
+
+	uint32_t otherAccountPath[] = { HD + 44, HD + 235, HD + 1 };
+	pathSpec_init(&pathSpec, otherAccountPath, ARRAY_LEN(otherAccountPath));
+	EXPECT_THROWS(deriveExtendedPublicKey(&pathSpec, &extPubKey), ERR_REJECTED_BY_POLICY);
+}
+
 void run_key_derivation_test()
 {
 	PRINTF("Running key derivation tests\n");
@@ -127,6 +234,9 @@ void run_key_derivation_test()
 	PRINTF("12-word mnemonic: 11*abandon about\n");
 	testPrivateKeyDerivation();
 	testPublicKeyDerivation();
+	testKeyPairDerivation();
+	testPublicKeyCompression();
+	testExtendedPublicKeyDerivation();
 }
 
 #endif // DEVEL
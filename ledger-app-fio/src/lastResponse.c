@@ -0,0 +1,119 @@
+#include "common.h"
+#include "handlers.h"
+
+#include "lastResponse.h"
+#include "state.h"
+#include "uiHelpers.h"
+#include "endian.h"
+
+enum {
+	P1_STATUS = 0x01,
+	P1_FETCH = 0x02,
+};
+
+static struct {
+	// zero until the first call which needs it
+	uint32_t nonce;
+	// number of responses stored since the app started
+	uint32_t sequence;
+	uint8_t ins;
+	size_t size;
+	uint8_t data[LAST_RESPONSE_MAX_SIZE];
+} lastResponse;
+
+static void ensureNonce()
+{
+	while (lastResponse.nonce == 0) {
+		lastResponse.nonce = cx_rng_u32();
+	}
+}
+
+void lastResponse_save(const uint8_t* buffer, size_t bufferSize)
+{
+	ASSERT(bufferSize <= SIZEOF(lastResponse.data));
+
+	ensureNonce();
+	lastResponse.sequence++;
+	lastResponse.ins = (uint8_t) currentInstruction;
+	lastResponse.size = bufferSize;
+	memmove(lastResponse.data, buffer, bufferSize);
+}
+
+typedef struct {
+	uint8_t nonce[4];
+	uint8_t sequence[4];
+	uint8_t ins;
+} last_response_header_t;
+
+STATIC_ASSERT(sizeof(last_response_header_t) == LAST_RESPONSE_STATUS_SIZE, "wrong status size");
+
+static void writeHeader(last_response_header_t* header)
+{
+	u4be_write(header->nonce, lastResponse.nonce);
+	u4be_write(header->sequence, lastResponse.sequence);
+	header->ins = lastResponse.ins;
+}
+
+void lastResponse_writeStatus(uint8_t* buffer, size_t bufferSize)
+{
+	ASSERT(bufferSize == SIZEOF(last_response_header_t));
+
+	ensureNonce();
+	writeHeader((last_response_header_t*) buffer);
+}
+
+static void handleStatus(uint8_t* wireDataBuffer MARK_UNUSED, size_t wireDataSize)
+{
+	VALIDATE(wireDataSize == 0, ERR_INVALID_REQUEST_PARAMETERS);
+
+	last_response_header_t response;
+	writeHeader(&response);
+
+	io_send_buf(SUCCESS, (uint8_t*) &response, SIZEOF(response));
+}
+
+static void handleFetch(uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	struct {
+		uint8_t nonce[4];
+		uint8_t sequence[4];
+	}* wireData = (void*) wireDataBuffer;
+
+	VALIDATE(wireDataSize == SIZEOF(*wireData), ERR_INVALID_DATA);
+
+	// only the response the host asks for, a different one must not be mistaken for it
+	VALIDATE(lastResponse.sequence > 0, ERR_INVALID_STATE);
+	VALIDATE(u4be_read(wireData->nonce) == lastResponse.nonce, ERR_INVALID_STATE);
+	VALIDATE(u4be_read(wireData->sequence) == lastResponse.sequence, ERR_INVALID_STATE);
+
+	STATIC_ASSERT(SIZEOF(last_response_header_t) + LAST_RESPONSE_MAX_SIZE <= SIZEOF(G_io_apdu_buffer) - 2, "response too long");
+	last_response_header_t* header = (void*) G_io_apdu_buffer;
+	writeHeader(header);
+	memmove(G_io_apdu_buffer + SIZEOF(*header), lastResponse.data, lastResponse.size);
+
+	io_send_buf(SUCCESS, G_io_apdu_buffer, SIZEOF(*header) + lastResponse.size);
+}
+
+void lastResponse_handleAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t *wireDataBuffer,
+        size_t wireDataSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	ensureNonce();
+
+	switch (p1) {
+	case P1_STATUS:
+		handleStatus(wireDataBuffer, wireDataSize);
+		break;
+	case P1_FETCH:
+		handleFetch(wireDataBuffer, wireDataSize);
+		break;
+	default:
+		THROW(ERR_INVALID_REQUEST_PARAMETERS);
+	}
+	ui_idle();
+}
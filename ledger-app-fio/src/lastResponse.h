@@ -0,0 +1,27 @@
+#ifndef H_FIO_APP_LAST_RESPONSE
+#define H_FIO_APP_LAST_RESPONSE
+
+#include "common.h"
+#include "handlers.h"
+
+// The last completed response of an instruction which needed the user
+// (a signature or a displayed public key) is kept so that the host can
+// fetch it again if the link drops before the host reads it.
+// Responses are tagged with a nonce, random for each run of the app,
+// and a sequence number, so that the host can tell that the stored
+// response is the one it missed (see doc/ins_get_last_response.md).
+// It holds public data only and lives outside of instructionState.
+#define LAST_RESPONSE_MAX_SIZE 128
+
+// nonce, sequence and INS, as returned by the status subcall
+#define LAST_RESPONSE_STATUS_SIZE 9
+
+// stores the response of the current instruction, call right before sending it
+void lastResponse_save(const uint8_t* buffer, size_t bufferSize);
+
+// writes the status, so that a call can return it instead of the host asking for it
+void lastResponse_writeStatus(uint8_t* buffer, size_t bufferSize);
+
+handler_fn_t lastResponse_handleAPDU;
+
+#endif // H_FIO_APP_LAST_RESPONSE
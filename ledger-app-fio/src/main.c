@@ -32,6 +32,9 @@
 #include "menu.h"
 #include "assert.h"
 #include "io.h"
+#include "pubkeyCache.h"
+#include "earlyWitness.h"
+#include "stackUsage.h"
 
 // The whole app is designed for a specific api level.
 // In case there is an api change, first *verify* changes
@@ -46,6 +49,8 @@ static const int INS_NONE = -1;
 void ui_idle(void)
 {
 	currentInstruction = INS_NONE;
+	io_clear_background_task();
+	earlyWitness_wipe();
 	// The first argument is the starting index within menu_main, and the last
 	// argument is a preprocessor; I've never seen an app that uses either
 	// argument.
@@ -96,6 +101,11 @@ static void fio_main(void)
 				rx = (unsigned int) io_exchange((uint8_t) (CHANNEL_APDU | flags), (uint16_t) rx);
 				flags = 0;
 
+				#ifdef DEVEL
+				// the previous instruction is done, including its UI steps
+				stackUsage_update();
+				#endif // DEVEL
+
 				// We should be awaiting APDU
 				ASSERT(io_state == IO_EXPECT_IO);
 				io_state = IO_EXPECT_NONE;
@@ -146,6 +156,10 @@ static void fio_main(void)
 					VALIDATE(header->ins == currentInstruction, ERR_STILL_IN_CALL);
 				}
 
+				#ifdef DEVEL
+				stackUsage_setInstruction(header->ins);
+				#endif // DEVEL
+
 				// Note: handlerFn is responsible for calling io_send
 				// either during its call or subsequent UI actions
 				handlerFn(header->p1,
@@ -198,6 +212,8 @@ static void fio_main(void)
 
 static void app_exit(void)
 {
+	pubkeyCache_clear();
+
 	BEGIN_TRY_L(exit) {
 		TRY_L(exit) {
 			os_sched_exit(-1);
@@ -235,6 +251,9 @@ __attribute__((section(".boot"))) int main(void)
 				#endif
 
 				io_state = IO_EXPECT_IO;
+				#ifdef DEVEL
+				stackUsage_init();
+				#endif // DEVEL
 				fio_main();
 			}
 			CATCH(EXCEPTION_IO_RESET)
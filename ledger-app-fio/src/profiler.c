@@ -0,0 +1,91 @@
+#ifdef PROFILING
+
+#include "profiler.h"
+#include "endian.h"
+#include "io.h"
+#include "state.h"
+#include "uiHelpers.h"
+
+// Survives between instructions, only reset on request
+static struct {
+	profile_record_t records[PROFILER_BUFFER_SIZE];
+	// index of the next record to write
+	uint8_t next;
+	// including the overwritten ones
+	uint32_t totalRecorded;
+} profiler;
+
+void profiler_record(profile_phase_t phase, bool isEnd, uint8_t value)
+{
+	ASSERT(profiler.next < PROFILER_BUFFER_SIZE);
+
+	profile_record_t* record = &profiler.records[profiler.next];
+	// INS_NONE (-1) becomes 0xFF, e.g. for responses sent after the instruction
+	record->ins = (uint8_t) currentInstruction;
+	record->phase = (uint8_t) phase | (isEnd ? PROFILE_PHASE_END_FLAG : 0);
+	record->value = value;
+	u4be_write(record->ticker, io_get_ticker_count());
+
+	profiler.next = (profiler.next + 1) % PROFILER_BUFFER_SIZE;
+	profiler.totalRecorded++;
+}
+
+void profiler_reset()
+{
+	explicit_bzero(&profiler, SIZEOF(profiler));
+}
+
+size_t profiler_getRecords(profile_record_t* records, size_t maxRecords, uint32_t* totalRecorded)
+{
+	size_t count = PROFILER_BUFFER_SIZE;
+	if (profiler.totalRecorded < count) count = profiler.totalRecorded;
+	if (maxRecords < count) count = maxRecords;
+
+	// the oldest kept record follows the newest one once the buffer wrapped
+	size_t start = (profiler.next + PROFILER_BUFFER_SIZE - count) % PROFILER_BUFFER_SIZE;
+	for (size_t i = 0; i < count; i++) {
+		records[i] = profiler.records[(start + i) % PROFILER_BUFFER_SIZE];
+	}
+	*totalRecorded = profiler.totalRecorded;
+	return count;
+}
+
+enum {
+	P1_PROFILE_READ = 0x00,
+	P1_PROFILE_READ_AND_RESET = 0x01,
+};
+
+void profiler_handleGetProfileAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t *wireDataBuffer MARK_UNUSED,
+        size_t wireDataSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p1 == P1_PROFILE_READ || p1 == P1_PROFILE_READ_AND_RESET, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_REQUEST_PARAMETERS);
+
+	struct {
+		uint8_t totalRecorded[4];
+		uint8_t count;
+		profile_record_t records[PROFILER_BUFFER_SIZE];
+	} response;
+	STATIC_ASSERT(SIZEOF(response) + 2 <= 255, "response does not fit a single APDU");
+
+	uint32_t totalRecorded;
+	size_t count = profiler_getRecords(response.records, ARRAY_LEN(response.records), &totalRecorded);
+	u4be_write(response.totalRecorded, totalRecorded);
+	response.count = (uint8_t) count;
+
+	if (p1 == P1_PROFILE_READ_AND_RESET) {
+		// before the response so that sending it is the first record
+		profiler_reset();
+	}
+
+	io_send_buf(SUCCESS, (uint8_t*) &response, 4 + 1 + count * SIZEOF(profile_record_t));
+	ui_idle();
+}
+
+#endif // PROFILING
@@ -0,0 +1,64 @@
+#ifndef H_FIO_APP_PROFILER
+#define H_FIO_APP_PROFILER
+
+#include "common.h"
+#include "handlers.h"
+
+// Records the beginning and end of the phases of the handlers in a ring buffer,
+// read by INS 0xF4. Compiled in only with PROFILING, the macros below are no-ops otherwise.
+//
+// Timestamps are ticker counts (see io.h), the only clock available to the app.
+// It advances between APDUs, so it measures the phases waiting for the user,
+// phases within an APDU are reported in order with their values.
+
+typedef enum {
+	PROFILE_PHASE_PARSE = 0x01,
+	PROFILE_PHASE_HASH = 0x02,
+	PROFILE_PHASE_POLICY = 0x03,
+	PROFILE_PHASE_DERIVE = 0x04,
+	// value at the end is the number of signing attempts (check_canonical retries + 1)
+	PROFILE_PHASE_SIGN = 0x05,
+	// value at the end is 1 if confirmed, 0 if rejected
+	PROFILE_PHASE_UI = 0x06,
+	PROFILE_PHASE_IO_SEND = 0x07,
+} profile_phase_t;
+
+// set in the phase byte of the records of phase ends
+#define PROFILE_PHASE_END_FLAG 0x80
+
+// fits a single response with the header
+#define PROFILER_BUFFER_SIZE 32
+
+// wire format of a record
+typedef struct {
+	uint8_t ins;
+	uint8_t phase;
+	uint8_t value;
+	uint8_t ticker[4];
+} profile_record_t;
+
+#ifdef PROFILING
+
+void profiler_record(profile_phase_t phase, bool isEnd, uint8_t value);
+void profiler_reset();
+
+// fills records with the buffered records, oldest first, returns their count
+size_t profiler_getRecords(profile_record_t* records, size_t maxRecords, uint32_t* totalRecorded);
+
+handler_fn_t profiler_handleGetProfileAPDU;
+
+#ifdef DEVEL
+void run_profiler_test();
+#endif // DEVEL
+
+#define PROFILE_BEGIN(phase) profiler_record(phase, false, 0)
+#define PROFILE_END(phase, value) profiler_record(phase, true, value)
+
+#else
+
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase, value)
+
+#endif // PROFILING
+
+#endif // H_FIO_APP_PROFILER
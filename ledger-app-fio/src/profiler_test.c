@@ -0,0 +1,66 @@
+#if defined(DEVEL) && defined(PROFILING)
+
+#include "profiler.h"
+#include "state.h"
+#include "testUtils.h"
+#include "utils.h"
+
+static void testRecords()
+{
+	PRINTF("profiler testRecords\n");
+
+	profiler_reset();
+	int ins = currentInstruction;
+	currentInstruction = 0x20;
+	profiler_record(PROFILE_PHASE_SIGN, false, 0);
+	profiler_record(PROFILE_PHASE_SIGN, true, 2);
+	currentInstruction = ins;
+
+	profile_record_t records[PROFILER_BUFFER_SIZE];
+	uint32_t totalRecorded;
+	EXPECT_EQ(profiler_getRecords(records, ARRAY_LEN(records), &totalRecorded), 2);
+	EXPECT_EQ(totalRecorded, 2);
+
+	EXPECT_EQ(records[0].ins, 0x20);
+	EXPECT_EQ(records[0].phase, PROFILE_PHASE_SIGN);
+	EXPECT_EQ(records[0].value, 0);
+	EXPECT_EQ(records[1].phase, (PROFILE_PHASE_SIGN | PROFILE_PHASE_END_FLAG));
+	EXPECT_EQ(records[1].value, 2);
+}
+
+static void testWrapAround()
+{
+	PRINTF("profiler testWrapAround\n");
+
+	profiler_reset();
+	const size_t numRecords = PROFILER_BUFFER_SIZE + 5;
+	for (size_t i = 0; i < numRecords; i++) {
+		profiler_record(PROFILE_PHASE_PARSE, true, (uint8_t) i);
+	}
+
+	profile_record_t records[PROFILER_BUFFER_SIZE];
+	uint32_t totalRecorded;
+	// the oldest ones were overwritten, the rest comes oldest first
+	EXPECT_EQ(profiler_getRecords(records, ARRAY_LEN(records), &totalRecorded), PROFILER_BUFFER_SIZE);
+	EXPECT_EQ(totalRecorded, numRecords);
+	for (size_t i = 0; i < PROFILER_BUFFER_SIZE; i++) {
+		EXPECT_EQ(records[i].value, i + 5);
+	}
+
+	// only the newest ones fit
+	EXPECT_EQ(profiler_getRecords(records, 3, &totalRecorded), 3);
+	EXPECT_EQ(records[0].value, numRecords - 3);
+	EXPECT_EQ(records[2].value, numRecords - 1);
+
+	profiler_reset();
+	EXPECT_EQ(profiler_getRecords(records, ARRAY_LEN(records), &totalRecorded), 0);
+	EXPECT_EQ(totalRecorded, 0);
+}
+
+void run_profiler_test()
+{
+	testRecords();
+	testWrapAround();
+}
+
+#endif // DEVEL && PROFILING
@@ -0,0 +1,144 @@
+#include "pubkeyCache.h"
+#include "endian.h"
+#include "uiHelpers.h"
+#include "utils.h"
+
+typedef struct {
+	bip44_path_t pathSpec;
+	uint8_t compressedKey[COMPRESSED_PUBLIC_KEY_SIZE];
+	bool valid;
+	// for LRU eviction, higher is more recent
+	uint32_t lastUse;
+} pubkey_cache_entry_t;
+
+typedef struct {
+	uint32_t hits;
+	uint32_t misses;
+} pubkey_cache_stats_t;
+
+typedef struct {
+	pubkey_cache_entry_t entries[PUBKEY_CACHE_SIZE];
+	uint32_t useCounter;
+	pubkey_cache_stats_t stats;
+} pubkey_cache_t;
+
+static pubkey_cache_t cache;
+
+// keep it small, it competes with instructionState_t for RAM
+STATIC_ASSERT(sizeof(pubkey_cache_t) <= 400, "pubkey cache too big");
+
+// secp256k1 field prime
+static const uint8_t FIELD_P[32] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xfe, 0xff, 0xff, 0xfc, 0x2f
+};
+
+// (p + 1) / 4, p = 3 mod 4 so this exponent gives a square root
+static const uint8_t FIELD_SQRT_EXP[32] = {
+	0x3f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xbf, 0xff, 0xff, 0x0c
+};
+
+// y^2 = x^3 + 7
+static void decompressPublicKey(const uint8_t* compressedKey, public_key_t* publicKey)
+{
+	ASSERT(compressedKey[0] == 0x02 || compressedKey[0] == 0x03);
+
+	const uint8_t* x = compressedKey + 1;
+	uint8_t seven[32];
+	explicit_bzero(seven, SIZEOF(seven));
+	seven[31] = 7;
+
+	uint8_t y[32];
+	cx_math_multm(y, x, x, FIELD_P, SIZEOF(y));
+	cx_math_multm(y, y, x, FIELD_P, SIZEOF(y));
+	cx_math_addm(y, y, seven, FIELD_P, SIZEOF(y));
+	cx_math_powm(y, y, FIELD_SQRT_EXP, SIZEOF(FIELD_SQRT_EXP), FIELD_P, SIZEOF(y));
+
+	if ((y[31] & 0x01) != (compressedKey[0] & 0x01)) {
+		cx_math_sub(y, FIELD_P, y, SIZEOF(y));
+	}
+
+	cx_ecfp_init_public_key(CX_CURVE_SECP256K1, NULL, 0, publicKey);
+	publicKey->W_len = SIZEOF(publicKey->W);
+	publicKey->W[0] = 0x04;
+	memmove(publicKey->W + 1, x, 32);
+	memmove(publicKey->W + 1 + 32, y, 32);
+}
+
+bool pubkeyCache_get(const bip44_path_t* pathSpec, public_key_t* publicKey)
+{
+	for (size_t i = 0; i < ARRAY_LEN(cache.entries); i++) {
+		pubkey_cache_entry_t* entry = &cache.entries[i];
+		if (entry->valid && bip44_isEqual(&entry->pathSpec, pathSpec)) {
+			entry->lastUse = ++cache.useCounter;
+			cache.stats.hits++;
+			decompressPublicKey(entry->compressedKey, publicKey);
+			return true;
+		}
+	}
+	cache.stats.misses++;
+	return false;
+}
+
+void pubkeyCache_put(const bip44_path_t* pathSpec, const public_key_t* publicKey)
+{
+	pubkey_cache_entry_t* victim = &cache.entries[0];
+	for (size_t i = 0; i < ARRAY_LEN(cache.entries); i++) {
+		pubkey_cache_entry_t* entry = &cache.entries[i];
+		if (entry->valid && bip44_isEqual(&entry->pathSpec, pathSpec)) {
+			// already there
+			victim = entry;
+			break;
+		}
+		if (!entry->valid) {
+			victim = entry;
+			continue;
+		}
+		if (victim->valid && entry->lastUse < victim->lastUse) {
+			victim = entry;
+		}
+	}
+
+	victim->pathSpec = *pathSpec;
+	extractCompressedPublicKey(publicKey, victim->compressedKey, SIZEOF(victim->compressedKey));
+	victim->valid = true;
+	victim->lastUse = ++cache.useCounter;
+}
+
+void pubkeyCache_clear()
+{
+	explicit_bzero(&cache, SIZEOF(cache));
+}
+
+#ifdef DEVEL
+
+void pubkeyCache_handleGetStatsAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t *wireDataBuffer MARK_UNUSED,
+        size_t wireDataSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p1 == P1_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_REQUEST_PARAMETERS);
+
+	struct {
+		uint8_t hits[4];
+		uint8_t misses[4];
+	} response;
+
+	u4be_write(response.hits, cache.stats.hits);
+	u4be_write(response.misses, cache.stats.misses);
+
+	io_send_buf(SUCCESS, (uint8_t*) &response, SIZEOF(response));
+	ui_idle();
+}
+
+#endif // DEVEL
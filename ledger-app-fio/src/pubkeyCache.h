@@ -0,0 +1,25 @@
+#ifndef H_FIO_APP_PUBKEY_CACHE
+#define H_FIO_APP_PUBKEY_CACHE
+
+#include "common.h"
+#include "handlers.h"
+#include "bip44.h"
+#include "keyDerivation.h"
+
+// Small LRU cache of path -> compressed public key.
+// It holds public data only and lives outside of instructionState
+// so that it survives between instructions.
+#define PUBKEY_CACHE_SIZE 4
+
+// returns true and fills publicKey (uncompressed) on hit
+bool pubkeyCache_get(const bip44_path_t* pathSpec, public_key_t* publicKey);
+void pubkeyCache_put(const bip44_path_t* pathSpec, const public_key_t* publicKey);
+void pubkeyCache_clear();
+
+#ifdef DEVEL
+handler_fn_t pubkeyCache_handleGetStatsAPDU;
+
+void run_pubkeyCache_test();
+#endif // DEVEL
+
+#endif // H_FIO_APP_PUBKEY_CACHE
@@ -0,0 +1,76 @@
+#ifdef DEVEL
+
+#include "pubkeyCache.h"
+#include "testUtils.h"
+#include "utils.h"
+
+static void pathSpec_init(bip44_path_t* pathSpec, uint32_t address)
+{
+	const uint32_t path[] = { HARDENED_BIP32 + 44, HARDENED_BIP32 + 235, HARDENED_BIP32 + 0, 0, address };
+	pathSpec->length = ARRAY_LEN(path);
+	memmove(pathSpec->path, path, SIZEOF(path));
+}
+
+static void testRoundTrip()
+{
+	PRINTF("pubkeyCache testRoundTrip\n");
+
+	bip44_path_t pathSpec;
+	public_key_t derived, cached;
+
+	// both parities of y
+	const uint32_t addresses[] = {0, 2000};
+	ITERATE(it, addresses) {
+		pathSpec_init(&pathSpec, *it);
+		derivePublicKeyUncached(&pathSpec, &derived);
+
+		EXPECT_EQ(pubkeyCache_get(&pathSpec, &cached), false);
+		pubkeyCache_put(&pathSpec, &derived);
+		EXPECT_EQ(pubkeyCache_get(&pathSpec, &cached), true);
+		EXPECT_EQ(cached.W_len, derived.W_len);
+		EXPECT_EQ_BYTES(derived.W, cached.W, SIZEOF(derived.W));
+	}
+}
+
+static void testEviction()
+{
+	PRINTF("pubkeyCache testEviction\n");
+
+	bip44_path_t pathSpec;
+	public_key_t publicKey;
+
+	pathSpec_init(&pathSpec, 0);
+	derivePublicKeyUncached(&pathSpec, &publicKey);
+
+	// the key does not matter here, only the paths
+	for (uint32_t i = 0; i < PUBKEY_CACHE_SIZE; i++) {
+		pathSpec_init(&pathSpec, i);
+		pubkeyCache_put(&pathSpec, &publicKey);
+	}
+
+	// touch address 0 so that address 1 is the least recently used
+	pathSpec_init(&pathSpec, 0);
+	EXPECT_EQ(pubkeyCache_get(&pathSpec, &publicKey), true);
+
+	pathSpec_init(&pathSpec, PUBKEY_CACHE_SIZE);
+	pubkeyCache_put(&pathSpec, &publicKey);
+
+	pathSpec_init(&pathSpec, 1);
+	EXPECT_EQ(pubkeyCache_get(&pathSpec, &publicKey), false);
+	pathSpec_init(&pathSpec, 0);
+	EXPECT_EQ(pubkeyCache_get(&pathSpec, &publicKey), true);
+	pathSpec_init(&pathSpec, PUBKEY_CACHE_SIZE);
+	EXPECT_EQ(pubkeyCache_get(&pathSpec, &publicKey), true);
+}
+
+void run_pubkeyCache_test()
+{
+	pubkeyCache_clear();
+	testRoundTrip();
+	pubkeyCache_clear();
+	testEviction();
+	// do not leave test data behind
+	pubkeyCache_clear();
+}
+
+#endif // DEVEL
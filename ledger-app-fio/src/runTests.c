@@ -7,18 +7,17 @@
 #include "bip44.h"
 #include "endian.h"
 #include "keyDerivation.h"
+#include "earlyWitness.h"
+#include "eos_utils.h"
+#include "profiler.h"
+#include "pubkeyCache.h"
 #include "textUtils.h"
+#include "txParser.h"
 #include "uiHelpers.h"
 #include "uiScreens.h"
 
 
-void handleRunTests(
-        uint8_t p1 MARK_UNUSED,
-        uint8_t p2 MARK_UNUSED,
-        uint8_t *wireBuffer MARK_UNUSED,
-        size_t wireSize MARK_UNUSED,
-        bool isNewCall MARK_UNUSED
-)
+void runTests()
 {
 	// Note: Make sure to have RESET_ON_CRASH flag disabled
 	// as it interferes with tests verifying assertions
@@ -26,11 +25,30 @@ void handleRunTests(
 		PRINTF("Running tests\n");
 		run_hex_test();
 		run_endian_test();
+		run_hash_test();
 		run_textUtils_test();
 		run_bip44_test();
+		run_eos_utils_test();
 		run_key_derivation_test();
+		run_earlyWitness_test();
+		run_pubkeyCache_test();
+		run_txParser_test();
+		#ifdef PROFILING
+		run_profiler_test();
+		#endif // PROFILING
 		PRINTF("All tests done\n");
 	} END_ASSERT_NOEXCEPT;
+}
+
+void handleRunTests(
+        uint8_t p1 MARK_UNUSED,
+        uint8_t p2 MARK_UNUSED,
+        uint8_t *wireBuffer MARK_UNUSED,
+        size_t wireSize MARK_UNUSED,
+        bool isNewCall MARK_UNUSED
+)
+{
+	runTests();
 
 	io_send_buf(SUCCESS, NULL, 0);
 	ui_idle();
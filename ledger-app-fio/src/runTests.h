@@ -5,6 +5,10 @@
 
 #include "handlers.h"
 
+// Runs all the test suites, throws ERR_ASSERT on the first failure.
+// Shared by the device (INS 0xF0) and the host build (see host/).
+void runTests();
+
 handler_fn_t handleRunTests;
 
 #endif // H_CARDANO_APP_RUN_TESTS
@@ -36,6 +36,28 @@ security_policy_t policyForGetPublicKey(const bip44_path_t* pathSpec, get_key_p1
 	ALLOW();
 }
 
+// the same rules as for a single key, applied to the whole range
+security_policy_t policyForGetPublicKeysBatch(const bip44_path_t* firstPathSpec, uint32_t numKeys)
+{
+	DENY_UNLESS(bip44_hasValidFIOPrefix(firstPathSpec));
+	DENY_UNLESS(bip44_containsAddress(firstPathSpec));
+	DENY_IF(bip44_containsMoreThanAddress(firstPathSpec));
+	DENY_IF(numKeys == 0 || numKeys > MAX_PUBLIC_KEYS);
+	// the last address must not be hardened, so the address index cannot overflow either
+	DENY_IF(bip44_getAddressValue(firstPathSpec) > HARDENED_BIP32 - numKeys);
+	WARN_UNLESS(bip44_hasReasonableAddressRange(firstPathSpec, numKeys));
+
+	ALLOW();
+}
+
+// the account key reveals all addresses of the account, so the user always has to confirm
+security_policy_t policyForGetAccountPublicKey(const bip44_path_t* pathSpec)
+{
+	DENY_UNLESS(bip44_isFIOAccountPath(pathSpec));
+
+	PROMPT();
+}
+
 security_policy_t policyForSignTxInit(network_type_t network)
 {
 	DENY_IF(network == NETWORK_UNKNOWN);
@@ -73,6 +95,68 @@ security_policy_t policyForSignTxWitness(const bip44_path_t* pathSpec)
 	PROMPT();
 }
 
+security_policy_t policyForSigningSessionInit(
+        network_type_t network, const bip44_path_t* pathSpec,
+        uint64_t spendingCap, uint32_t lifetimeSeconds
+)
+{
+	DENY_IF(network == NETWORK_UNKNOWN);
+	DENY_UNLESS(policyForSignTxWitness(pathSpec) == POLICY_PROMPT_BEFORE_RESPONSE);
+	DENY_IF(spendingCap == 0);
+	DENY_IF(lifetimeSeconds == 0 || lifetimeSeconds > SIGNING_SESSION_MAX_LIFETIME_SECONDS);
+
+	PROMPT();
+}
+
+security_policy_t policyForSigningSessionPayee()
+{
+	SHOW();
+}
+
+security_policy_t policyForSigningSessionConfirm()
+{
+	PROMPT();
+}
+
+security_policy_t policyForSignTxInSession(const signing_session_t* session, network_type_t network)
+{
+	DENY_IF(network != session->network);
+
+	ALLOW();
+}
+
+security_policy_t policyForSignTxActionInSession(
+        const signing_session_t* session, action_type_t action,
+        char* validation_actor, char* data_actor,
+        const char* payee, uint64_t maxFee
+)
+{
+	// the session might have expired between two chunks
+	DENY_IF(session == NULL);
+	DENY_IF(action != ACTION_TYPE_TRNSFIOPUBKY);
+	DENY_IF(policyForSignTxActionData(validation_actor, data_actor) == POLICY_DENY);
+	DENY_UNLESS(signingSession_isPayeeAllowed(session, payee));
+	DENY_IF(maxFee > session->maxFee);
+
+	ALLOW();
+}
+
+security_policy_t policyForSignTxWitnessInSession(
+        const signing_session_t* session, const bip44_path_t* pathSpec,
+        uint64_t totalAmount, uint64_t totalMaxFee
+)
+{
+	// the session might have expired while the tx was streamed
+	DENY_IF(session == NULL);
+	DENY_UNLESS(bip44_isEqual(pathSpec, &session->wittnessPath));
+	DENY_IF(totalMaxFee > session->maxFee);
+	// max fees are charged as well, they are the most the tx can cost
+	DENY_IF(totalAmount + totalMaxFee < totalAmount);
+	DENY_IF(totalAmount + totalMaxFee > session->remainingBudget);
+
+	ALLOW();
+}
+
 security_policy_t policyDerivePrivateKey(const bip44_path_t* pathSpec)
 {
 	DENY_UNLESS(bip44_hasValidFIOPrefix(pathSpec));
@@ -82,6 +166,13 @@ security_policy_t policyDerivePrivateKey(const bip44_path_t* pathSpec)
 	ALLOW();
 }
 
+security_policy_t policyDeriveExtendedPublicKey(const bip44_path_t* pathSpec)
+{
+	DENY_UNLESS(bip44_isFIOAccountPath(pathSpec));
+
+	ALLOW();
+}
+
 
 
 
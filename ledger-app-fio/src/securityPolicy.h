@@ -3,6 +3,7 @@
 
 #include "bip44.h"
 #include "getPublicKey.h"
+#include "signingSession.h"
 
 typedef enum {
 	POLICY_DENY = 1,
@@ -13,6 +14,8 @@ typedef enum {
 } security_policy_t;
 
 security_policy_t policyForGetPublicKey(const bip44_path_t* pathSpec, get_key_p1_t show_or_not);
+security_policy_t policyForGetPublicKeysBatch(const bip44_path_t* firstPathSpec, uint32_t numKeys);
+security_policy_t policyForGetAccountPublicKey(const bip44_path_t* pathSpec);
 
 security_policy_t policyForSignTxInit(network_type_t network);
 security_policy_t policyForSignTxHeader();
@@ -21,7 +24,27 @@ security_policy_t policyForSignTxActionAuthorization();
 security_policy_t policyForSignTxActionData(char * validation_actor, char* data_actor);
 security_policy_t policyForSignTxWitness(const bip44_path_t* pathSpec);
 
+security_policy_t policyForSigningSessionInit(
+        network_type_t network, const bip44_path_t* pathSpec,
+        uint64_t spendingCap, uint32_t lifetimeSeconds
+);
+security_policy_t policyForSigningSessionPayee();
+security_policy_t policyForSigningSessionConfirm();
+
+// transactions signed within a session
+security_policy_t policyForSignTxInSession(const signing_session_t* session, network_type_t network);
+security_policy_t policyForSignTxActionInSession(
+        const signing_session_t* session, action_type_t action,
+        char* validation_actor, char* data_actor,
+        const char* payee, uint64_t maxFee
+);
+security_policy_t policyForSignTxWitnessInSession(
+        const signing_session_t* session, const bip44_path_t* pathSpec,
+        uint64_t totalAmount, uint64_t totalMaxFee
+);
+
 security_policy_t policyDerivePrivateKey(const bip44_path_t* pathSpec);
+security_policy_t policyDeriveExtendedPublicKey(const bip44_path_t* pathSpec);
 
 static inline void ENSURE_NOT_DENIED(security_policy_t policy)
 {
@@ -6,10 +6,14 @@
 #include "hash.h"
 #include "endian.h"
 #include "eos_utils.h"
+#include "earlyWitness.h"
 #include "securityPolicy.h"
 #include "uiHelpers.h"
 #include "uiScreens.h"
 #include "textUtils.h"
+#include "signingSession.h"
+#include "lastResponse.h"
+#include "profiler.h"
 
 static ins_sign_transaction_context_t* ctx = &(instructionState.signTransactionContext);
 
@@ -21,6 +25,7 @@ typedef enum {
 	SIGN_STAGE_ACTION_AUTHORIZATION = 26,
 	SIGN_STAGE_ACTION_DATA = 27,
 	SIGN_STAGE_WITNESS = 28,
+	SIGN_STAGE_RAW_TX = 29,
 } sign_tx_stage_t;
 
 // this is supposed to be called at the beginning of each APDU handler
@@ -37,7 +42,7 @@ static inline void advanceStage()
 	switch (ctx->stage) {
 
 	case SIGN_STAGE_INIT:
-		ctx->stage = SIGN_STAGE_HEADER;
+		ctx->stage = ctx->rawMode ? SIGN_STAGE_RAW_TX : SIGN_STAGE_HEADER;
 		break;
 
 	case SIGN_STAGE_HEADER:
@@ -53,6 +58,10 @@ static inline void advanceStage()
 		break;
 
 	case SIGN_STAGE_ACTION_DATA:
+		ctx->stage = (ctx->numActionsProcessed < ctx->numActions) ? SIGN_STAGE_ACTION_HEADER : SIGN_STAGE_WITNESS;
+		break;
+
+	case SIGN_STAGE_RAW_TX:
 		ctx->stage = SIGN_STAGE_WITNESS;
 		break;
 
@@ -78,6 +87,21 @@ void respondSuccessEmptyMsg()
 	ui_displayBusy(); // needs to happen after I/O
 }
 
+// to be called once the data of an action is parsed
+static void addActionToTotals(uint64_t amount, uint64_t maxFee)
+{
+	VALIDATE(ctx->numActionsProcessed < ctx->numActions, ERR_INVALID_STATE);
+
+	// overflow checks
+	VALIDATE(ctx->totalAmount + amount >= ctx->totalAmount, ERR_INVALID_DATA);
+	VALIDATE(ctx->totalMaxFee + maxFee >= ctx->totalMaxFee, ERR_INVALID_DATA);
+
+	ctx->totalAmount += amount;
+	ctx->totalMaxFee += maxFee;
+	ctx->numActionsProcessed++;
+	TRACE("Processed %d of %d actions", ctx->numActionsProcessed, ctx->numActions);
+}
+
 //Taken from EOS app. Needed to produce signatures.
 uint8_t const SECP256K1_N[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
                                0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
@@ -85,6 +109,35 @@ uint8_t const SECP256K1_N[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
                                0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41
                               };
 
+// ============================== EARLY WITNESS ==============================
+
+enum {
+	// the witness path follows the chain id in INIT,
+	// the key is derived in the background while the user reviews the tx
+	P2_EARLY_WITNESS = 0x01,
+};
+
+// starts the derivation for ctx->wittnessPath
+static void signTx_startEarlyWitness()
+{
+	// the policy is checked again with the witness,
+	// no key is derived for a path which is going to be rejected anyway
+	ENSURE_NOT_DENIED(policyForSignTxWitness(&ctx->wittnessPath));
+
+	earlyWitness_start(&ctx->wittnessPath, ctx->wittnessPathPubkeyWif, SIZEOF(ctx->wittnessPathPubkeyWif));
+	ctx->earlyWitness = true;
+}
+
+// returns the size of the path parsed from the INIT data
+static size_t signTx_parseEarlyWitness(const uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	explicit_bzero(&ctx->wittnessPath, SIZEOF(ctx->wittnessPath));
+	size_t parsedSize = bip44_parseFromWire(&ctx->wittnessPath, wireDataBuffer, wireDataSize);
+
+	signTx_startEarlyWitness();
+	return parsedSize;
+}
+
 // ============================== INIT ==============================
 enum {
 	HANDLE_INIT_STEP_DISPLAY_DETAILS = 100,
@@ -127,7 +180,7 @@ void signTx_handleInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataS
 		// sanity checks
 		CHECK_STAGE(SIGN_STAGE_INIT);
 
-		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		VALIDATE(p2 == P2_UNUSED || p2 == P2_EARLY_WITNESS, ERR_INVALID_REQUEST_PARAMETERS);
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
 
@@ -139,16 +192,25 @@ void signTx_handleInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataS
 			uint8_t chainId[32];
 		}* wireData = (void*) wireDataBuffer;
 
-		VALIDATE(SIZEOF(*wireData) == wireDataSize, ERR_INVALID_DATA);
+		VALIDATE(SIZEOF(*wireData) <= wireDataSize, ERR_INVALID_DATA);
+		size_t parsedSize = SIZEOF(*wireData);
+		if (p2 == P2_EARLY_WITNESS) {
+			parsedSize += signTx_parseEarlyWitness(
+			                      wireDataBuffer + parsedSize, wireDataSize - parsedSize
+			              );
+		}
+		VALIDATE(parsedSize == wireDataSize, ERR_INVALID_DATA);
 
 		TRACE("SHA_256_init");
-		sha_256_init(&ctx->hashContext);
-		sha_256_append(&ctx->hashContext, wireData->chainId, SIZEOF(wireData->chainId));
+		sha_256_buffered_init(&ctx->hashContext);
+		sha_256_buffered_append(&ctx->hashContext, wireData->chainId, SIZEOF(wireData->chainId));
 
 		ctx->network = getNetworkByChainId(wireData->chainId, SIZEOF(wireData->chainId));
 		TRACE("Network %d:", ctx->network);
 	}
 
+	// signing sessions cover only the raw and template modes,
+	// this one is confirmed as usual even if a session is active
 	security_policy_t policy = policyForSignTxInit(ctx->network);
 	TRACE("Policy: %d", (int) policy);
 	ENSURE_NOT_DENIED(policy);
@@ -237,20 +299,28 @@ void signTx_handleHeaderAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDat
 			uint8_t refBlockPrefix[4];
 		}* wireData = (void*) wireDataBuffer;
 
-		VALIDATE(SIZEOF(*wireData) == wireDataSize, ERR_INVALID_DATA);
+		// the number of actions is optional, defaults to one action
+		VALIDATE(SIZEOF(*wireData) == wireDataSize || SIZEOF(*wireData) + 1 == wireDataSize, ERR_INVALID_DATA);
+		ctx->numActions = (wireDataSize > SIZEOF(*wireData)) ? wireDataBuffer[SIZEOF(*wireData)] : 1;
+		VALIDATE(ctx->numActions >= 1 && ctx->numActions <= MAX_TX_ACTIONS, ERR_INVALID_DATA);
+		TRACE("Number of actions %d", ctx->numActions);
 
 		ctx->expiration = u4be_read(wireData->expiration);
-		sha_256_append(&ctx->hashContext, (uint8_t *)&ctx->expiration, sizeof(ctx->expiration));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *)&ctx->expiration, sizeof(ctx->expiration));
 
 		ctx->refBlockNum = u2be_read(wireData->refBlockNum);
-		sha_256_append(&ctx->hashContext, (uint8_t *)&ctx->refBlockNum, SIZEOF(wireData->refBlockNum));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *)&ctx->refBlockNum, SIZEOF(wireData->refBlockNum));
 
 		ctx->refBlockPrefix = u4be_read(wireData->refBlockPrefix);
-		sha_256_append(&ctx->hashContext, (uint8_t *)&ctx->refBlockPrefix, sizeof(ctx->expiration));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *)&ctx->refBlockPrefix, sizeof(ctx->expiration));
 
 		uint8_t buf[4]; //max_net_usage_words, max_cpu_usage_ms, delay_sec, context_free_actions
 		explicit_bzero(buf, sizeof(buf)); //SIZEOF does no work for 4
-		sha_256_append(&ctx->hashContext, buf, sizeof(buf));
+		sha_256_buffered_append(&ctx->hashContext, buf, sizeof(buf));
+
+		//number of actions, varuint32 fits into a single byte
+		STATIC_ASSERT(MAX_TX_ACTIONS <= MAX_SINGLE_BYTE_LENGTH, "number of actions must fit into a single byte");
+		sha_256_buffered_append(&ctx->hashContext, &ctx->numActions, SIZEOF(ctx->numActions));
 	}
 
 	security_policy_t policy = policyForSignTxHeader();
@@ -326,10 +396,7 @@ void signTx_handleActionHeaderAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t w
 
 		VALIDATE(SIZEOF(*wireData) == wireDataSize, ERR_INVALID_DATA);
 
-		uint8_t buf[1];
-		buf[0] = 1;
-		sha_256_append(&ctx->hashContext, buf, SIZEOF(buf)); //one action
-		sha_256_append(&ctx->hashContext, (uint8_t *) wireData, SIZEOF(*wireData));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *) wireData, SIZEOF(*wireData));
 
 		ctx->action_type = getActionTypeByContractAccountName(ctx->network, wireData->contractAccountName,
 		                   CONTRACT_ACCOUNT_NAME_LENGTH);
@@ -419,9 +486,9 @@ void signTx_handleActionAuthorizationAPDU(uint8_t p2, uint8_t* wireDataBuffer, s
 
 		uint8_t buf[1];
 		buf[0] = 1;
-		sha_256_append(&ctx->hashContext, buf, SIZEOF(buf)); //one authorization
-		sha_256_append(&ctx->hashContext, wireData->actor, SIZEOF(wireData->actor));
-		sha_256_append(&ctx->hashContext, wireData->permission, SIZEOF(wireData->permission));
+		sha_256_buffered_append(&ctx->hashContext, buf, SIZEOF(buf)); //one authorization
+		sha_256_buffered_append(&ctx->hashContext, wireData->actor, SIZEOF(wireData->actor));
+		sha_256_buffered_append(&ctx->hashContext, wireData->permission, SIZEOF(wireData->permission));
 
 		uint8array_name_to_string(wireData->actor, NAME_VAR_LENGTH, ctx->actionValidationActor, NAME_STRING_MAX_LENGTH);
 		uint8array_name_to_string(wireData->permission, NAME_VAR_LENGTH, ctx->actionValidationPermission, NAME_STRING_MAX_LENGTH);
@@ -503,6 +570,28 @@ static void signTx_handleActionData_ui_runStep()
 	UI_STEP_END(HANDLE_ACTION_DATA_STEP_INVALID);
 }
 
+// common for both ways of sending action data
+static void signTx_handleParsedActionData()
+{
+	security_policy_t policy = policyForSignTxActionData(ctx->actionValidationActor, ctx->actionDataActor);
+	TRACE("Policy: %d", (int) policy);
+	ENSURE_NOT_DENIED(policy);
+
+	addActionToTotals(ctx->amount, ctx->maxFee);
+	{
+		// select UI steps
+		switch (policy) {
+#	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
+			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_ACTION_DATA_STEP_SHOW_PUBKEY);
+#	undef   CASE
+		default:
+			THROW(ERR_NOT_IMPLEMENTED);
+		}
+	}
+
+	signTx_handleActionData_ui_runStep();
+}
+
 __noinline_due_to_stack__
 void signTx_handleActionDataAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
 {
@@ -513,6 +602,8 @@ void signTx_handleActionDataAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wir
 
 		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+		// cannot be mixed with streamed action data
+		VALIDATE(!ctx->actionDataStreamStarted, ERR_INVALID_STATE);
 	}
 
 	{
@@ -553,38 +644,500 @@ void signTx_handleActionDataAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wir
 		ctx -> tpid = (char *) wireData2->tpid;
 
 
-		sha_256_append(&ctx->hashContext, (uint8_t *) wireData1->dataLength, SIZEOF(wireData1->dataLength));
-		sha_256_append(&ctx->hashContext, (uint8_t *) wireData1->pubkeyLength, SIZEOF(wireData1->pubkeyLength));
-		sha_256_append(&ctx->hashContext, (uint8_t *) wireData1->pubkey, wireData1->pubkeyLength[0]);
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *) wireData1->dataLength, SIZEOF(wireData1->dataLength));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *) wireData1->pubkeyLength, SIZEOF(wireData1->pubkeyLength));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *) wireData1->pubkey, wireData1->pubkeyLength[0]);
 
-		sha_256_append(&ctx->hashContext, (uint8_t *) &ctx->amount, SIZEOF(ctx->amount));
-		sha_256_append(&ctx->hashContext, (uint8_t *) &ctx->maxFee, SIZEOF(ctx->maxFee));
-		sha_256_append(&ctx->hashContext, (uint8_t *) wireData2->actor, SIZEOF(wireData2->actor));
-		sha_256_append(&ctx->hashContext, (uint8_t *) wireData2->tpidLength, SIZEOF(wireData2->tpidLength));
-		sha_256_append(&ctx->hashContext, (uint8_t *) wireData2->tpid, wireData2->tpidLength[0]);
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *) &ctx->amount, SIZEOF(ctx->amount));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *) &ctx->maxFee, SIZEOF(ctx->maxFee));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *) wireData2->actor, SIZEOF(wireData2->actor));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *) wireData2->tpidLength, SIZEOF(wireData2->tpidLength));
+		sha_256_buffered_append(&ctx->hashContext, (uint8_t *) wireData2->tpid, wireData2->tpidLength[0]);
 	}
 
-	security_policy_t policy = policyForSignTxActionData(ctx->actionValidationActor, ctx->actionDataActor);
-	TRACE("Policy: %d", (int) policy);
-	ENSURE_NOT_DENIED(policy);
+	signTx_handleParsedActionData();
+}
+
+// Canonical action data (varuint32 length and the data), split into as many APDUs as needed.
+// The chunks are hashed as they come and only the displayed fields are kept.
+__noinline_due_to_stack__
+void signTx_handleActionDataChunkAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
 	{
-		// select UI steps
-		switch (policy) {
-#	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
-			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_ACTION_DATA_STEP_SHOW_PUBKEY);
+		// sanity checks
+		CHECK_STAGE(SIGN_STAGE_ACTION_DATA);
+
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+		VALIDATE(wireDataSize > 0, ERR_INVALID_DATA);
+	}
+
+	if (!ctx->actionDataStreamStarted) {
+		txParser_initActionData(&ctx->txParser, ctx->network, ctx->action_type);
+		ctx->actionDataStreamStarted = true;
+	}
+
+	{
+		// parse data
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		sha_256_buffered_append(&ctx->hashContext, wireDataBuffer, wireDataSize);
+
+		// the chunk must not continue past the end of action data
+		PROFILE_BEGIN(PROFILE_PHASE_PARSE);
+		size_t parsedSize = txParser_process(&ctx->txParser, wireDataBuffer, wireDataSize);
+		PROFILE_END(PROFILE_PHASE_PARSE, 0);
+		VALIDATE(parsedSize == wireDataSize, ERR_INVALID_DATA);
+	}
+
+	if (!txParser_isDone(&ctx->txParser)) {
+		respondSuccessEmptyMsg();
+		return;
+	}
+
+	ctx->actionDataStreamStarted = false;
+	{
+		tx_parser_output_t* actionData = &ctx->txParser.output;
+		ctx->pubkey = actionData->pubkey;
+		ctx->amount = actionData->amount;
+		ctx->maxFee = actionData->maxFee;
+		STATIC_ASSERT(SIZEOF(ctx->actionDataActor) == SIZEOF(actionData->actionDataActor), "actor buffers differ");
+		memcpy(ctx->actionDataActor, actionData->actionDataActor, SIZEOF(ctx->actionDataActor));
+		ctx->tpid = NULL; // validated, but not kept
+	}
+
+	signTx_handleParsedActionData();
+}
+
+// ============================== RAW TRANSACTION ==============================
+
+// The whole packed_trx is streamed, chunks are hashed as they are and only
+// the fields needed for policy and UI are extracted by txParser.
+// Parsing pauses after each action to show it, the rest of the chunk
+// is parsed once the user goes through the action screens.
+
+enum {
+	HANDLE_RAW_TX_STEP_SHOW_CHAIN = 500,
+	HANDLE_RAW_TX_STEP_PARSE,
+	HANDLE_RAW_TX_STEP_SHOW_ACTION,
+	HANDLE_RAW_TX_STEP_SHOW_PUBKEY,
+	HANDLE_RAW_TX_STEP_SHOW_AMOUNT,
+	HANDLE_RAW_TX_STEP_SHOW_MAX_FEE,
+	HANDLE_RAW_TX_STEP_NEXT_ACTION,
+	HANDLE_RAW_TX_STEP_INVALID,
+};
+
+enum {
+	// the user confirms a raw or template transaction even while a signing session is active,
+	// the host falls back to it for transactions the session does not cover
+	P2_OUTSIDE_SESSION = 0x02,
+};
+
+// while a signing session is active, raw and template transactions are signed within it
+static void signTx_initSession(uint8_t p2)
+{
+	if (p2 & P2_OUTSIDE_SESSION) return;
+
+	const signing_session_t* session = signingSession_get();
+	if (session == NULL) return;
+
+	security_policy_t policy = policyForSignTxInSession(session, ctx->network);
+	TRACE("Session policy: %d", (int) policy);
+	ENSURE_NOT_DENIED(policy);
+	ctx->inSession = true;
+}
+
+// Parses the rest of the current chunk until its end or until an action is complete.
+// Returns true if there is an action to be shown.
+static bool signTx_parseRawTxChunk()
+{
+	PROFILE_BEGIN(PROFILE_PHASE_PARSE);
+	size_t consumed = txParser_process(&ctx->txParser, ctx->rawChunk, ctx->rawChunkSize);
+	PROFILE_END(PROFILE_PHASE_PARSE, 0);
+	ctx->rawChunk += consumed;
+	ctx->rawChunkSize -= consumed;
+
+	if (txParser_isActionComplete(&ctx->txParser)) {
+		tx_parser_output_t* tx = &ctx->txParser.output;
+		ctx->numActions = tx->numActions;
+
+		if (ctx->inSession) {
+			// nothing is shown
+			security_policy_t policy = policyForSignTxActionInSession(
+			                                   signingSession_get(), tx->actionType,
+			                                   tx->actionValidationActor, tx->actionDataActor,
+			                                   tx->pubkey, tx->maxFee
+			                           );
+			TRACE("Session policy: %d", (int) policy);
+			ENSURE_NOT_DENIED(policy);
+			VALIDATE(policy == POLICY_ALLOW_WITHOUT_PROMPT, ERR_NOT_IMPLEMENTED);
+		} else {
+			// the same policies as in the field-by-field mode, all of them end up shown
+			const security_policy_t policies[] = {
+				policyForSignTxActionHeader(tx->actionType),
+				policyForSignTxActionAuthorization(),
+				policyForSignTxActionData(tx->actionValidationActor, tx->actionDataActor),
+			};
+			ITERATE(policy, policies) {
+				TRACE("Policy: %d", (int) *policy);
+				ENSURE_NOT_DENIED(*policy);
+				VALIDATE(*policy == POLICY_SHOW_BEFORE_RESPONSE, ERR_NOT_IMPLEMENTED);
+			}
+		}
+
+		addActionToTotals(tx->amount, tx->maxFee);
+		return true;
+	}
+
+	ASSERT(ctx->rawChunkSize == 0);
+	if (ctx->rawBytesRemaining == 0) {
+		VALIDATE(txParser_isDone(&ctx->txParser), ERR_INVALID_DATA);
+	}
+	return false;
+}
+
+// saves the host a separate call to be able to recover the witness
+static void signTx_respondLastResponseStatus()
+{
+	uint8_t status[LAST_RESPONSE_STATUS_SIZE];
+	lastResponse_writeStatus(status, SIZEOF(status));
+	io_send_buf(SUCCESS, status, SIZEOF(status));
+	ui_displayBusy(); // needs to happen after I/O
+}
+
+static void signTx_handleRawTx_ui_runStep()
+{
+	TRACE("UI step %d", ctx->ui_step);
+	TRACE_STACK_USAGE();
+	ui_callback_fn_t* this_fn = signTx_handleRawTx_ui_runStep;
+	const tx_parser_output_t* tx = &ctx->txParser.output;
+
+	UI_STEP_BEGIN(ctx->ui_step, this_fn);
+
+	UI_STEP(HANDLE_RAW_TX_STEP_SHOW_CHAIN) {
+		if (ctx->inSession) {
+			UI_STEP_JUMP(HANDLE_RAW_TX_STEP_PARSE);
+		}
+		switch(ctx->network) {
+#	define  CASE(NETWORK, CHAIN_STRING) case NETWORK: {ui_displayPaginatedText("Chain", CHAIN_STRING, this_fn); break;}
+			CASE(NETWORK_MAINNET, "Mainnet");
+			CASE(NETWORK_TESTNET, "Testnet");
 #	undef   CASE
 		default:
 			THROW(ERR_NOT_IMPLEMENTED);
 		}
 	}
 
-	signTx_handleActionData_ui_runStep();
+	UI_STEP(HANDLE_RAW_TX_STEP_PARSE) {
+		bool actionParsed = signTx_parseRawTxChunk();
+		// actions within a signing session are not shown
+		while (actionParsed && ctx->inSession) {
+			actionParsed = signTx_parseRawTxChunk();
+		}
+		if (actionParsed) {
+			UI_STEP_JUMP(HANDLE_RAW_TX_STEP_SHOW_ACTION);
+		}
+		// the whole chunk is parsed
+		if (ctx->rawRespondWithStatus) {
+			ctx->rawRespondWithStatus = false;
+			signTx_respondLastResponseStatus();
+		} else {
+			respondSuccessEmptyMsg();
+		}
+		if (ctx->rawBytesRemaining == 0) {
+			advanceStage();
+		}
+	}
+
+	UI_STEP(HANDLE_RAW_TX_STEP_SHOW_ACTION) {
+		switch(tx->actionType) {
+#	define  CASE(ACTION, STRING) case ACTION: {ui_displayPaginatedText("Action", STRING, this_fn); break;}
+			CASE(ACTION_TYPE_TRNSFIOPUBKY, "Transfer FIO tokens");
+#	undef   CASE
+		default:
+			THROW(ERR_NOT_IMPLEMENTED);
+		}
+	}
+
+	UI_STEP(HANDLE_RAW_TX_STEP_SHOW_PUBKEY) {
+		ui_displayPaginatedText(
+		        "Payee Pubkey",
+		        tx->pubkey,
+		        this_fn
+		);
+	}
+
+	UI_STEP(HANDLE_RAW_TX_STEP_SHOW_AMOUNT) {
+		ui_displayFIOAmountScreen(
+		        "Amount",
+		        tx->amount,
+		        this_fn
+		);
+	}
+
+	UI_STEP(HANDLE_RAW_TX_STEP_SHOW_MAX_FEE) {
+		ui_displayFIOAmountScreen(
+		        "Max fee",
+		        tx->maxFee,
+		        this_fn
+		);
+	}
+
+	UI_STEP(HANDLE_RAW_TX_STEP_NEXT_ACTION) {
+		UI_STEP_JUMP(HANDLE_RAW_TX_STEP_PARSE);
+	}
+
+	UI_STEP_END(HANDLE_RAW_TX_STEP_INVALID);
+}
+
+static void signTx_startRawTxChunk(const uint8_t* chunk, size_t chunkSize)
+{
+	VALIDATE(chunkSize <= ctx->rawBytesRemaining, ERR_INVALID_DATA);
+
+	sha_256_buffered_append(&ctx->hashContext, chunk, chunkSize);
+	ctx->rawBytesRemaining -= chunkSize;
+
+	ctx->rawChunk = chunk;
+	ctx->rawChunkSize = chunkSize;
+}
+
+__noinline_due_to_stack__
+void signTx_handleRawInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
+	{
+		// sanity checks
+		CHECK_STAGE(SIGN_STAGE_INIT);
+
+		VALIDATE((p2 & ~(P2_EARLY_WITNESS | P2_OUTSIDE_SESSION)) == 0, ERR_INVALID_REQUEST_PARAMETERS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+	}
+
+	struct {
+		uint8_t chainId[32];
+	}* wireData = (void*) wireDataBuffer;
+	size_t parsedSize = 0;
+
+	{
+		// parse data
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		VALIDATE(SIZEOF(*wireData) <= wireDataSize, ERR_INVALID_DATA);
+		parsedSize += SIZEOF(*wireData);
+
+		TRACE("SHA_256_init");
+		sha_256_buffered_init(&ctx->hashContext);
+		sha_256_buffered_append(&ctx->hashContext, wireData->chainId, SIZEOF(wireData->chainId));
+
+		ctx->network = getNetworkByChainId(wireData->chainId, SIZEOF(wireData->chainId));
+		TRACE("Network %d:", ctx->network);
+
+		if (p2 & P2_EARLY_WITNESS) {
+			parsedSize += signTx_parseEarlyWitness(
+			                      wireDataBuffer + parsedSize, wireDataSize - parsedSize
+			              );
+		}
+
+		VALIDATE(parsedSize + 2 <= wireDataSize, ERR_INVALID_DATA);
+		ctx->rawBytesRemaining = u2be_read(wireDataBuffer + parsedSize);
+		parsedSize += 2;
+		VALIDATE(ctx->rawBytesRemaining > 0, ERR_INVALID_DATA);
+	}
+
+	ENSURE_NOT_DENIED(policyForSignTxInit(ctx->network));
+	ENSURE_NOT_DENIED(policyForSignTxHeader());
+	signTx_initSession(p2);
+
+	txParser_init(&ctx->txParser, ctx->network);
+	ctx->rawMode = true;
+	ctx->rawRespondWithStatus = true;
+	advanceStage();
+
+	signTx_startRawTxChunk(wireDataBuffer + parsedSize, wireDataSize - parsedSize);
+
+	ctx->ui_step = HANDLE_RAW_TX_STEP_SHOW_CHAIN;
+	signTx_handleRawTx_ui_runStep();
+}
+
+__noinline_due_to_stack__
+void signTx_handleRawChunkAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
+	{
+		// sanity checks
+		CHECK_STAGE(SIGN_STAGE_RAW_TX);
+
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+		VALIDATE(wireDataSize > 0, ERR_INVALID_DATA);
+	}
+
+	TRACE_BUFFER(wireDataBuffer, wireDataSize);
+	signTx_startRawTxChunk(wireDataBuffer, wireDataSize);
+
+	ctx->ui_step = HANDLE_RAW_TX_STEP_PARSE;
+	signTx_handleRawTx_ui_runStep();
+}
+
+// ============================== TEMPLATE ==============================
+
+// Repeated transfers share the chain, the action and its authorization,
+// the host declares them once and then sends only the variable parts of packed_trx.
+// The template survives across calls (until the app exits).
+static struct {
+	bool isValid;
+	network_type_t network;
+	// the hashed data start with it
+	uint8_t chainId[CHAIN_ID_LENGTH];
+	uint8_t contractAccountName[CONTRACT_ACCOUNT_NAME_LENGTH];
+	uint8_t actor[NAME_VAR_LENGTH];
+	uint8_t permission[NAME_VAR_LENGTH];
+	bip44_path_t wittnessPath;
+} signTxTemplate;
+
+// expiration, ref block num and ref block prefix as in packed_trx
+#define TEMPLATE_TX_HEADER_LENGTH 10
+
+__noinline_due_to_stack__
+void signTx_handleTemplateInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
+	{
+		// sanity checks
+		CHECK_STAGE(SIGN_STAGE_INIT);
+
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+	}
+
+	// the previous template is dropped even if the new one is invalid
+	explicit_bzero(&signTxTemplate, SIZEOF(signTxTemplate));
+
+	struct {
+		uint8_t chainId[CHAIN_ID_LENGTH];
+		uint8_t contractAccountName[CONTRACT_ACCOUNT_NAME_LENGTH];
+		uint8_t actor[NAME_VAR_LENGTH];
+		uint8_t permission[NAME_VAR_LENGTH];
+	}* wireData = (void*) wireDataBuffer;
+
+	{
+		// parse data
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		VALIDATE(SIZEOF(*wireData) <= wireDataSize, ERR_INVALID_DATA);
+		size_t parsedSize = SIZEOF(*wireData);
+		parsedSize += bip44_parseFromWire(
+		                      &signTxTemplate.wittnessPath,
+		                      wireDataBuffer + parsedSize, wireDataSize - parsedSize
+		              );
+		VALIDATE(parsedSize == wireDataSize, ERR_INVALID_DATA);
+
+		signTxTemplate.network = getNetworkByChainId(wireData->chainId, SIZEOF(wireData->chainId));
+		TRACE("Network %d:", signTxTemplate.network);
+	}
+
+	// the same policies apply again to each transaction
+	ENSURE_NOT_DENIED(policyForSignTxInit(signTxTemplate.network));
+	ENSURE_NOT_DENIED(policyForSignTxActionHeader(
+	                          getActionTypeByContractAccountName(
+	                                  signTxTemplate.network,
+	                                  wireData->contractAccountName, SIZEOF(wireData->contractAccountName)
+	                          )
+	                  ));
+	ENSURE_NOT_DENIED(policyForSignTxWitness(&signTxTemplate.wittnessPath));
+
+	memcpy(signTxTemplate.chainId, wireData->chainId, SIZEOF(signTxTemplate.chainId));
+	memcpy(signTxTemplate.contractAccountName, wireData->contractAccountName, SIZEOF(signTxTemplate.contractAccountName));
+	memcpy(signTxTemplate.actor, wireData->actor, SIZEOF(signTxTemplate.actor));
+	memcpy(signTxTemplate.permission, wireData->permission, SIZEOF(signTxTemplate.permission));
+	signTxTemplate.isValid = true;
+
+	// nothing is signed yet, so nothing is shown
+	io_send_buf(SUCCESS, NULL, 0);
+	ctx->stage = SIGN_STAGE_NONE;
+	ui_idle();
+}
+
+__noinline_due_to_stack__
+void signTx_handleTemplateTxAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
+	{
+		// sanity checks
+		CHECK_STAGE(SIGN_STAGE_INIT);
+
+		VALIDATE(p2 == P2_UNUSED || p2 == P2_OUTSIDE_SESSION, ERR_INVALID_REQUEST_PARAMETERS);
+		VALIDATE(signTxTemplate.isValid, ERR_INVALID_STATE);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+	}
+
+	// header, one action with a single authorization, all but the header taken from the template
+	uint8_t prefix[TEMPLATE_TX_HEADER_LENGTH + 4 + 1 + CONTRACT_ACCOUNT_NAME_LENGTH + 1 + 2 * NAME_VAR_LENGTH];
+	{
+		// parse data
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		// the rest is action data and transaction extensions
+		VALIDATE(TEMPLATE_TX_HEADER_LENGTH < wireDataSize, ERR_INVALID_DATA);
+
+		size_t size = 0;
+		memcpy(prefix + size, wireDataBuffer, TEMPLATE_TX_HEADER_LENGTH);
+		size += TEMPLATE_TX_HEADER_LENGTH;
+		// max_net_usage_words, max_cpu_usage_ms, delay_sec, context_free_actions
+		explicit_bzero(prefix + size, 4);
+		size += 4;
+		prefix[size++] = 1; // actions
+		memcpy(prefix + size, signTxTemplate.contractAccountName, CONTRACT_ACCOUNT_NAME_LENGTH);
+		size += CONTRACT_ACCOUNT_NAME_LENGTH;
+		prefix[size++] = 1; // authorizations
+		memcpy(prefix + size, signTxTemplate.actor, NAME_VAR_LENGTH);
+		size += NAME_VAR_LENGTH;
+		memcpy(prefix + size, signTxTemplate.permission, NAME_VAR_LENGTH);
+		size += NAME_VAR_LENGTH;
+		ASSERT(size == SIZEOF(prefix));
+	}
+
+	ctx->network = signTxTemplate.network;
+	ENSURE_NOT_DENIED(policyForSignTxInit(ctx->network));
+	ENSURE_NOT_DENIED(policyForSignTxHeader());
+	signTx_initSession(p2);
+
+	TRACE("SHA_256_init");
+	sha_256_buffered_init(&ctx->hashContext);
+	sha_256_buffered_append(&ctx->hashContext, signTxTemplate.chainId, SIZEOF(signTxTemplate.chainId));
+
+	const size_t variableSize = wireDataSize - TEMPLATE_TX_HEADER_LENGTH;
+	VALIDATE(SIZEOF(prefix) + variableSize <= 0xFFFF, ERR_INVALID_DATA);
+	ctx->rawBytesRemaining = (uint16_t) (SIZEOF(prefix) + variableSize);
+
+	txParser_init(&ctx->txParser, ctx->network);
+	ctx->rawMode = true;
+	ctx->rawRespondWithStatus = true;
+	advanceStage();
+
+	// the prefix ends before the action data, so no action is complete yet
+	sha_256_buffered_append(&ctx->hashContext, prefix, SIZEOF(prefix));
+	ctx->rawBytesRemaining -= SIZEOF(prefix);
+	size_t consumed = txParser_process(&ctx->txParser, prefix, SIZEOF(prefix));
+	ASSERT(consumed == SIZEOF(prefix));
+	ASSERT(!txParser_isActionComplete(&ctx->txParser));
+
+	signTx_startRawTxChunk(wireDataBuffer + TEMPLATE_TX_HEADER_LENGTH, variableSize);
+
+	memcpy(&ctx->wittnessPath, &signTxTemplate.wittnessPath, SIZEOF(ctx->wittnessPath));
+	signTx_startEarlyWitness();
+
+	ctx->ui_step = HANDLE_RAW_TX_STEP_SHOW_CHAIN;
+	signTx_handleRawTx_ui_runStep();
 }
 
 // ============================== WITNESS ==============================
 
 enum {
-	HANDLE_WITNESS_STEP_DISPLAY_DETAILS = 1000,
+	HANDLE_WITNESS_STEP_SHOW_TOTAL_AMOUNT = 1000,
+	HANDLE_WITNESS_STEP_SHOW_TOTAL_MAX_FEE,
+	HANDLE_WITNESS_STEP_DISPLAY_DETAILS,
 	HANDLE_WITNESS_STEP_CONFIRM,
 	HANDLE_WITNESS_STEP_RESPOND,
 	HANDLE_WITNESS_STEP_INVALID,
@@ -598,8 +1151,28 @@ static void signTx_handleWitness_ui_runStep()
 
 	UI_STEP_BEGIN(ctx->ui_step, this_fn);
 
+	UI_STEP(HANDLE_WITNESS_STEP_SHOW_TOTAL_AMOUNT) {
+		// totals are the same as the values already shown
+		if (ctx->numActions == 1) {
+			UI_STEP_JUMP(HANDLE_WITNESS_STEP_DISPLAY_DETAILS);
+		}
+		ui_displayFIOAmountScreen(
+		        "Total amount",
+		        ctx->totalAmount,
+		        this_fn
+		);
+	}
+
+	UI_STEP(HANDLE_WITNESS_STEP_SHOW_TOTAL_MAX_FEE) {
+		ui_displayFIOAmountScreen(
+		        "Total max fee",
+		        ctx->totalMaxFee,
+		        this_fn
+		);
+	}
+
 	UI_STEP(HANDLE_WITNESS_STEP_DISPLAY_DETAILS) {
-		ui_displayPubkeyScreen("Sign with", &ctx->wittnessPathPubkey, this_fn);
+		ui_displayPubkeyScreen("Sign with", ctx->wittnessPathPubkeyWif, this_fn);
 	}
 
 	UI_STEP(HANDLE_WITNESS_STEP_CONFIRM) {
@@ -612,7 +1185,8 @@ static void signTx_handleWitness_ui_runStep()
 	}
 
 	UI_STEP(HANDLE_WITNESS_STEP_RESPOND) {
-		io_send_buf(SUCCESS, G_io_apdu_buffer, 65 + 32);
+		lastResponse_save(G_io_apdu_buffer, ctx->responseSize);
+		io_send_buf(SUCCESS, G_io_apdu_buffer, ctx->responseSize);
 		ui_displayBusy(); // needs to happen after I/O
 		advanceStage();
 	}
@@ -628,12 +1202,16 @@ void signTx_handleWitnessAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDa
 		// sanity checks
 		CHECK_STAGE(SIGN_STAGE_WITNESS);
 		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		ASSERT(ctx->numActionsProcessed == ctx->numActions);
 		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
 	}
 
-	explicit_bzero(&ctx->wittnessPath, SIZEOF(ctx->wittnessPath));
+	if (ctx->earlyWitness) {
+		// the path was already sent in INIT
+		VALIDATE(wireDataSize == 0, ERR_INVALID_DATA);
+	} else {
+		explicit_bzero(&ctx->wittnessPath, SIZEOF(ctx->wittnessPath));
 
-	{
 		// parse
 		TRACE_BUFFER(wireDataBuffer, wireDataSize);
 
@@ -644,35 +1222,40 @@ void signTx_handleWitnessAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDa
 	security_policy_t policy = POLICY_DENY;
 	{
 		// get policy
-		policy = policyForSignTxWitness(&ctx->wittnessPath);
+		PROFILE_BEGIN(PROFILE_PHASE_POLICY);
+		if (ctx->inSession) {
+			policy = policyForSignTxWitnessInSession(
+			                 signingSession_get(), &ctx->wittnessPath,
+			                 ctx->totalAmount, ctx->totalMaxFee
+			         );
+		} else {
+			policy = policyForSignTxWitness(&ctx->wittnessPath);
+		}
+		PROFILE_END(PROFILE_PHASE_POLICY, (uint8_t) policy);
 		TRACE("Policy: %d", (int) policy);
 		ENSURE_NOT_DENIED(policy);
 	}
 
-	//Extension points
-	uint8_t buf[1];
-	explicit_bzero(buf, SIZEOF(buf));
-	sha_256_append(&ctx->hashContext, buf, SIZEOF(buf));
+	PROFILE_BEGIN(PROFILE_PHASE_HASH);
+	//Extension points, already part of packed_trx in raw mode
+	if (!ctx->rawMode) {
+		uint8_t buf[1];
+		explicit_bzero(buf, SIZEOF(buf));
+		sha_256_buffered_append(&ctx->hashContext, buf, SIZEOF(buf));
+	}
 
 	//We finish the hash appending a 32-byte empty buffer
 	uint8_t hashBuf[32];
 	explicit_bzero(hashBuf, SIZEOF(hashBuf));
-	sha_256_append(&ctx->hashContext, hashBuf, SIZEOF(hashBuf));
+	sha_256_buffered_append(&ctx->hashContext, hashBuf, SIZEOF(hashBuf));
 
 	//we get the resulting hash
-	sha_256_finalize(&ctx->hashContext, hashBuf, SIZEOF(hashBuf));
+	sha_256_buffered_finalize(&ctx->hashContext, hashBuf, SIZEOF(hashBuf));
+	PROFILE_END(PROFILE_PHASE_HASH, 0);
 	TRACE("SHA_256_finalize, resulting hash:");
 	TRACE_BUFFER(hashBuf, 32);
 
-	//We derive the private key
 	private_key_t privateKey;
-	derivePrivateKey(&ctx->wittnessPath, &privateKey);
-	TRACE("privateKey.d:");
-	TRACE_BUFFER(privateKey.d, privateKey.d_len);
-
-	//We want to show pubkey, thus we derive it
-	derivePublicKey(&ctx->wittnessPath, &ctx->wittnessPathPubkey);
-	TRACE_BUFFER(ctx->wittnessPathPubkey.W, SIZEOF(ctx->wittnessPathPubkey.W));
 
 	//We sign the hash
 	//Code producing signatures is taken from EOS app
@@ -687,7 +1270,26 @@ void signTx_handleWitnessAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDa
 	// The code produces the signature right where we need it for the respons
 	BEGIN_TRY {
 		TRY {
+			if (ctx->earlyWitness) {
+				//The key pair was derived while the user reviewed the transaction
+				earlyWitness_take(&privateKey);
+			} else {
+				//We derive the private key and the pubkey to be shown at once
+				public_key_t publicKey;
+				deriveKeyPair(&ctx->wittnessPath, &privateKey, &publicKey);
+				TRACE("privateKey.d:");
+				TRACE_BUFFER(privateKey.d, privateKey.d_len);
+				TRACE_BUFFER(publicKey.W, SIZEOF(publicKey.W));
+
+				//Only the WIF is needed for the UI
+				public_key_to_wif(
+				        publicKey.W, SIZEOF(publicKey.W),
+				        ctx->wittnessPathPubkeyWif, SIZEOF(ctx->wittnessPathPubkeyWif)
+				);
+			}
+
 			explicit_bzero(G_io_apdu_buffer, SIZEOF(G_io_apdu_buffer));
+			PROFILE_BEGIN(PROFILE_PHASE_SIGN);
 			for (;;)
 			{
 				if (tries == 0) {
@@ -717,9 +1319,11 @@ void signTx_handleWitnessAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDa
 					tries++;
 				}
 			}
+			// more than one attempt means check_canonical rejected a signature
+			PROFILE_END(PROFILE_PHASE_SIGN, (uint8_t) (tries + 1));
 		}
 		FINALLY {
-			memset(&privateKey, 0, sizeof(privateKey));
+			explicit_bzero(&privateKey, SIZEOF(privateKey));
 		}
 	}
 	END_TRY;
@@ -728,12 +1332,22 @@ void signTx_handleWitnessAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDa
 	TRACE("ecdsa_der_to_sig_result:");
 	TRACE_BUFFER(G_io_apdu_buffer, 65);
 	memcpy(G_io_apdu_buffer + 65, hashBuf, 32);
+	ctx->responseSize = 65 + 32;
+
+	if (ctx->inSession) {
+		// the signature is out, charge it and report what is left
+		signingSession_spend(ctx->totalAmount + ctx->totalMaxFee);
+		const signing_session_t* session = signingSession_get();
+		u8be_write(G_io_apdu_buffer + ctx->responseSize, (session == NULL) ? 0 : session->remainingBudget);
+		ctx->responseSize += 8;
+	}
 
 	{
 		// select UI steps
 		switch (policy) {
 #	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
-			CASE(POLICY_PROMPT_BEFORE_RESPONSE, HANDLE_WITNESS_STEP_DISPLAY_DETAILS);
+			CASE(POLICY_PROMPT_BEFORE_RESPONSE, HANDLE_WITNESS_STEP_SHOW_TOTAL_AMOUNT);
+			CASE(POLICY_ALLOW_WITHOUT_PROMPT, HANDLE_WITNESS_STEP_RESPOND);
 #	undef   CASE
 		default:
 			THROW(ERR_NOT_IMPLEMENTED);
@@ -758,7 +1372,12 @@ static subhandler_fn_t* lookup_subhandler(uint8_t p1)
 		CASE(0x03, signTx_handleActionHeaderAPDU);
 		CASE(0x04, signTx_handleActionAuthorizationAPDU);
 		CASE(0x05, signTx_handleActionDataAPDU);
+		CASE(0x06, signTx_handleRawInitAPDU);
+		CASE(0x07, signTx_handleRawChunkAPDU);
+		CASE(0x08, signTx_handleActionDataChunkAPDU);
 		CASE(0x10, signTx_handleWitnessAPDU);
+		CASE(0x30, signTx_handleTemplateInitAPDU);
+		CASE(0x31, signTx_handleTemplateTxAPDU);
 		DEFAULT(NULL)
 #	undef   CASE
 #	undef   DEFAULT
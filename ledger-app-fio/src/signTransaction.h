@@ -5,11 +5,15 @@
 #include "hash.h"
 #include "fio.h"
 #include "keyDerivation.h"
+#include "txParser.h"
 
 handler_fn_t signTransaction_handleAPDU;
 
+// order of the secp256k1 curve, passed to rng_rfc6979()
+extern uint8_t const SECP256K1_N[32];
+
 typedef struct {
-	sha_256_context_t hashContext;
+	sha_256_buffered_context_t hashContext;
 	int ui_step;
 	int stage;
 
@@ -22,6 +26,13 @@ typedef struct {
 	uint16_t refBlockNum;
 	uint32_t refBlockPrefix;
 
+	//ACTION HEADER, AUTHORIZATION and DATA steps are repeated for each action
+	uint8_t numActions;
+	uint8_t numActionsProcessed;
+	//totals over all actions, shown before signing
+	uint64_t totalAmount;
+	uint64_t totalMaxFee;
+
 	//only used in ACTION HEADER step
 	action_type_t action_type;
 
@@ -34,10 +45,28 @@ typedef struct {
 	uint64_t maxFee;
 	char actionDataActor[NAME_STRING_MAX_LENGTH];
 	char *tpid;
+	//action data streamed in canonical form are parsed by txParser
+	bool actionDataStreamStarted;
+
+	//used in RAW_TX step, transaction is streamed as packed_trx
+	//and in ACTION_DATA step when action data are streamed
+	bool rawMode;
+	uint16_t rawBytesRemaining;
+	tx_parser_context_t txParser;
+	//unparsed rest of the current chunk, it stays in G_io_apdu_buffer while actions are shown
+	const uint8_t* rawChunk;
+	size_t rawChunkSize;
+	//the first call is answered with the last response status
+	bool rawRespondWithStatus;
+
+	//signed within a signing session without any screens
+	bool inSession;
 
-	//only used in WITNESS step
+	//only used in WITNESS step, or already in INIT with early witness
+	bool earlyWitness;
 	bip44_path_t wittnessPath;
-	public_key_t wittnessPathPubkey;
+	char wittnessPathPubkeyWif[MAX_WIF_PUBKEY_LENGTH]; // null terminated
+	size_t responseSize;
 
 } ins_sign_transaction_context_t;
 
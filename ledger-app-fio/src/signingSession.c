@@ -0,0 +1,404 @@
+#include "common.h"
+#include "signingSession.h"
+#include "state.h"
+#include "securityPolicy.h"
+#include "uiHelpers.h"
+#include "uiScreens.h"
+#include "textUtils.h"
+#include "eos_utils.h"
+#include "endian.h"
+#include "io.h"
+
+static ins_signing_session_context_t* ctx = &(instructionState.signingSessionContext);
+
+// Lives outside of instructionState, across the calls within the session.
+static struct {
+	bool isActive;
+	signing_session_t session;
+} activeSession;
+
+typedef enum {
+	SESSION_STAGE_NONE = 0,
+	SESSION_STAGE_INIT = 43,
+	SESSION_STAGE_PAYEES = 44,
+} signing_session_stage_t;
+
+static inline void CHECK_STAGE(signing_session_stage_t expected)
+{
+	VALIDATE(ctx->stage == (int) expected, ERR_INVALID_STATE);
+}
+
+static void signingSession_end()
+{
+	TRACE("Signing session ended");
+	explicit_bzero(&activeSession, SIZEOF(activeSession));
+}
+
+const signing_session_t* signingSession_get()
+{
+	if (!activeSession.isActive) return NULL;
+
+	// the difference survives an overflow of the ticker count
+	if ((int32_t) (io_get_ticker_count() - activeSession.session.expiresAtTicker) >= 0) {
+		signingSession_end();
+		return NULL;
+	}
+	return &activeSession.session;
+}
+
+static void hashPayee(const char* payee, uint8_t* hash, size_t hashSize)
+{
+	sha_256_hash((const uint8_t*) payee, strlen(payee), hash, hashSize);
+}
+
+bool signingSession_isPayeeAllowed(const signing_session_t* session, const char* payee)
+{
+	if (session->numPayees == 0) return true;
+
+	uint8_t hash[SHA_256_SIZE];
+	hashPayee(payee, hash, SIZEOF(hash));
+	for (size_t i = 0; i < session->numPayees; i++) {
+		if (!memcmp(session->payeeHashes[i], hash, SIZEOF(hash))) return true;
+	}
+	return false;
+}
+
+void signingSession_spend(uint64_t amount)
+{
+	ASSERT(activeSession.isActive);
+	ASSERT(amount <= activeSession.session.remainingBudget);
+
+	activeSession.session.remainingBudget -= amount;
+	TRACE("Remaining session budget: %u", (unsigned) activeSession.session.remainingBudget);
+	if (activeSession.session.remainingBudget == 0) {
+		signingSession_end();
+	}
+}
+
+// active flag, remaining budget and seconds, all zero without a session
+static size_t writeStatus(uint8_t* buffer, size_t bufferSize)
+{
+	const signing_session_t* session = signingSession_get();
+	const size_t size = 1 + 8 + 4;
+	ASSERT(size <= bufferSize);
+
+	explicit_bzero(buffer, size);
+	if (session != NULL) {
+		uint32_t remainingTicks = session->expiresAtTicker - io_get_ticker_count();
+		u1be_write(buffer, 1);
+		u8be_write(buffer + 1, session->remainingBudget);
+		u4be_write(buffer + 9, remainingTicks / (1000 / TICKER_INTERVAL_MS));
+	}
+	return size;
+}
+
+static void respondWithStatus()
+{
+	size_t size = writeStatus(G_io_apdu_buffer, SIZEOF(G_io_apdu_buffer));
+	io_send_buf(SUCCESS, G_io_apdu_buffer, size);
+}
+
+// ============================== INIT ==============================
+
+__noinline_due_to_stack__
+static void signingSession_handleInitAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
+	{
+		// sanity checks
+		CHECK_STAGE(SESSION_STAGE_INIT);
+
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+	}
+
+	// a new session must be approved from scratch
+	signingSession_end();
+
+	signing_session_t* session = &ctx->session;
+	{
+		// parse data
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		struct {
+			uint8_t chainId[CHAIN_ID_LENGTH];
+			uint8_t spendingCap[8];
+			uint8_t maxFee[8];
+			uint8_t lifetimeSeconds[4];
+		}* wireData = (void*) wireDataBuffer;
+
+		VALIDATE(SIZEOF(*wireData) <= wireDataSize, ERR_INVALID_DATA);
+
+		session->network = getNetworkByChainId(wireData->chainId, SIZEOF(wireData->chainId));
+		session->remainingBudget = u8be_read(wireData->spendingCap);
+		session->maxFee = u8be_read(wireData->maxFee);
+		ctx->lifetimeSeconds = u4be_read(wireData->lifetimeSeconds);
+
+		size_t parsedSize = SIZEOF(*wireData);
+		parsedSize += bip44_parseFromWire(
+		                      &session->wittnessPath,
+		                      wireDataBuffer + parsedSize, wireDataSize - parsedSize
+		              );
+		VALIDATE(parsedSize == wireDataSize, ERR_INVALID_DATA);
+	}
+
+	security_policy_t policy = policyForSigningSessionInit(
+	                                   session->network, &session->wittnessPath,
+	                                   session->remainingBudget, ctx->lifetimeSeconds
+	                           );
+	TRACE("Policy: %d", (int) policy);
+	ENSURE_NOT_DENIED(policy);
+
+	{
+		// the key to sign with is shown at the end
+		public_key_t publicKey;
+		derivePublicKey(&session->wittnessPath, &publicKey);
+		public_key_to_wif(
+		        publicKey.W, SIZEOF(publicKey.W),
+		        ctx->pubkeyWif, SIZEOF(ctx->pubkeyWif)
+		);
+	}
+
+	// everything is shown together with the payees in CONFIRM
+	io_send_buf(SUCCESS, NULL, 0);
+	ctx->stage = SESSION_STAGE_PAYEES;
+}
+
+// ============================== PAYEE ==============================
+
+enum {
+	HANDLE_PAYEE_STEP_DISPLAY = 2100,
+	HANDLE_PAYEE_STEP_RESPOND,
+	HANDLE_PAYEE_STEP_INVALID,
+};
+
+static void signingSession_handlePayee_ui_runStep()
+{
+	TRACE("UI step %d", ctx->ui_step);
+	ui_callback_fn_t* this_fn = signingSession_handlePayee_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step, this_fn);
+
+	UI_STEP(HANDLE_PAYEE_STEP_DISPLAY) {
+		ui_displayPaginatedText("Allowed payee", ctx->payee, this_fn);
+	}
+	UI_STEP(HANDLE_PAYEE_STEP_RESPOND) {
+		io_send_buf(SUCCESS, NULL, 0);
+		ui_displayBusy(); // needs to happen after I/O
+	}
+	UI_STEP_END(HANDLE_PAYEE_STEP_INVALID);
+}
+
+__noinline_due_to_stack__
+static void signingSession_handlePayeeAPDU(uint8_t p2, uint8_t* wireDataBuffer, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
+	{
+		// sanity checks
+		CHECK_STAGE(SESSION_STAGE_PAYEES);
+
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		ASSERT(wireDataSize < BUFFER_SIZE_PARANOIA);
+		VALIDATE(ctx->session.numPayees < SIGNING_SESSION_MAX_PAYEES, ERR_INVALID_DATA);
+	}
+
+	{
+		// parse data
+		TRACE_BUFFER(wireDataBuffer, wireDataSize);
+
+		VALIDATE(wireDataSize > 0 && wireDataSize < SIZEOF(ctx->payee), ERR_INVALID_DATA);
+		str_validateTextBuffer(wireDataBuffer, wireDataSize);
+
+		explicit_bzero(ctx->payee, SIZEOF(ctx->payee));
+		memcpy(ctx->payee, wireDataBuffer, wireDataSize);
+	}
+
+	security_policy_t policy = policyForSigningSessionPayee();
+	TRACE("Policy: %d", (int) policy);
+	ENSURE_NOT_DENIED(policy);
+
+	hashPayee(ctx->payee, ctx->session.payeeHashes[ctx->session.numPayees], SHA_256_SIZE);
+	ctx->session.numPayees++;
+
+	{
+		// select UI steps
+		switch (policy) {
+#	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
+			CASE(POLICY_SHOW_BEFORE_RESPONSE, HANDLE_PAYEE_STEP_DISPLAY);
+#	undef   CASE
+		default:
+			THROW(ERR_NOT_IMPLEMENTED);
+		}
+	}
+
+	signingSession_handlePayee_ui_runStep();
+}
+
+// ============================== CONFIRM ==============================
+
+enum {
+	HANDLE_CONFIRM_STEP_CHAIN = 2200,
+	HANDLE_CONFIRM_STEP_PUBKEY,
+	HANDLE_CONFIRM_STEP_SPENDING_CAP,
+	HANDLE_CONFIRM_STEP_MAX_FEE,
+	HANDLE_CONFIRM_STEP_LIFETIME,
+	HANDLE_CONFIRM_STEP_ANY_PAYEE,
+	HANDLE_CONFIRM_STEP_CONFIRM,
+	HANDLE_CONFIRM_STEP_RESPOND,
+	HANDLE_CONFIRM_STEP_INVALID,
+};
+
+static void signingSession_handleConfirm_ui_runStep()
+{
+	TRACE("UI step %d", ctx->ui_step);
+	ui_callback_fn_t* this_fn = signingSession_handleConfirm_ui_runStep;
+
+	UI_STEP_BEGIN(ctx->ui_step, this_fn);
+
+	UI_STEP(HANDLE_CONFIRM_STEP_CHAIN) {
+		switch(ctx->session.network) {
+#	define  CASE(NETWORK, CHAIN_STRING) case NETWORK: {ui_displayPaginatedText("Session chain", CHAIN_STRING, this_fn); break;}
+			CASE(NETWORK_MAINNET, "Mainnet");
+			CASE(NETWORK_TESTNET, "Testnet");
+#	undef   CASE
+		default:
+			THROW(ERR_NOT_IMPLEMENTED);
+		}
+	}
+	UI_STEP(HANDLE_CONFIRM_STEP_PUBKEY) {
+		ui_displayPubkeyScreen("Sign with", ctx->pubkeyWif, this_fn);
+	}
+	UI_STEP(HANDLE_CONFIRM_STEP_SPENDING_CAP) {
+		// amounts and max fees together
+		ui_displayFIOAmountScreen("Spending cap", ctx->session.remainingBudget, this_fn);
+	}
+	UI_STEP(HANDLE_CONFIRM_STEP_MAX_FEE) {
+		ui_displayFIOAmountScreen("Max fee per tx", ctx->session.maxFee, this_fn);
+	}
+	UI_STEP(HANDLE_CONFIRM_STEP_LIFETIME) {
+		// ticker time, which stops during syscalls, so the session may last longer
+		ui_displayUint64Screen("Lasts at least (s)", ctx->lifetimeSeconds, this_fn);
+	}
+	UI_STEP(HANDLE_CONFIRM_STEP_ANY_PAYEE) {
+		// allowed payees were shown one by one
+		if (ctx->session.numPayees > 0) {
+			UI_STEP_JUMP(HANDLE_CONFIRM_STEP_CONFIRM);
+		}
+		ui_displayPaginatedText("Allowed payees", "Any", this_fn);
+	}
+	UI_STEP(HANDLE_CONFIRM_STEP_CONFIRM) {
+		ui_displayPrompt(
+		        "Sign without",
+		        "confirmation?",
+		        this_fn,
+		        respond_with_user_reject
+		);
+	}
+	UI_STEP(HANDLE_CONFIRM_STEP_RESPOND) {
+		// the lifetime starts after the approval
+		ctx->session.expiresAtTicker = io_get_ticker_count()
+		                               + ctx->lifetimeSeconds * (1000 / TICKER_INTERVAL_MS);
+		memcpy(&activeSession.session, &ctx->session, SIZEOF(activeSession.session));
+		activeSession.isActive = true;
+
+		respondWithStatus();
+		ui_idle();
+	}
+	UI_STEP_END(HANDLE_CONFIRM_STEP_INVALID);
+}
+
+__noinline_due_to_stack__
+static void signingSession_handleConfirmAPDU(uint8_t p2, uint8_t* wireDataBuffer MARK_UNUSED, size_t wireDataSize)
+{
+	TRACE_STACK_USAGE();
+	{
+		// sanity checks
+		CHECK_STAGE(SESSION_STAGE_PAYEES);
+
+		VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+		VALIDATE(wireDataSize == 0, ERR_INVALID_DATA);
+	}
+
+	security_policy_t policy = policyForSigningSessionConfirm();
+	TRACE("Policy: %d", (int) policy);
+	ENSURE_NOT_DENIED(policy);
+
+	{
+		// select UI steps
+		switch (policy) {
+#	define  CASE(POLICY, UI_STEP) case POLICY: {ctx->ui_step=UI_STEP; break;}
+			CASE(POLICY_PROMPT_BEFORE_RESPONSE, HANDLE_CONFIRM_STEP_CHAIN);
+#	undef   CASE
+		default:
+			THROW(ERR_NOT_IMPLEMENTED);
+		}
+	}
+
+	ctx->stage = SESSION_STAGE_NONE;
+	signingSession_handleConfirm_ui_runStep();
+}
+
+// ============================== STATUS / END ==============================
+
+// single APDU calls, nothing is shown
+
+static void signingSession_handleStatusAPDU(uint8_t p2, uint8_t* wireDataBuffer MARK_UNUSED, size_t wireDataSize)
+{
+	CHECK_STAGE(SESSION_STAGE_INIT);
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_DATA);
+
+	respondWithStatus();
+	ui_idle();
+}
+
+static void signingSession_handleEndAPDU(uint8_t p2, uint8_t* wireDataBuffer MARK_UNUSED, size_t wireDataSize)
+{
+	CHECK_STAGE(SESSION_STAGE_INIT);
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_DATA);
+
+	signingSession_end();
+	io_send_buf(SUCCESS, NULL, 0);
+	ui_idle();
+}
+
+// ============================== MAIN HANDLER ==============================
+
+typedef void subhandler_fn_t(uint8_t p2, uint8_t* dataBuffer, size_t dataSize);
+
+static subhandler_fn_t* lookup_subhandler(uint8_t p1)
+{
+	switch(p1) {
+#	define  CASE(P1, HANDLER) case P1: return HANDLER;
+#	define  DEFAULT(HANDLER)  default: return HANDLER;
+		CASE(0x01, signingSession_handleInitAPDU);
+		CASE(0x02, signingSession_handlePayeeAPDU);
+		CASE(0x03, signingSession_handleConfirmAPDU);
+		CASE(0x10, signingSession_handleStatusAPDU);
+		CASE(0x11, signingSession_handleEndAPDU);
+		DEFAULT(NULL)
+#	undef   CASE
+#	undef   DEFAULT
+	}
+}
+
+void signingSession_handleAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t* wireDataBuffer,
+        size_t wireDataSize,
+        bool isNewCall
+)
+{
+	TRACE("P1 = 0x%x, P2 = 0x%x, isNewCall = %d", p1, p2, isNewCall);
+
+	if (isNewCall) {
+		explicit_bzero(ctx, SIZEOF(*ctx));
+		ctx->stage = SESSION_STAGE_INIT;
+	}
+
+	subhandler_fn_t* subhandler = lookup_subhandler(p1);
+	VALIDATE(subhandler != NULL, ERR_INVALID_REQUEST_PARAMETERS);
+	subhandler(p2, wireDataBuffer, wireDataSize);
+}
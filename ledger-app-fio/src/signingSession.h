@@ -0,0 +1,54 @@
+#ifndef H_FIO_APP_SIGNING_SESSION
+#define H_FIO_APP_SIGNING_SESSION
+
+#include "common.h"
+#include "handlers.h"
+#include "bip44.h"
+#include "fio.h"
+#include "hash.h"
+
+// The user approves the limits of a session once, transactions which
+// conform to them are then signed without any screens (see securityPolicy.c).
+// The session is kept until it expires, its budget is spent, it is ended
+// by the host or the app exits.
+
+#define SIGNING_SESSION_MAX_PAYEES 4
+#define SIGNING_SESSION_MAX_LIFETIME_SECONDS (24 * 60 * 60)
+
+typedef struct {
+	network_type_t network;
+	bip44_path_t wittnessPath;
+	// amounts and max fees of transactions still allowed to be signed
+	uint64_t remainingBudget;
+	// per transaction
+	uint64_t maxFee;
+	// ticker events stop during long syscalls, the session lasts at least its lifetime
+	uint32_t expiresAtTicker;
+	// hashes of payee pubkeys, empty list allows any payee
+	uint8_t numPayees;
+	uint8_t payeeHashes[SIGNING_SESSION_MAX_PAYEES][SHA_256_SIZE];
+} signing_session_t;
+
+typedef struct {
+	int stage;
+	int ui_step;
+
+	// becomes the active session when confirmed
+	signing_session_t session;
+	uint32_t lifetimeSeconds;
+
+	char pubkeyWif[MAX_WIF_PUBKEY_LENGTH]; // null terminated
+	char payee[MAX_WIF_PUBKEY_LENGTH]; // null terminated, the one being shown
+} ins_signing_session_context_t;
+
+handler_fn_t signingSession_handleAPDU;
+
+// The active session, NULL if there is none (an expired session is ended here)
+const signing_session_t* signingSession_get();
+
+bool signingSession_isPayeeAllowed(const signing_session_t* session, const char* payee);
+
+// Charges a signed transaction to the budget, the session ends when nothing is left
+void signingSession_spend(uint64_t amount);
+
+#endif // H_FIO_APP_SIGNING_SESSION
@@ -0,0 +1,135 @@
+#ifdef DEVEL
+
+#include "stackUsage.h"
+#include "endian.h"
+#include "uiHelpers.h"
+
+#define STACK_PAINT_PATTERN 0xA5A5A5A5u
+
+// keeps the frame of stackUsage_paint() itself out of the painted area
+#define STACK_PAINT_MARGIN 32
+
+typedef struct {
+	uint8_t ins;
+	uint16_t minFree;
+} stack_usage_entry_t;
+
+static struct {
+	stack_usage_entry_t entries[STACK_USAGE_MAX_INSTRUCTIONS];
+	uint8_t numEntries;
+	uint8_t currentIns;
+	// between app_stack_canary and the stack pointer at boot
+	uint16_t stackSize;
+} stackUsage;
+
+// the canary is the lowest word of the stack
+static uint32_t* paintedBegin()
+{
+	return (uint32_t*) (&app_stack_canary + 1);
+}
+
+// the painted area ends below the frame of the caller
+static __attribute__((noinline)) void paint()
+{
+	volatile uint32_t marker = 0;
+	uint32_t* end = (uint32_t*) ((uint8_t*) &marker - STACK_PAINT_MARGIN);
+	for (uint32_t* it = paintedBegin(); it < end; it++) {
+		*it = STACK_PAINT_PATTERN;
+	}
+}
+
+// stack never reached since the last paint
+static uint16_t freeBytes()
+{
+	const uint32_t* it = paintedBegin();
+	// stops at latest at the frame of the caller of paint()
+	while (*it == STACK_PAINT_PATTERN) {
+		it++;
+	}
+	return (uint16_t) ((const uint8_t*) it - (const uint8_t*) paintedBegin());
+}
+
+void stackUsage_init()
+{
+	volatile uint32_t marker = 0;
+	explicit_bzero(&stackUsage, SIZEOF(stackUsage));
+	stackUsage.stackSize = (uint16_t) ((uint8_t*) &marker - (uint8_t*) paintedBegin());
+	stackUsage.currentIns = STACK_USAGE_NO_INSTRUCTION;
+	paint();
+}
+
+void stackUsage_setInstruction(uint8_t ins)
+{
+	stackUsage.currentIns = ins;
+}
+
+void stackUsage_update()
+{
+	ASSERT(app_stack_canary == APP_STACK_CANARY_MAGIC);
+
+	const uint16_t unused = freeBytes();
+	stack_usage_entry_t* entry = NULL;
+	for (size_t i = 0; i < stackUsage.numEntries; i++) {
+		if (stackUsage.entries[i].ins == stackUsage.currentIns) {
+			entry = &stackUsage.entries[i];
+			break;
+		}
+	}
+	if (entry == NULL && stackUsage.numEntries < ARRAY_LEN(stackUsage.entries)) {
+		entry = &stackUsage.entries[stackUsage.numEntries++];
+		entry->ins = stackUsage.currentIns;
+		entry->minFree = stackUsage.stackSize;
+	}
+	if (entry != NULL && unused < entry->minFree) {
+		entry->minFree = unused;
+	}
+	paint();
+}
+
+enum {
+	P1_STACK_USAGE_READ = 0x00,
+	P1_STACK_USAGE_READ_AND_RESET = 0x01,
+};
+
+void stackUsage_handleGetStackUsageAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t *wireDataBuffer MARK_UNUSED,
+        size_t wireDataSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p1 == P1_STACK_USAGE_READ || p1 == P1_STACK_USAGE_READ_AND_RESET, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_REQUEST_PARAMETERS);
+
+	struct {
+		uint8_t stackSize[2];
+		uint8_t count;
+		struct {
+			uint8_t ins;
+			uint8_t maxUsed[2];
+			uint8_t minFree[2];
+		} entries[STACK_USAGE_MAX_INSTRUCTIONS];
+	} response;
+	STATIC_ASSERT(SIZEOF(response) + 2 <= 255, "response does not fit a single APDU");
+
+	u2be_write(response.stackSize, stackUsage.stackSize);
+	response.count = stackUsage.numEntries;
+	for (size_t i = 0; i < stackUsage.numEntries; i++) {
+		const stack_usage_entry_t* entry = &stackUsage.entries[i];
+		response.entries[i].ins = entry->ins;
+		u2be_write(response.entries[i].maxUsed, stackUsage.stackSize - entry->minFree);
+		u2be_write(response.entries[i].minFree, entry->minFree);
+	}
+	const size_t responseSize = 2 + 1 + stackUsage.numEntries * SIZEOF(response.entries[0]);
+
+	if (p1 == P1_STACK_USAGE_READ_AND_RESET) {
+		stackUsage.numEntries = 0;
+	}
+
+	io_send_buf(SUCCESS, (uint8_t*) &response, responseSize);
+	ui_idle();
+}
+
+#endif // DEVEL
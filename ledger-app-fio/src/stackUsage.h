@@ -0,0 +1,35 @@
+#ifdef DEVEL
+
+#ifndef H_FIO_APP_STACK_USAGE
+#define H_FIO_APP_STACK_USAGE
+
+#include "common.h"
+#include "handlers.h"
+
+// Reliable replacement of TRACE_STACK_USAGE (see utils.h).
+// The free stack between app_stack_canary and the main loop is painted
+// with a pattern, after each io_exchange the main loop checks how much
+// of the pattern was overwritten and repaints it. The deepest use is kept
+// per instruction, it includes the UI steps run while waiting for the next APDU.
+// Read by INS 0xF5.
+
+// instructions tracked, the first ones seen get the slots
+#define STACK_USAGE_MAX_INSTRUCTIONS 16
+
+// the stack usage outside of any instruction, e.g. in the menu
+#define STACK_USAGE_NO_INSTRUCTION 0xFF
+
+// paints the stack, call at boot before the main loop
+void stackUsage_init();
+
+// the following stack usage is attributed to ins
+void stackUsage_setInstruction(uint8_t ins);
+
+// records the deepest use since the last call and repaints
+void stackUsage_update();
+
+handler_fn_t stackUsage_handleGetStackUsageAPDU;
+
+#endif // H_FIO_APP_STACK_USAGE
+
+#endif // DEVEL
@@ -3,7 +3,9 @@
 
 #include "getVersion.h"
 #include "getPublicKey.h"
+#include "getAccountPublicKey.h"
 #include "signTransaction.h"
+#include "signingSession.h"
 
 typedef struct {
 	int placeholder;
@@ -16,7 +18,9 @@ typedef struct {
 typedef union {
 	// Here should go states of all instructions
 	ins_get_key_context_t getKeyContext;
+	ins_get_account_key_context_t getAccountKeyContext;
 	ins_sign_transaction_context_t signTransactionContext;
+	ins_signing_session_context_t signingSessionContext;
 } instructionState_t;
 
 // Note(instructions are uint8_t but we have a special INS_NONE value
@@ -11,13 +11,13 @@
 		/* It allows us to have multiple EXPECT_THROWS in one function */ \
 		__label__ __FINALLYEX; \
 		BEGIN_TRY { \
-			bool has_thrown = false; \
+			volatile bool has_thrown = false; \
 			TRY { \
 				expr; \
 			} CATCH(error_code) { \
 				has_thrown = true; \
 			} CATCH_OTHER(e) { \
-				/* pass */ \
+				(void) e; \
 			} FINALLY { \
 				ASSERT(has_thrown); \
 			} \
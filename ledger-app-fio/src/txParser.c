@@ -0,0 +1,297 @@
+#include "txParser.h"
+#include "textUtils.h"
+
+// varuint32 takes at most 5 bytes
+#define VARUINT32_MAX_SHIFT 28
+
+static uint64_t readLE(const uint8_t* buffer, size_t size)
+{
+	ASSERT(size <= 8);
+	uint64_t result = 0;
+	for (size_t i = size; i > 0; i--) {
+		result = (result << 8) | buffer[i - 1];
+	}
+	return result;
+}
+
+static bool isVaruintState(tx_parser_state_t state)
+{
+	switch (state) {
+	case TX_PARSER_STATE_MAX_NET_USAGE_WORDS:
+	case TX_PARSER_STATE_DELAY_SEC:
+	case TX_PARSER_STATE_NUM_CONTEXT_FREE_ACTIONS:
+	case TX_PARSER_STATE_NUM_ACTIONS:
+	case TX_PARSER_STATE_NUM_AUTHORIZATIONS:
+	case TX_PARSER_STATE_ACTION_DATA_LENGTH:
+	case TX_PARSER_STATE_PUBKEY_LENGTH:
+	case TX_PARSER_STATE_TPID_LENGTH:
+	case TX_PARSER_STATE_NUM_TRANSACTION_EXTENSIONS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool isActionDataState(tx_parser_state_t state)
+{
+	return state >= TX_PARSER_STATE_PUBKEY_LENGTH && state <= TX_PARSER_STATE_TPID;
+}
+
+static void onFieldParsed(tx_parser_context_t* ctx);
+
+static void expectVaruint(tx_parser_context_t* ctx, tx_parser_state_t state)
+{
+	ASSERT(isVaruintState(state));
+	ctx->state = state;
+	ctx->varuintValue = 0;
+	ctx->varuintShift = 0;
+}
+
+static void expectField(tx_parser_context_t* ctx, tx_parser_state_t state, uint8_t* buffer, size_t size)
+{
+	ASSERT(!isVaruintState(state));
+	ctx->state = state;
+	ctx->fieldBuffer = buffer;
+	ctx->fieldSize = (uint32_t) size;
+	ctx->fieldParsed = 0;
+
+	// empty strings are complete without consuming anything
+	if (size == 0) {
+		onFieldParsed(ctx);
+	}
+}
+
+static void onVaruintParsed(tx_parser_context_t* ctx)
+{
+	const uint32_t value = ctx->varuintValue;
+	tx_parser_output_t* out = &ctx->output;
+
+	switch (ctx->state) {
+	case TX_PARSER_STATE_MAX_NET_USAGE_WORDS:
+		VALIDATE(value == 0, ERR_INVALID_DATA);
+		expectField(ctx, TX_PARSER_STATE_MAX_CPU_USAGE_MS, ctx->scratch, 1);
+		break;
+
+	case TX_PARSER_STATE_DELAY_SEC:
+		VALIDATE(value == 0, ERR_INVALID_DATA);
+		expectVaruint(ctx, TX_PARSER_STATE_NUM_CONTEXT_FREE_ACTIONS);
+		break;
+
+	case TX_PARSER_STATE_NUM_CONTEXT_FREE_ACTIONS:
+		VALIDATE(value == 0, ERR_INVALID_DATA);
+		expectVaruint(ctx, TX_PARSER_STATE_NUM_ACTIONS);
+		break;
+
+	case TX_PARSER_STATE_NUM_ACTIONS:
+		VALIDATE(value >= 1 && value <= MAX_TX_ACTIONS, ERR_INVALID_DATA);
+		out->numActions = (uint8_t) value;
+		ctx->actionsRemaining = (uint8_t) value;
+		expectField(ctx, TX_PARSER_STATE_CONTRACT_ACCOUNT_NAME, out->contractAccountName, SIZEOF(out->contractAccountName));
+		break;
+
+	case TX_PARSER_STATE_NUM_AUTHORIZATIONS:
+		VALIDATE(value == 1, ERR_INVALID_DATA);
+		expectField(ctx, TX_PARSER_STATE_AUTHORIZATION_ACTOR, ctx->scratch, NAME_VAR_LENGTH);
+		break;
+
+	case TX_PARSER_STATE_ACTION_DATA_LENGTH:
+		ctx->actionDataLength = value;
+		ctx->actionDataParsed = 0;
+		expectVaruint(ctx, TX_PARSER_STATE_PUBKEY_LENGTH);
+		break;
+
+	case TX_PARSER_STATE_PUBKEY_LENGTH:
+		VALIDATE(value < SIZEOF(out->pubkey), ERR_INVALID_DATA); // < for terminating 0
+		expectField(ctx, TX_PARSER_STATE_PUBKEY, (uint8_t*) out->pubkey, value);
+		break;
+
+	case TX_PARSER_STATE_TPID_LENGTH:
+		// not displayed, so it is validated without being kept
+		expectField(ctx, TX_PARSER_STATE_TPID, NULL, value);
+		break;
+
+	case TX_PARSER_STATE_NUM_TRANSACTION_EXTENSIONS:
+		VALIDATE(value == 0, ERR_INVALID_DATA);
+		ctx->state = TX_PARSER_STATE_DONE;
+		break;
+
+	default:
+		ASSERT(false);
+	}
+}
+
+static void onFieldParsed(tx_parser_context_t* ctx)
+{
+	tx_parser_output_t* out = &ctx->output;
+
+	switch (ctx->state) {
+	case TX_PARSER_STATE_EXPIRATION:
+		out->expiration = (uint32_t) readLE(ctx->scratch, 4);
+		expectField(ctx, TX_PARSER_STATE_REF_BLOCK_NUM, ctx->scratch, 2);
+		break;
+
+	case TX_PARSER_STATE_REF_BLOCK_NUM:
+		out->refBlockNum = (uint16_t) readLE(ctx->scratch, 2);
+		expectField(ctx, TX_PARSER_STATE_REF_BLOCK_PREFIX, ctx->scratch, 4);
+		break;
+
+	case TX_PARSER_STATE_REF_BLOCK_PREFIX:
+		out->refBlockPrefix = (uint32_t) readLE(ctx->scratch, 4);
+		expectVaruint(ctx, TX_PARSER_STATE_MAX_NET_USAGE_WORDS);
+		break;
+
+	case TX_PARSER_STATE_MAX_CPU_USAGE_MS:
+		VALIDATE(ctx->scratch[0] == 0, ERR_INVALID_DATA);
+		expectVaruint(ctx, TX_PARSER_STATE_DELAY_SEC);
+		break;
+
+	case TX_PARSER_STATE_CONTRACT_ACCOUNT_NAME:
+		out->actionType = getActionTypeByContractAccountName(
+		                          ctx->network, out->contractAccountName, SIZEOF(out->contractAccountName)
+		                  );
+		// action data of unknown actions cannot be parsed,
+		// policyForSignTxActionHeader would deny them anyway
+		VALIDATE(out->actionType != ACTION_TYPE_UNKNOWN, ERR_REJECTED_BY_POLICY);
+		expectVaruint(ctx, TX_PARSER_STATE_NUM_AUTHORIZATIONS);
+		break;
+
+	case TX_PARSER_STATE_AUTHORIZATION_ACTOR:
+		uint8array_name_to_string(ctx->scratch, NAME_VAR_LENGTH, out->actionValidationActor, SIZEOF(out->actionValidationActor));
+		expectField(ctx, TX_PARSER_STATE_AUTHORIZATION_PERMISSION, ctx->scratch, NAME_VAR_LENGTH);
+		break;
+
+	case TX_PARSER_STATE_AUTHORIZATION_PERMISSION:
+		uint8array_name_to_string(ctx->scratch, NAME_VAR_LENGTH, out->actionValidationPermission, SIZEOF(out->actionValidationPermission));
+		expectVaruint(ctx, TX_PARSER_STATE_ACTION_DATA_LENGTH);
+		break;
+
+	case TX_PARSER_STATE_PUBKEY:
+		out->pubkey[ctx->fieldSize] = 0;
+		str_validateNullTerminatedTextBuffer((uint8_t*) out->pubkey, ctx->fieldSize);
+		expectField(ctx, TX_PARSER_STATE_AMOUNT, ctx->scratch, 8);
+		break;
+
+	case TX_PARSER_STATE_AMOUNT:
+		out->amount = readLE(ctx->scratch, 8);
+		expectField(ctx, TX_PARSER_STATE_MAX_FEE, ctx->scratch, 8);
+		break;
+
+	case TX_PARSER_STATE_MAX_FEE:
+		out->maxFee = readLE(ctx->scratch, 8);
+		expectField(ctx, TX_PARSER_STATE_DATA_ACTOR, ctx->scratch, NAME_VAR_LENGTH);
+		break;
+
+	case TX_PARSER_STATE_DATA_ACTOR:
+		uint8array_name_to_string(ctx->scratch, NAME_VAR_LENGTH, out->actionDataActor, SIZEOF(out->actionDataActor));
+		expectVaruint(ctx, TX_PARSER_STATE_TPID_LENGTH);
+		break;
+
+	case TX_PARSER_STATE_TPID:
+		// declared action data length has to match its content
+		VALIDATE(ctx->actionDataParsed == ctx->actionDataLength, ERR_INVALID_DATA);
+
+		ctx->actionComplete = true;
+		ASSERT(ctx->actionsRemaining > 0);
+		ctx->actionsRemaining--;
+		if (ctx->actionDataOnly) {
+			ctx->state = TX_PARSER_STATE_DONE;
+		} else if (ctx->actionsRemaining > 0) {
+			expectField(ctx, TX_PARSER_STATE_CONTRACT_ACCOUNT_NAME, out->contractAccountName, SIZEOF(out->contractAccountName));
+		} else {
+			expectVaruint(ctx, TX_PARSER_STATE_NUM_TRANSACTION_EXTENSIONS);
+		}
+		break;
+
+	default:
+		ASSERT(false);
+	}
+}
+
+void txParser_init(tx_parser_context_t* ctx, network_type_t network)
+{
+	explicit_bzero(ctx, SIZEOF(*ctx));
+	ctx->network = network;
+	expectField(ctx, TX_PARSER_STATE_EXPIRATION, ctx->scratch, 4);
+}
+
+void txParser_initActionData(tx_parser_context_t* ctx, network_type_t network, action_type_t actionType)
+{
+	// action data of unknown actions cannot be parsed
+	ASSERT(actionType != ACTION_TYPE_UNKNOWN);
+
+	explicit_bzero(ctx, SIZEOF(*ctx));
+	ctx->network = network;
+	ctx->actionDataOnly = true;
+	ctx->actionsRemaining = 1;
+	ctx->output.numActions = 1;
+	ctx->output.actionType = actionType;
+	expectVaruint(ctx, TX_PARSER_STATE_ACTION_DATA_LENGTH);
+}
+
+size_t txParser_process(tx_parser_context_t* ctx, const uint8_t* data, size_t dataSize)
+{
+	TRACE("Parsing %d bytes in state %d", (int) dataSize, ctx->state);
+
+	ctx->actionComplete = false;
+	size_t totalConsumed = 0;
+
+	while (dataSize > 0 && !ctx->actionComplete) {
+		// no trailing data allowed
+		VALIDATE(ctx->state != TX_PARSER_STATE_DONE, ERR_INVALID_DATA);
+
+		const tx_parser_state_t state = ctx->state;
+		size_t consumed = 0;
+		bool fieldComplete = false;
+
+		if (isVaruintState(state)) {
+			const uint8_t byte = data[0];
+			consumed = 1;
+			VALIDATE(ctx->varuintShift <= VARUINT32_MAX_SHIFT, ERR_INVALID_DATA);
+			// the last byte may only carry the remaining 4 bits
+			VALIDATE(ctx->varuintShift < VARUINT32_MAX_SHIFT || byte <= 0x0F, ERR_INVALID_DATA);
+			ctx->varuintValue |= ((uint32_t) (byte & 0x7F)) << ctx->varuintShift;
+			ctx->varuintShift += 7;
+			fieldComplete = (byte & 0x80) == 0;
+		} else {
+			ASSERT(ctx->fieldParsed < ctx->fieldSize);
+			const size_t missing = ctx->fieldSize - ctx->fieldParsed;
+			consumed = (dataSize < missing) ? dataSize : missing;
+			if (ctx->fieldBuffer != NULL) {
+				memcpy(ctx->fieldBuffer + ctx->fieldParsed, data, consumed);
+			} else {
+				str_validateTextBuffer(data, consumed);
+			}
+			ctx->fieldParsed += (uint32_t) consumed;
+			fieldComplete = ctx->fieldParsed == ctx->fieldSize;
+		}
+
+		if (isActionDataState(state)) {
+			ctx->actionDataParsed += consumed;
+			VALIDATE(ctx->actionDataParsed <= ctx->actionDataLength, ERR_INVALID_DATA);
+		}
+
+		data += consumed;
+		dataSize -= consumed;
+		totalConsumed += consumed;
+
+		if (fieldComplete) {
+			if (isVaruintState(state)) {
+				onVaruintParsed(ctx);
+			} else {
+				onFieldParsed(ctx);
+			}
+		}
+	}
+
+	return totalConsumed;
+}
+
+bool txParser_isActionComplete(const tx_parser_context_t* ctx)
+{
+	return ctx->actionComplete;
+}
+
+bool txParser_isDone(const tx_parser_context_t* ctx)
+{
+	return ctx->state == TX_PARSER_STATE_DONE;
+}
@@ -0,0 +1,107 @@
+#ifndef H_FIO_APP_TX_PARSER
+#define H_FIO_APP_TX_PARSER
+
+#include "common.h"
+#include "fio.h"
+
+// Streaming parser of canonical EOSIO packed_trx serialization.
+// The transaction may be fed in chunks split at arbitrary byte positions,
+// the parser keeps just enough state to resume in the middle of a field.
+// Only the fields needed for policy and UI are kept. Action fields are
+// valid only until the next action is parsed, so the parser pauses after
+// each action (see txParser_isActionComplete). Strings which are not
+// displayed (tpid) are only validated, so their length is not limited by RAM.
+
+typedef enum {
+	TX_PARSER_STATE_EXPIRATION = 1,
+	TX_PARSER_STATE_REF_BLOCK_NUM,
+	TX_PARSER_STATE_REF_BLOCK_PREFIX,
+	TX_PARSER_STATE_MAX_NET_USAGE_WORDS,
+	TX_PARSER_STATE_MAX_CPU_USAGE_MS,
+	TX_PARSER_STATE_DELAY_SEC,
+	TX_PARSER_STATE_NUM_CONTEXT_FREE_ACTIONS,
+	TX_PARSER_STATE_NUM_ACTIONS,
+	TX_PARSER_STATE_CONTRACT_ACCOUNT_NAME,
+	TX_PARSER_STATE_NUM_AUTHORIZATIONS,
+	TX_PARSER_STATE_AUTHORIZATION_ACTOR,
+	TX_PARSER_STATE_AUTHORIZATION_PERMISSION,
+	TX_PARSER_STATE_ACTION_DATA_LENGTH,
+	// action data of trnsfiopubky
+	TX_PARSER_STATE_PUBKEY_LENGTH,
+	TX_PARSER_STATE_PUBKEY,
+	TX_PARSER_STATE_AMOUNT,
+	TX_PARSER_STATE_MAX_FEE,
+	TX_PARSER_STATE_DATA_ACTOR,
+	TX_PARSER_STATE_TPID_LENGTH,
+	TX_PARSER_STATE_TPID,
+	// end of action data
+	TX_PARSER_STATE_NUM_TRANSACTION_EXTENSIONS,
+	TX_PARSER_STATE_DONE,
+} tx_parser_state_t;
+
+typedef struct {
+	uint32_t expiration;
+	uint16_t refBlockNum;
+	uint32_t refBlockPrefix;
+	uint8_t numActions;
+
+	// the last parsed action
+	uint8_t contractAccountName[CONTRACT_ACCOUNT_NAME_LENGTH];
+	action_type_t actionType;
+
+	char actionValidationActor[NAME_STRING_MAX_LENGTH];
+	char actionValidationPermission[NAME_STRING_MAX_LENGTH];
+
+	char pubkey[MAX_WIF_PUBKEY_LENGTH]; // null terminated
+	uint64_t amount;
+	uint64_t maxFee;
+	char actionDataActor[NAME_STRING_MAX_LENGTH];
+} tx_parser_output_t;
+
+typedef struct {
+	tx_parser_state_t state;
+	network_type_t network;
+
+	// only action data are parsed, see txParser_initActionData
+	bool actionDataOnly;
+
+	// fixed-size field being collected, NULL buffer for text which is only validated
+	uint8_t* fieldBuffer;
+	// a skipped tpid can be longer than 255 bytes
+	uint32_t fieldSize;
+	uint32_t fieldParsed;
+	uint8_t scratch[NAME_VAR_LENGTH]; // numbers and names are collected here
+
+	// varuint32 being collected
+	uint32_t varuintValue;
+	uint8_t varuintShift;
+
+	uint8_t actionsRemaining;
+	bool actionComplete;
+	uint32_t actionDataLength;
+	uint32_t actionDataParsed;
+
+	tx_parser_output_t output;
+} tx_parser_context_t;
+
+void txParser_init(tx_parser_context_t* ctx, network_type_t network);
+
+// Parses just the varuint32 length and data of a single action,
+// used when the rest of the transaction is sent field by field
+void txParser_initActionData(tx_parser_context_t* ctx, network_type_t network, action_type_t actionType);
+
+// Consumes the chunk until its end or until an action is completely parsed,
+// returns the number of bytes consumed.
+// Throws ERR_INVALID_DATA on malformed or unsupported transactions.
+size_t txParser_process(tx_parser_context_t* ctx, const uint8_t* data, size_t dataSize);
+
+// true if the last txParser_process call stopped after an action
+bool txParser_isActionComplete(const tx_parser_context_t* ctx);
+
+bool txParser_isDone(const tx_parser_context_t* ctx);
+
+#ifdef DEVEL
+void run_txParser_test();
+#endif // DEVEL
+
+#endif // H_FIO_APP_TX_PARSER
@@ -0,0 +1,238 @@
+#ifdef DEVEL
+
+#include "txParser.h"
+#include "hexUtils.h"
+#include "testUtils.h"
+#include "utils.h"
+
+#define TX_HEADER_HEX \
+	"1c312a61221166554433" /* expiration, ref block num, ref block prefix */ \
+	"00000000" /* max_net_usage_words, max_cpu_usage_ms, delay_sec, context_free_actions */
+
+// trnsfiopubky of 20 SUFs from aftyershcu22 with max fee 0x11223344 and tpid rewards@wallet
+#define TRANSFER_1_HEX \
+	"0000980ad20ca85be0e1d195ba85e7cd" /* fio.token trnsfiopubky */ \
+	"01" "2084460d5fe5f332" "00000000a8ed3232" /* one authorization, aftyershcu22@active */ \
+	"5d" /* action data length */ \
+	"35" "46494f385052653457525a4a6a356d6b656d367156474b79764e466750734e6e6a4e4e366b50686836456143707a4356696e354a6a" \
+	"1400000000000000" "4433221100000000" /* amount, max fee */ \
+	"2084460d5fe5f332" /* actor */ \
+	"0e" "726577617264734077616c6c6574" /* tpid */
+
+// trnsfiopubky of 30 SUFs with max fee 5 and empty tpid
+#define TRANSFER_2_HEX \
+	"0000980ad20ca85be0e1d195ba85e7cd" \
+	"01" "2084460d5fe5f332" "00000000a8ed3232" \
+	"4f" \
+	"35" "46494f385052653457525a4a6a356d6b656d367156474b79764e466750734e6e6a4e4e366b50686836456143707a4356696e354a6a" \
+	"1e00000000000000" "0500000000000000" \
+	"2084460d5fe5f332" \
+	"00"
+
+static const char* transferTxHex = TX_HEADER_HEX "01" TRANSFER_1_HEX "00";
+static const char* twoTransfersTxHex = TX_HEADER_HEX "02" TRANSFER_1_HEX TRANSFER_2_HEX "00";
+
+// parses the whole transaction, collects amounts of the parsed actions
+static size_t parseInChunks(
+        tx_parser_context_t* ctx,
+        const uint8_t* data, size_t dataSize, size_t chunkSize,
+        uint64_t* amounts, size_t maxAmounts
+)
+{
+	txParser_init(ctx, NETWORK_TESTNET);
+	size_t numActions = 0;
+	size_t offset = 0;
+	while (offset < dataSize) {
+		size_t size = dataSize - offset;
+		if (size > chunkSize) size = chunkSize;
+		// process the chunk, pausing after each action
+		while (size > 0) {
+			size_t consumed = txParser_process(ctx, data + offset, size);
+			offset += consumed;
+			size -= consumed;
+			if (txParser_isActionComplete(ctx)) {
+				ASSERT(numActions < maxAmounts);
+				amounts[numActions++] = ctx->output.amount;
+			}
+		}
+	}
+	return numActions;
+}
+
+static void testcase_transfer(size_t chunkSize)
+{
+	PRINTF("testcase_transfer chunk size %d\n", (int) chunkSize);
+
+	uint8_t tx[300];
+	size_t txSize = decode_hex(transferTxHex, tx, SIZEOF(tx));
+
+	tx_parser_context_t ctx;
+	uint64_t amounts[MAX_TX_ACTIONS];
+	EXPECT_EQ(parseInChunks(&ctx, tx, txSize, chunkSize, amounts, ARRAY_LEN(amounts)), 1);
+	EXPECT_EQ(txParser_isDone(&ctx), true);
+
+	const tx_parser_output_t* out = &ctx.output;
+	EXPECT_EQ(out->expiration, 1630155036);
+	EXPECT_EQ(out->refBlockNum, 0x1122);
+	EXPECT_EQ(out->refBlockPrefix, 0x33445566);
+	EXPECT_EQ(out->numActions, 1);
+	EXPECT_EQ(out->actionType, ACTION_TYPE_TRNSFIOPUBKY);
+	EXPECT_EQ(strcmp(out->actionValidationActor, "aftyershcu22"), 0);
+	EXPECT_EQ(strcmp(out->actionValidationPermission, "active"), 0);
+	EXPECT_EQ(strcmp(out->pubkey, "FIO8PRe4WRZJj5mkem6qVGKyvNFgPsNnjNN6kPhh6EaCpzCVin5Jj"), 0);
+	EXPECT_EQ(out->amount, 20);
+	EXPECT_EQ(out->maxFee, 0x11223344);
+	EXPECT_EQ(strcmp(out->actionDataActor, "aftyershcu22"), 0);
+}
+
+static void testcase_twoTransfers(size_t chunkSize)
+{
+	PRINTF("testcase_twoTransfers chunk size %d\n", (int) chunkSize);
+
+	uint8_t tx[300];
+	size_t txSize = decode_hex(twoTransfersTxHex, tx, SIZEOF(tx));
+
+	tx_parser_context_t ctx;
+	uint64_t amounts[MAX_TX_ACTIONS];
+	EXPECT_EQ(parseInChunks(&ctx, tx, txSize, chunkSize, amounts, ARRAY_LEN(amounts)), 2);
+	EXPECT_EQ(txParser_isDone(&ctx), true);
+
+	EXPECT_EQ(ctx.output.numActions, 2);
+	EXPECT_EQ(amounts[0], 20);
+	EXPECT_EQ(amounts[1], 30);
+	// fields of the last action are kept
+	EXPECT_EQ(ctx.output.maxFee, 5);
+}
+
+// varuint32 length and data of trnsfiopubky with tpid of the given length
+static size_t writeVaruint(uint8_t* buffer, size_t bufferSize, size_t value)
+{
+	size_t size = 0;
+	do {
+		ASSERT(size < bufferSize);
+		buffer[size] = (uint8_t) (value & 0x7F);
+		value >>= 7;
+		if (value > 0) buffer[size] |= 0x80;
+		size++;
+	} while (value > 0);
+	return size;
+}
+
+static size_t buildTransferActionData(uint8_t* buffer, size_t bufferSize, size_t tpidLength, uint8_t tpidChar)
+{
+	uint8_t data[400];
+	size_t dataSize = decode_hex(
+	                          "35" "46494f385052653457525a4a6a356d6b656d367156474b79764e466750734e6e6a4e4e366b50686836456143707a4356696e354a6a"
+	                          "1400000000000000" "4433221100000000" "2084460d5fe5f332",
+	                          data, SIZEOF(data)
+	                  );
+	// tpids of 128 bytes and more need a two-byte length
+	dataSize += writeVaruint(data + dataSize, SIZEOF(data) - dataSize, tpidLength);
+	ASSERT(dataSize + tpidLength <= SIZEOF(data));
+	memset(data + dataSize, tpidChar, tpidLength);
+	dataSize += tpidLength;
+
+	size_t size = writeVaruint(buffer, bufferSize, dataSize);
+	ASSERT(size + dataSize <= bufferSize);
+	memcpy(buffer + size, data, dataSize);
+	return size + dataSize;
+}
+
+static void testcase_actionData(size_t tpidLength, uint8_t tpidChar, size_t chunkSize)
+{
+	PRINTF("testcase_actionData tpid length %d chunk size %d\n", (int) tpidLength, (int) chunkSize);
+
+	uint8_t data[450];
+	size_t dataSize = buildTransferActionData(data, SIZEOF(data), tpidLength, tpidChar);
+
+	tx_parser_context_t ctx;
+	txParser_initActionData(&ctx, NETWORK_MAINNET, ACTION_TYPE_TRNSFIOPUBKY);
+	for (size_t offset = 0; offset < dataSize; offset += chunkSize) {
+		size_t size = dataSize - offset;
+		if (size > chunkSize) size = chunkSize;
+		EXPECT_EQ(txParser_process(&ctx, data + offset, size), size);
+	}
+	EXPECT_EQ(txParser_isActionComplete(&ctx), true);
+	EXPECT_EQ(txParser_isDone(&ctx), true);
+	EXPECT_EQ(ctx.output.amount, 20);
+	EXPECT_EQ(ctx.output.maxFee, 0x11223344);
+	EXPECT_EQ(strcmp(ctx.output.pubkey, "FIO8PRe4WRZJj5mkem6qVGKyvNFgPsNnjNN6kPhh6EaCpzCVin5Jj"), 0);
+}
+
+static void test_actionData()
+{
+	testcase_actionData(0, 'a', 255);
+	testcase_actionData(14, 'a', 1);
+	// longer than any displayed string
+	testcase_actionData(120, 'a', 255);
+	testcase_actionData(120, 'a', 5);
+	testcase_actionData(128, 'a', 255);
+	// longer than a single APDU
+	testcase_actionData(256, 'a', 255);
+	testcase_actionData(300, 'a', 7);
+
+	EXPECT_THROWS(testcase_actionData(10, 0x07, 255), ERR_INVALID_DATA);
+}
+
+static void testcase_invalid(size_t offset, uint8_t value, uint16_t expectedError)
+{
+	PRINTF("testcase_invalid byte %d\n", (int) offset);
+
+	uint8_t tx[300];
+	size_t txSize = decode_hex(transferTxHex, tx, SIZEOF(tx));
+	ASSERT(offset < txSize);
+	tx[offset] = value;
+
+	tx_parser_context_t ctx;
+	uint64_t amounts[MAX_TX_ACTIONS];
+	EXPECT_THROWS(parseInChunks(&ctx, tx, txSize, 7, amounts, ARRAY_LEN(amounts)), expectedError);
+}
+
+static void test_invalidTransactions()
+{
+	testcase_invalid(10, 0x01, ERR_INVALID_DATA); // max_net_usage_words
+	testcase_invalid(14, 0x00, ERR_INVALID_DATA); // no actions
+	testcase_invalid(14, MAX_TX_ACTIONS + 1, ERR_INVALID_DATA);
+	testcase_invalid(15, 0x01, ERR_REJECTED_BY_POLICY); // unknown contract
+	testcase_invalid(48, 0x5e, ERR_INVALID_DATA); // action data length mismatch
+	testcase_invalid(49, 0x40, ERR_INVALID_DATA); // pubkey too long
+	testcase_invalid(50, 0x07, ERR_INVALID_DATA); // non-printable pubkey
+
+	{
+		PRINTF("testcase_trailingData\n");
+		uint8_t tx[300];
+		size_t txSize = decode_hex(transferTxHex, tx, SIZEOF(tx));
+		tx_parser_context_t ctx;
+		uint64_t amounts[MAX_TX_ACTIONS];
+		EXPECT_THROWS(parseInChunks(&ctx, tx, txSize + 1, 255, amounts, ARRAY_LEN(amounts)), ERR_INVALID_DATA);
+	}
+	{
+		PRINTF("testcase_truncated\n");
+		uint8_t tx[300];
+		size_t txSize = decode_hex(transferTxHex, tx, SIZEOF(tx));
+		tx_parser_context_t ctx;
+		uint64_t amounts[MAX_TX_ACTIONS];
+		parseInChunks(&ctx, tx, txSize - 1, 255, amounts, ARRAY_LEN(amounts));
+		EXPECT_EQ(txParser_isDone(&ctx), false);
+	}
+}
+
+void run_txParser_test()
+{
+	PRINTF("Running tx parser tests\n");
+
+	testcase_transfer(255);
+	testcase_transfer(1);
+	testcase_transfer(3);
+	testcase_transfer(64);
+
+	testcase_twoTransfers(255);
+	testcase_twoTransfers(1);
+	testcase_twoTransfers(13);
+
+	test_actionData();
+
+	test_invalidTransactions();
+}
+
+#endif // DEVEL
@@ -4,6 +4,7 @@
 #include "uiElements.h"
 #include "assert.h"
 #include "io.h"
+#include "profiler.h"
 #include "utils.h"
 //#include "securityPolicy.h"
 
@@ -43,6 +44,7 @@ void uiCallback_confirm(ui_callback_t* cb)
 	case CALLBACK_NOT_RUN:
 		// Note: needs to be done before resolving in case it throws
 		cb->state = CALLBACK_RUN;
+		PROFILE_END(PROFILE_PHASE_UI, 1);
 		cb->confirm();
 		break;
 	case CALLBACK_RUN:
@@ -61,6 +63,7 @@ void uiCallback_reject(ui_callback_t* cb)
 	case CALLBACK_NOT_RUN:
 		// Note: needs to be done before resolving in case it throws
 		cb->state = CALLBACK_RUN;
+		PROFILE_END(PROFILE_PHASE_UI, 0);
 		cb->reject();
 		break;
 	case CALLBACK_RUN:
@@ -74,6 +77,9 @@ void uiCallback_reject(ui_callback_t* cb)
 #ifdef HEADLESS
 static int HEADLESS_DELAY = 20;
 
+// confirm by default so that unattended test flows run without the INS below
+static headless_interaction_t headlessInteraction = HEADLESS_INTERACTION_CONFIRM;
+
 void ui_displayPrompt_headless_cb(bool ux_allowed)
 {
 	TRACE("HEADLESS response");
@@ -85,12 +91,20 @@ void ui_displayPrompt_headless_cb(bool ux_allowed)
 		assert_uiPrompt_magic();
 		ASSERT(io_state == IO_EXPECT_UI);
 		ASSERT(device_is_unlocked() == true);
-		uiCallback_confirm(&promptState->callback);
+		ASSERT(promptState->headlessShouldRespond);
+		if (headlessInteraction == HEADLESS_INTERACTION_REJECT && promptState->callback.reject) {
+			uiCallback_reject(&promptState->callback);
+		} else {
+			uiCallback_confirm(&promptState->callback);
+		}
 	})
 }
 
-void autoconfirmPrompt()
+static void autorespondPrompt()
 {
+	if (headlessInteraction == HEADLESS_INTERACTION_MANUAL) return;
+	promptState->headlessShouldRespond = true;
+
 	#if defined(TARGET_NANOS)
 	nanos_set_timer(HEADLESS_DELAY, ui_displayPrompt_headless_cb);
 	#elif defined(TARGET_NANOX)
@@ -109,12 +123,17 @@ void ui_displayPaginatedText_headless_cb(bool ux_allowed)
 		assert_uiPaginatedText_magic();
 		ASSERT(io_state == IO_EXPECT_UI);
 		ASSERT(device_is_unlocked() == true);
+		ASSERT(paginatedTextState->headlessShouldRespond);
+		// there is nothing to reject here, the text is always confirmed
 		uiCallback_confirm(&paginatedTextState->callback);
 	});
 }
 
-void autoconfirmPaginatedText()
+static void autorespondPaginatedText()
 {
+	if (headlessInteraction == HEADLESS_INTERACTION_MANUAL) return;
+	paginatedTextState->headlessShouldRespond = true;
+
 	#if defined(TARGET_NANOS)
 	nanos_set_timer(HEADLESS_DELAY, ui_displayPaginatedText_headless_cb);
 	#elif defined(TARGET_NANOX)
@@ -122,6 +141,34 @@ void autoconfirmPaginatedText()
 	#endif
 }
 
+#ifdef DEVEL
+void ui_handleSetHeadlessInteractionAPDU(
+        uint8_t p1,
+        uint8_t p2,
+        uint8_t *wireDataBuffer MARK_UNUSED,
+        size_t wireDataSize,
+        bool isNewCall MARK_UNUSED
+)
+{
+	VALIDATE(p2 == P2_UNUSED, ERR_INVALID_REQUEST_PARAMETERS);
+	VALIDATE(wireDataSize == 0, ERR_INVALID_REQUEST_PARAMETERS);
+
+	switch (p1) {
+	case HEADLESS_INTERACTION_MANUAL:
+	case HEADLESS_INTERACTION_CONFIRM:
+	case HEADLESS_INTERACTION_REJECT:
+		headlessInteraction = (headless_interaction_t) p1;
+		break;
+	default:
+		THROW(ERR_INVALID_REQUEST_PARAMETERS);
+	}
+	TRACE("Headless interaction %d", (int) headlessInteraction);
+
+	io_send_buf(SUCCESS, NULL, 0);
+	ui_idle();
+}
+#endif // DEVEL
+
 #endif // HEADLESS
 
 static void uiCallback_init(ui_callback_t* cb, ui_callback_fn_t* confirm, ui_callback_fn_t* reject)
@@ -138,6 +185,7 @@ void ui_displayPrompt(
         ui_callback_fn_t* reject)
 {
 	TRACE_STACK_USAGE();
+	PROFILE_BEGIN(PROFILE_PHASE_UI);
 	TRACE("%s", headerStr);
 	TRACE("%s", bodyStr);
 
@@ -164,7 +212,7 @@ void ui_displayPrompt(
 
 	#ifdef HEADLESS
 	if (confirm) {
-		autoconfirmPrompt();
+		autorespondPrompt();
 	}
 	#endif // HEADLESS
 }
@@ -175,6 +223,7 @@ void ui_displayPaginatedText(
         ui_callback_fn_t* callback)
 {
 	TRACE_STACK_USAGE();
+	PROFILE_BEGIN(PROFILE_PHASE_UI);
 	TRACE("%s", headerStr);
 	TRACE("%s", bodyStr);
 
@@ -211,7 +260,7 @@ void ui_displayPaginatedText(
 
 	#ifdef HEADLESS
 	if (callback) {
-		autoconfirmPaginatedText();
+		autorespondPaginatedText();
 	}
 	#endif // HEADLESS
 }
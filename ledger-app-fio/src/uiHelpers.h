@@ -7,6 +7,7 @@
 #include <ux.h>
 
 #include "utils.h"
+#include "handlers.h"
 
 typedef void ui_callback_fn_t();
 
@@ -98,6 +99,20 @@ typedef struct {
 	#endif
 } promptState_t;
 
+#ifdef HEADLESS
+// How prompts and paginated texts are answered without the buttons.
+// Paginated texts are confirmed in both automatic modes.
+typedef enum {
+	HEADLESS_INTERACTION_MANUAL = 0x00,
+	HEADLESS_INTERACTION_CONFIRM = 0x01,
+	HEADLESS_INTERACTION_REJECT = 0x02,
+} headless_interaction_t;
+
+#ifdef DEVEL
+handler_fn_t ui_handleSetHeadlessInteractionAPDU;
+#endif // DEVEL
+#endif // HEADLESS
+
 typedef union {
 	paginatedTextState_t paginatedText;
 	promptState_t prompt;
@@ -139,8 +154,9 @@ extern displayState_t displayState;
 // WARNING(ppershing): Following two references MUST be declared `static`
 // otherwise the Ledger will crash. I am really not sure why is this
 // but it might be related to position-independent-code compilation.
-static paginatedTextState_t* paginatedTextState = &(displayState.paginatedText);
-static promptState_t* promptState = &(displayState.prompt);
+// Not every includer uses them, hence `unused`.
+static __attribute__((unused)) paginatedTextState_t* paginatedTextState = &(displayState.paginatedText);
+static __attribute__((unused)) promptState_t* promptState = &(displayState.prompt);
 
 enum {
 	INIT_MAGIC_PAGINATED_TEXT = 2345,
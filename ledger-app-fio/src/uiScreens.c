@@ -1,7 +1,6 @@
 #include "uiScreens.h"
 #include "hexUtils.h"
 #include "textUtils.h"
-#include "eos_utils.h"
 #include "fio.h"
 
 __noinline_due_to_stack__
@@ -87,21 +86,19 @@ void ui_displayHexBufferScreen(
 __noinline_due_to_stack__
 void ui_displayPubkeyScreen(
         const char* screenHeader,
-        const public_key_t* pubkey,
+        const char* pubkeyWif,
         ui_callback_fn_t callback
 )
 {
 	ASSERT(strlen(screenHeader) > 0);
 	ASSERT(strlen(screenHeader) < BUFFER_SIZE_PARANOIA);
-    
-	char buffer[MAX_WIF_PUBKEY_LENGTH + 1];
-	uint32_t outlen = public_key_to_wif(pubkey->W, SIZEOF(pubkey->W), buffer, SIZEOF(buffer));
-	ASSERT(outlen < MAX_WIF_PUBKEY_LENGTH + 1);
-	buffer[outlen] = 0;
+	// the WIF is computed once by the caller when the key gets derived
+	ASSERT(strlen(pubkeyWif) > 0);
+	ASSERT(strlen(pubkeyWif) < MAX_WIF_PUBKEY_LENGTH);
 
 	ui_displayPaginatedText(
 	        screenHeader,
-	        buffer,
+	        pubkeyWif,
 	        callback
 	);
 }
@@ -36,7 +36,7 @@ void ui_displayHexBufferScreen(
 __noinline_due_to_stack__
 void ui_displayPubkeyScreen(
         const char* screenHeader,
-        const public_key_t* pubkey,
+        const char* pubkeyWif,
         ui_callback_fn_t callback
 );
 
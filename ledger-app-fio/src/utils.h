@@ -16,11 +16,19 @@
 #define ARRAY_LEN(arr) \
 	(sizeof(arr) / sizeof((arr)[0]) + ARRAY_NOT_A_PTR(arr))
 
+// The host build (see host/) checks against the 32-bit pointers of the device
+// so that it accepts exactly what the device build accepts
+#ifdef FIO_HOST
+#define DEVICE_POINTER_SIZE 4
+#else
+#define DEVICE_POINTER_SIZE sizeof((void *)0)
+#endif
+
 // Does not compile if x *might* be a pointer of some kind
 // Might produce false positives on small structs...
 // Note: ARRAY_NOT_A_PTR does not compile if arg is a struct so this is a workaround
 #define SIZEOF_NOT_A_PTR(var) \
-	(sizeof(__typeof(int[0 - (sizeof(var) == sizeof((void *)0))])) * 0)
+	(sizeof(__typeof(int[0 - (sizeof(var) == DEVICE_POINTER_SIZE)])) * 0)
 
 // Safe version of SIZEOF, does not compile if you accidentally supply a pointer
 #define SIZEOF(var) \
@@ -93,6 +101,7 @@
 // The output of 'arm-none-eabi-objdump -d -S bin/app.elf'
 // gives more accurate info on the stack frames of individual function calls.
 // (Watch for lines like 'sub sp, #508' close to function headers.)
+// stackUsage.h measures the deepest use of each instruction (INS 0xF5).
 
 // Another thing to check is the output of 'objdump -x app.elf'.
 // There are two important lines, looking like
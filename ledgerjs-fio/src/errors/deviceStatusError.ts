@@ -5,7 +5,10 @@ import {ErrorBase} from "./errorBase"
  * @category Errors
  */
 export const DeviceStatusCodes = {
+    ERR_BAD_CLA: 0x6e02 as const,
+    ERR_UNKNOWN_INS: 0x6e03 as const,
     ERR_STILL_IN_CALL: 0x6e04 as const, // internal
+    ERR_INVALID_STATE: 0x6e06 as const,
     ERR_INVALID_DATA: 0x6e07 as const,
     ERR_REJECTED_BY_USER: 0x6e09 as const,
     ERR_REJECTED_BY_POLICY: 0x6e10 as const,
@@ -1,5 +1,6 @@
 export {ErrorBase} from './errorBase'
 export {InvalidData} from './invalidData'
 export {DeviceVersionUnsupported} from './deviceUnsupported'
+export {NoDeviceAvailable} from './noDeviceAvailable'
 export {DeviceStatusCodes, DeviceStatusError} from './deviceStatusError'
 export {InvalidDataReason} from './invalidDataReason'
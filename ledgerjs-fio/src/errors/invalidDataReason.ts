@@ -4,10 +4,12 @@
  */
 export enum InvalidDataReason {
     GET_PUB_KEY_PATH_IS_NOT_ARRAY = "ext pub key path is not an array",
+    GET_PUB_KEYS_INVALID_COUNT = "invalid number of public keys",
+    INVALID_ACCOUNT_PUBLIC_KEY = "invalid account public key",
     INVALID_CHAIN_ID = "invalid chain id",
     INVALID_PATH = "invalid path",
     CONTEXT_FREE_ACTIONS_NOT_SUPPORTED = "context free actions not supported",
-    MULTIPLE_ACTIONS_NOT_SUPPORTED = "multiple actions not supported",
+    INVALID_NUMBER_OF_ACTIONS = "invalid number of actions",
     ACTION_NOT_SUPPORTED = "action not suported",
     INVALID_ACCOUNT = "invalid account",
     INVALID_NAME = "invalid name",
@@ -22,5 +24,9 @@ export enum InvalidDataReason {
     INVALID_TPID = "invalid tpid",
     INVALID_ACTOR = "invalid actor",
     INVALID_PERMISSION = "invalid permission",
-    ACTION_DATA_TOO_LONG = "action data too long",
+    INVALID_SPENDING_CAP = "invalid spending cap",
+    INVALID_SESSION_LIFETIME = "invalid session lifetime",
+    INVALID_NUMBER_OF_PAYEES = "invalid number of payees",
+    INVALID_BENCHMARK_KERNEL = "invalid benchmark kernel",
+    INVALID_BENCHMARK_ITERATIONS = "invalid number of benchmark iterations",
 }
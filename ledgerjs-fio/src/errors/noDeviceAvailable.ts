@@ -0,0 +1,11 @@
+import {ErrorBase} from "./errorBase"
+
+/**
+ * Thrown by [[FioPool]] when no healthy device can serve a request
+ * @category Errors
+ */
+export class NoDeviceAvailable extends ErrorBase {
+    public constructor(reason: string) {
+        super(reason)
+    }
+}
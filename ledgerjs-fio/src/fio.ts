@@ -15,25 +15,56 @@
  *  limitations under the License.
  ********************************************************************************/
 import type Transport from "@ledgerhq/hw-transport"
+import {TransportError} from "@ledgerhq/hw-transport"
 
 import {DeviceStatusCodes, DeviceStatusError, InvalidDataReason} from './errors'
+import {benchmark} from "./interactions/benchmark"
 import type {Interaction, SendParams} from './interactions/common/types'
-import {getPublicKey} from "./interactions/getPublicKey"
+import {getAccountPublicKey} from "./interactions/getAccountPublicKey"
+import {getProfile} from "./interactions/getProfile"
+import {getPublicKey, getPublicKeysInit, getPublicKeysNext} from "./interactions/getPublicKey"
 import {getSerial} from "./interactions/getSerial"
+import {getStackUsage} from "./interactions/getStackUsage"
 import {getCompatibility, getVersion} from "./interactions/getVersion"
 import {runTests} from "./interactions/runTests"
-import {signTransaction} from "./interactions/signTransaction"
-import type {HexString, ParsedTransaction, ValidBIP32Path} from './types/internal'
-import type {BIP32Path, DeviceCompatibility, Serial, SignedTransactionData, Transaction, Version} from './types/public'
+import {setHeadlessInteraction} from "./interactions/setHeadlessInteraction"
+import {endSigningSession, getSigningSessionStatus, startSigningSession} from "./interactions/signingSession"
+import {getSignTransactionTemplate, signTemplateTransaction, signTransaction} from "./interactions/signTransaction"
+import type {HexString, ParsedSigningSession, ParsedTransaction, Uint32_t, ValidBIP32Path} from './types/internal'
+import {MAX_BENCHMARK_ITERATIONS, MAX_PUBLIC_KEYS} from './types/internal'
+import type {
+    AccountPublicKey,
+    bigint_like,
+    BIP32Path,
+    DeviceCompatibility,
+    HeadlessInteraction,
+    Profile,
+    Serial,
+    SignedTransactionData,
+    SigningSessionStatus,
+    StackUsage,
+    Transaction,
+    Version,
+} from './types/public'
+import {BenchmarkKernel, HARDENED} from './types/public'
 import {stripRetcodeFromResponse} from "./utils"
 import {assert} from './utils/assert'
-import {isArray, parseBIP32Path, parseHexString, parseTransaction, validate} from './utils/parse'
+import {isArray, isUint32, parseBIP32Path, parseHexString, parseSigningSession, parseTransaction, validate} from './utils/parse'
 
 export * from './errors'
 export * from './types/public'
+export {PublicKeyDeriver} from './utils/keyDerivation'
+export {FioPool} from './pool'
+export type {FioPoolOptions, PoolDeviceStats, PoolRouting} from './pool'
 
 const CLA = 0xd7
 
+const APP_CHANGED_CODES: number[] = [
+    DeviceStatusCodes.ERR_CLA_NOT_SUPPORTED,
+    DeviceStatusCodes.ERR_BAD_CLA,
+    DeviceStatusCodes.ERR_UNKNOWN_INS,
+]
+
 function wrapConvertDeviceStatusError<T extends Function>(fn: T): T {
     // @ts-ignore
     return async (...args) => {
@@ -86,8 +117,36 @@ function wrapRetryStillInCall<T extends Function>(fn: T): T {
     }
 }
 
+// If the link drops after the device sent the final response of a call
+// (e.g. a signature) but before we read it, repeating the call would make
+// the user confirm it again. Such requests carry a way to fetch the response
+// the device kept instead. If it cannot be fetched, the original error is thrown.
+function wrapRecoverLostResponse(send: SendFn): SendFn {
+    return async (params: SendParams) => {
+        try {
+            return await send(params)
+        } catch (e: any) {
+            // the device responded with an error, nothing got lost
+            if (!params.recover || e instanceof DeviceStatusError) throw e
+            try {
+                return await interact(params.recover(), send)
+            } catch {
+                throw e
+            }
+        }
+    }
+}
+
+// Held by an async iterator from its first call until it finishes
+type IteratorLock = {name: string}
 
-async function interact<T>(
+// the same error as thrown by the transport when it is locked
+function deviceBusyError(lockName: string): TransportError {
+    return new TransportError(`Ledger Device is busy (lock ${lockName})`, "TransportLocked")
+}
+
+/** @ignore */
+export async function interact<T>(
     interaction: Interaction<T>,
     send: SendFn,
 ): Promise<T> {
@@ -97,7 +156,7 @@ async function interact<T>(
         const apdu = cursor.value
         const res = first
             ? await wrapRetryStillInCall(send)(apdu)
-            : await send(apdu)
+            : await wrapRecoverLostResponse(send)(apdu)
         first = false
         cursor = interaction.next(res)
     }
@@ -113,6 +172,14 @@ export class Fio {
     transport: Transport<string>;
     /** @ignore */
     _send: SendFn;
+    /** @ignore template declared on the device by the last successful signing */
+    _signTxTemplate: string | null = null;
+    /** @ignore version of the app, kept until the transport disconnects or the app changes */
+    _version: Version | null = null;
+    /** @ignore async iterator which holds the device between its calls, see getPublicKeys */
+    _iteratorLock: IteratorLock | null = null;
+    /** @ignore */
+    _sendUnlocked: SendFn;
 
     constructor(transport: Transport<string>, scrambleKey: string = "FIO") {
         this.transport = transport
@@ -121,17 +188,38 @@ export class Fio {
             "getVersion",
             "getSerial",
             "getPublicKey",
+            "getAccountPublicKey",
             "signTransaction",
+            "startSigningSession",
+            "getSigningSessionStatus",
+            "endSigningSession",
+            "setHeadlessInteraction",
+            "benchmark",
+            "getProfile",
+            "getStackUsage",
+            "_sendFromIterator",
         ]
         this.transport.decorateAppAPIMethods(this, methods, scrambleKey)
-        this._send = async (params: SendParams): Promise<Buffer> => {
-            let response = await wrapConvertDeviceStatusError(this.transport.send)(
-                CLA,
-                params.ins,
-                params.p1,
-                params.p2,
-                params.data,
-            )
+        this.transport.on("disconnect", () => {
+            this._version = null
+        })
+        this._sendUnlocked = async (params: SendParams): Promise<Buffer> => {
+            let response
+            try {
+                response = await wrapConvertDeviceStatusError(this.transport.send)(
+                    CLA,
+                    params.ins,
+                    params.p1,
+                    params.p2,
+                    params.data,
+                )
+            } catch (e) {
+                // another app (or another version of this one) is running now
+                if (e instanceof DeviceStatusError && APP_CHANGED_CODES.includes(e.code)) {
+                    this._version = null
+                }
+                throw e
+            }
             response = stripRetcodeFromResponse(response)
 
             if (params.expectedResponseLength != null) {
@@ -143,10 +231,16 @@ export class Fio {
 
             return response
         }
+        this._send = async (params: SendParams): Promise<Buffer> => {
+            if (this._iteratorLock) throw deviceBusyError(this._iteratorLock.name)
+            return this._sendUnlocked(params)
+        }
     }
 
     /**
      * Returns an object containing the app version.
+     * Always asks the device, the other calls reuse the version it returns
+     * until the transport disconnects or another app is opened.
      *
      * @returns Result object containing the application version number.
      *
@@ -162,7 +256,15 @@ export class Fio {
 
     /** @ignore */
     * _getVersion(): Interaction<Version> {
-        return yield* getVersion()
+        this._version = null
+        return yield* this._getCachedVersion()
+    }
+
+    /** @ignore */
+    * _getCachedVersion(): Interaction<Version> {
+        const version = this._version ?? (yield* getVersion())
+        this._version = version
+        return version
     }
 
     /**
@@ -181,7 +283,7 @@ export class Fio {
 
     /** @ignore */
     * _getSerial(): Interaction<GetSerialResponse> {
-        const version = yield* getVersion()
+        const version = yield* this._getCachedVersion()
         return yield* getSerial(version)
     }
 
@@ -209,10 +311,106 @@ export class Fio {
 
     /** @ignore */
     * _getPublicKey(path: ValidBIP32Path, show_or_not: boolean) {
-        const version = yield* getVersion()
+        const version = yield* this._getCachedVersion()
         return yield* getPublicKey(version, path, show_or_not)
     }
 
+    /**
+     * Get public key and chain code of the account node `44'/235'/0'`.
+     * Use [[PublicKeyDeriver]] to derive address keys from it locally.
+     *
+     * @returns The account public key.
+     *
+     * @example
+     * ```
+     * const accountKey = await fio.getAccountPublicKey({path: [ HARDENED + 44, HARDENED + 235, HARDENED + 0 ]});
+     * const deriver = new PublicKeyDeriver(accountKey);
+     * console.log(deriver.deriveAddressKey(0, 0).publicKeyWIF);
+     * ```
+     * @see [[GetAccountPublicKeyRequest]]
+     */
+    async getAccountPublicKey(
+        {path}: GetAccountPublicKeyRequest
+    ): Promise<GetAccountPublicKeyResponse> {
+        // validate the input
+        validate(isArray(path), InvalidDataReason.GET_PUB_KEY_PATH_IS_NOT_ARRAY)
+        const parsedPath = parseBIP32Path(path, InvalidDataReason.INVALID_PATH)
+
+        return interact(this._getAccountPublicKey(parsedPath), this._send)
+    }
+
+    /** @ignore */
+    * _getAccountPublicKey(path: ValidBIP32Path) {
+        const version = yield* this._getCachedVersion()
+        return yield* getAccountPublicKey(version, path)
+    }
+
+    /**
+     * Get compressed public keys for `count` consecutive addresses, starting at the specified BIP 32 path.
+     * Keys are fetched from the device in chunks as the iterator is consumed.
+     *
+     * The other methods fail with `TransportLocked` until the iterator finishes. If the iteration is
+     * abandoned early, the device gets reset by the next call.
+     *
+     * @returns Async iterator over the exported keys.
+     *
+     * @example
+     * ```
+     * for await (const {path, publicKeyHex} of fio.getPublicKeys({path: [ HARDENED + 44, HARDENED + 235, HARDENED + 0, 0, 0 ], count: 20})) {
+     *     console.log(path, publicKeyHex);
+     * }
+     * ```
+     * @see [[GetPublicKeysRequest]]
+     */
+    async* getPublicKeys(
+        {path, count}: GetPublicKeysRequest
+    ): AsyncGenerator<GetPublicKeysItem, void, undefined> {
+        // validate the input
+        validate(isArray(path), InvalidDataReason.GET_PUB_KEY_PATH_IS_NOT_ARRAY)
+        const parsedPath = parseBIP32Path(path, InvalidDataReason.INVALID_PATH)
+        validate(parsedPath.length > 0, InvalidDataReason.INVALID_PATH)
+        validate(isUint32(count) && count > 0 && count <= MAX_PUBLIC_KEYS, InvalidDataReason.GET_PUB_KEYS_INVALID_COUNT)
+        const firstAddress = parsedPath[parsedPath.length - 1]
+        // the same check as policyForGetPublicKeysBatch, the last address must not be hardened
+        validate(firstAddress + count <= HARDENED, InvalidDataReason.GET_PUB_KEYS_INVALID_COUNT)
+
+        // decorateAppAPIMethods cannot wrap async generators, so each call is locked on its own
+        // and the other methods are kept out in between
+        const lock: IteratorLock = {name: "getPublicKeys"}
+        const send = (params: SendParams) => this._sendFromIterator(lock, params)
+        try {
+            let received = 0
+            let chunk = await interact(this._getPublicKeysInit(parsedPath, count), send)
+            for (;;) {
+                for (const publicKeyHex of chunk) {
+                    yield {
+                        path: [...parsedPath.slice(0, -1), firstAddress + received],
+                        publicKeyHex,
+                    }
+                    received++
+                }
+                if (received >= count) break
+                chunk = await interact(getPublicKeysNext(count - received), send)
+            }
+        } finally {
+            if (this._iteratorLock === lock) this._iteratorLock = null
+        }
+    }
+
+    /** @ignore */
+    * _getPublicKeysInit(path: ValidBIP32Path, count: Uint32_t) {
+        const version = yield* this._getCachedVersion()
+        return yield* getPublicKeysInit(version, path, count)
+    }
+
+    /** @ignore */
+    async _sendFromIterator(lock: IteratorLock, params: SendParams): Promise<Buffer> {
+        // runs under the transport lock, so no other method is in the middle of its calls
+        if (this._iteratorLock && this._iteratorLock !== lock) throw deviceBusyError(this._iteratorLock.name)
+        this._iteratorLock = lock
+        return this._sendUnlocked(params)
+    }
+
     /**
      * Sign transaction.
      *
@@ -230,13 +428,93 @@ export class Fio {
         const parsedChainId = parseHexString(chainId, InvalidDataReason.INVALID_CHAIN_ID)
         const parsedPath = parseBIP32Path(path, InvalidDataReason.INVALID_PATH)
         const parsedTx = parseTransaction(parsedChainId, tx)
-        return interact(this._signTransaction(parsedPath, parsedChainId, parsedTx), this._send)
+        const usedDeclaredTemplate = this._signTxTemplate != null
+        const sign = (outsideSession: boolean) =>
+            interact(this._signTransaction(parsedPath, parsedChainId, parsedTx, outsideSession), this._send)
+        try {
+            return await sign(false)
+        } catch (e) {
+            if (!(e instanceof DeviceStatusError)) throw e
+            // the device lost the template (app restarted), the retry declares it again
+            if (usedDeclaredTemplate && e.code === DeviceStatusCodes.ERR_INVALID_STATE) {
+                return sign(false)
+            }
+            // a transaction the signing session does not cover is confirmed by the user instead
+            if (e.code === DeviceStatusCodes.ERR_REJECTED_BY_POLICY && await this._isSigningSessionActive()) {
+                return sign(true)
+            }
+            throw e
+        }
+    }
+
+    /** @ignore */
+    * _signTransaction(parsedPath: ValidBIP32Path, chainId: HexString, tx: ParsedTransaction, outsideSession: boolean) {
+        const version = yield* this._getCachedVersion()
+        // repeated single-action transfers reuse the template kept by the device
+        const template = getSignTransactionTemplate(parsedPath, chainId, tx)
+        if (template == null) {
+            return yield* signTransaction(version, parsedPath, chainId, tx, outsideSession)
+        }
+        const declareTemplate = template !== this._signTxTemplate
+        // unknown until the call succeeds, e.g. the app might have been restarted
+        this._signTxTemplate = null
+        const result = yield* signTemplateTransaction(version, parsedPath, chainId, tx, declareTemplate, outsideSession)
+        this._signTxTemplate = template
+        return result
+    }
+
+    /**
+     * Start a signing session. After the user approves its limits on the device once,
+     * [[Fio.signTransaction]] signs conforming transactions without any confirmation,
+     * until the session expires, its budget is spent or it is ended.
+     * Transactions the session does not cover are confirmed by the user as usual.
+     *
+     * @returns Status of the started session
+     * @see [[StartSigningSessionRequest]]
+     */
+    async startSigningSession({
+        path, chainId, spendingCap, maxFee, lifetimeSeconds, payees = [],
+    }: StartSigningSessionRequest): Promise<SigningSessionStatus> {
+        const session = parseSigningSession(chainId, path, spendingCap, maxFee, lifetimeSeconds, payees)
+        return interact(this._startSigningSession(session), this._send)
     }
 
     /** @ignore */
-    * _signTransaction(parsedPath: ValidBIP32Path, chainId: HexString, tx: ParsedTransaction) {
-        const version = yield* getVersion()
-        return yield* signTransaction(version, parsedPath, chainId, tx)
+    * _startSigningSession(session: ParsedSigningSession) {
+        const version = yield* this._getCachedVersion()
+        return yield* startSigningSession(version, session)
+    }
+
+    /**
+     * Get status of the signing session, including the remaining budget.
+     */
+    async getSigningSessionStatus(): Promise<SigningSessionStatus> {
+        return interact(this._getSigningSessionStatus(), this._send)
+    }
+
+    /** @ignore */
+    * _getSigningSessionStatus() {
+        const version = yield* this._getCachedVersion()
+        return yield* getSigningSessionStatus(version)
+    }
+
+    /** @ignore */
+    async _isSigningSessionActive(): Promise<boolean> {
+        // the original error is reported if the status is not available either
+        return interact(this._getSigningSessionStatus(), this._send).then(status => status.active, () => false)
+    }
+
+    /**
+     * End the signing session, transactions need to be confirmed by the user again.
+     */
+    async endSigningSession(): Promise<void> {
+        return interact(this._endSigningSession(), this._send)
+    }
+
+    /** @ignore */
+    * _endSigningSession() {
+        const version = yield* this._getCachedVersion()
+        return yield* endSigningSession(version)
     }
 
     /**
@@ -248,10 +526,95 @@ export class Fio {
 
     /** @ignore */
     * _runTests(): Interaction<void> {
-        const version = yield* getVersion()
+        const version = yield* this._getCachedVersion()
         return yield* runTests(version)
     }
 
+    /**
+     * Makes the device answer its prompts automatically (DEVEL app build with HEADLESS only),
+     * e.g. to run many signing flows on an emulator without pressing buttons.
+     *
+     * @example
+     * ```
+     * await fio.setHeadlessInteraction(HeadlessInteraction.REJECT);
+     * ```
+     */
+    async setHeadlessInteraction(interaction: HeadlessInteraction): Promise<void> {
+        return interact(this._setHeadlessInteraction(interaction), this._send)
+    }
+
+    /** @ignore */
+    * _setHeadlessInteraction(interaction: HeadlessInteraction): Interaction<void> {
+        const version = yield* this._getCachedVersion()
+        return yield* setHeadlessInteraction(version, interaction)
+    }
+
+    /**
+     * Measures the cost of a cryptographic kernel on the device (DEVEL app build only).
+     * The device has no clock usable by the app, so the APDU is timed here
+     * and the time of the same APDU with zero iterations (transport overhead) is subtracted.
+     * Use enough iterations to make the overhead and its jitter negligible.
+     *
+     * @example
+     * ```
+     * const {msPerOp} = await fio.benchmark({kernel: BenchmarkKernel.ECDSA_SIGN, iterations: 100});
+     * ```
+     */
+    async benchmark({kernel, iterations}: BenchmarkRequest): Promise<BenchmarkResponse> {
+        validate(typeof kernel === "number" && Object.values(BenchmarkKernel).includes(kernel), InvalidDataReason.INVALID_BENCHMARK_KERNEL)
+        validate(
+            isUint32(iterations) && iterations > 0 && iterations <= MAX_BENCHMARK_ITERATIONS,
+            InvalidDataReason.INVALID_BENCHMARK_ITERATIONS,
+        )
+
+        const overheadMs = await this._timeBenchmark(kernel, 0 as Uint32_t)
+        const totalMs = await this._timeBenchmark(kernel, iterations)
+        const elapsedMs = Math.max(totalMs - overheadMs, 0)
+        return {kernel, iterations, elapsedMs, msPerOp: elapsedMs / iterations}
+    }
+
+    /** @ignore */
+    async _timeBenchmark(kernel: BenchmarkKernel, iterations: Uint32_t): Promise<number> {
+        // resolve the version first so that only the benchmark APDU is timed
+        const version = await interact(this._getCachedVersion(), this._send)
+        const start = Date.now()
+        const done = await interact(benchmark(version, kernel, iterations), this._send)
+        const elapsedMs = Date.now() - start
+        assert(done === iterations, "benchmark iterations mismatch")
+        return elapsedMs
+    }
+
+    /**
+     * Reads the phases of the recent instructions recorded by the device (app built with PROFILING only),
+     * e.g. to see how often signing needs more than one attempt.
+     *
+     * @param reset Start over after reading, the response of this call is then the first record
+     */
+    async getProfile(reset: boolean = false): Promise<Profile> {
+        return interact(this._getProfile(reset), this._send)
+    }
+
+    /** @ignore */
+    * _getProfile(reset: boolean): Interaction<Profile> {
+        const version = yield* this._getCachedVersion()
+        return yield* getProfile(version, reset)
+    }
+
+    /**
+     * Reads the deepest stack use of each instruction since boot (DEVEL app build only).
+     *
+     * @param reset Start over after reading
+     */
+    async getStackUsage(reset: boolean = false): Promise<StackUsage> {
+        return interact(this._getStackUsage(reset), this._send)
+    }
+
+    /** @ignore */
+    * _getStackUsage(reset: boolean): Interaction<StackUsage> {
+        const version = yield* this._getCachedVersion()
+        return yield* getStackUsage(version, reset)
+    }
+
 }
 
 /**
@@ -293,6 +656,46 @@ export type GetPublicKeyResponse = {
     publicKeyWIF: string
 }
 
+/**
+ * Get account public key ([[Fio.getAccountPublicKey]]) request data
+ * @category Main
+ * @see [[GetAccountPublicKeyResponse]]
+ */
+export type GetAccountPublicKeyRequest = {
+    /** Path to the account node, i.e. 44'/235'/0' */
+    path: BIP32Path
+}
+
+/**
+ * Get account public key ([[Fio.getAccountPublicKey]]) response data
+ * @category Main
+ * @see [[GetAccountPublicKeyRequest]]
+ */
+export type GetAccountPublicKeyResponse = AccountPublicKey
+
+/**
+ * Get public keys ([[Fio.getPublicKeys]]) request data
+ * @category Main
+ * @see [[GetPublicKeysItem]]
+ */
+export type GetPublicKeysRequest = {
+    /** Path to the first public key, the last index is incremented for the following keys */
+    path: BIP32Path
+    /** Number of keys to export, at most 1000 */
+    count: number
+}
+
+/**
+ * Single key yielded by [[Fio.getPublicKeys]]
+ * @category Main
+ * @see [[GetPublicKeysRequest]]
+ */
+export type GetPublicKeysItem = {
+    path: BIP32Path
+    /** SEC1 compressed public key */
+    publicKeyHex: string
+}
+
 /**
  * Sign transaction ([[Fio.signTransaction]]) request data
  * @category Main
@@ -316,4 +719,51 @@ export type SignTransactionRequest = {
  */
 export type SignTransactionResponse = SignedTransactionData
 
+/**
+ * Start signing session ([[Fio.startSigningSession]]) request data
+ * @category Main
+ * @see [[SigningSessionStatus]]
+ */
+export type StartSigningSessionRequest = {
+    /** Path to the key used to sign the transactions */
+    path: BIP32Path,
+    /** ChainId in hex format */
+    chainId: string,
+    /** Total of amounts and max fees (in SUFs) of the transactions signed within the session */
+    spendingCap: bigint_like,
+    /** Max fee (in SUFs) of a single transaction */
+    maxFee: bigint_like,
+    /**
+     * At most 24 hours, counted from the approval on the device.
+     * A lower bound, the device counts UI ticks which stop while it derives keys and signs.
+     */
+    lifetimeSeconds: number,
+    /** Allowed payee pubkeys, at most 4, any payee if empty */
+    payees?: Array<string>,
+}
+
+/**
+ * Benchmark ([[Fio.benchmark]]) request data
+ * @category Main
+ * @see [[BenchmarkResponse]]
+ */
+export type BenchmarkRequest = {
+    kernel: BenchmarkKernel
+    /** At most 10000, a few minutes for the slowest kernels on Nano S */
+    iterations: number
+}
+
+/**
+ * Benchmark ([[Fio.benchmark]]) response data
+ * @category Main
+ * @see [[BenchmarkRequest]]
+ */
+export type BenchmarkResponse = {
+    kernel: BenchmarkKernel
+    iterations: number
+    /** Time spent in the kernel, without the transport overhead */
+    elapsedMs: number
+    msPerOp: number
+}
+
 export default Fio
@@ -0,0 +1,20 @@
+import type {Uint32_t} from "../types/internal"
+import type {BenchmarkKernel, Version} from "../types/public"
+import {assert} from "../utils/assert"
+import {BufferWriter} from "../utils/bufferWriter"
+import {INS} from "./common/ins"
+import type {Interaction} from "./common/types"
+
+/** Runs the kernel the given number of times, returns the number of iterations done by the device */
+export function* benchmark(_version: Version, kernel: BenchmarkKernel, iterations: Uint32_t): Interaction<number> {
+    const P2_UNUSED = 0x00
+    const response = yield {
+        ins: INS.BENCHMARK,
+        p1: kernel,
+        p2: P2_UNUSED,
+        data: new BufferWriter(4).uint32(iterations).toBuffer(),
+        expectedResponseLength: 5,
+    }
+    assert(response[0] === kernel, "benchmark kernel mismatch")
+    return response.readUInt32BE(1)
+}
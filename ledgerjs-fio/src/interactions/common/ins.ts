@@ -1,10 +1,17 @@
 export const enum INS {
     GET_VERSION = 0x00,
     GET_SERIAL = 0x01,
+    GET_LAST_RESPONSE = 0x02,
 
     GET_EXT_PUBLIC_KEY = 0x10,
+    GET_ACCOUNT_PUBLIC_KEY = 0x11,
 
     SIGN_TX = 0x20,
+    SIGNING_SESSION = 0x21,
 
     RUN_TESTS = 0xf0,
+    SET_HEADLESS_INTERACTION = 0xf1,
+    BENCHMARK = 0xf3,
+    GET_PROFILE = 0xf4,
+    GET_STACK_USAGE = 0xf5,
 }
@@ -4,6 +4,8 @@ export type SendParams = {
     p2: number
     data: Buffer
     expectedResponseLength?: number
+    // gets the response again if the link drops before it is read
+    recover?: () => Interaction<Buffer>
 };
 
 export type Interaction<RetValue> = Generator<SendParams, RetValue, Buffer>
@@ -0,0 +1,48 @@
+import type {GetAccountPublicKeyResponse} from "../fio"
+import type {ValidBIP32Path} from "../types/internal"
+import {CHAIN_CODE_LENGTH, PUBLIC_KEY_LENGTH} from "../types/internal"
+import type {Version} from "../types/public"
+import {assert} from "../utils/assert"
+import {chunkBy} from "../utils/ioHelpers"
+import {path_to_buf} from "../utils/serialize"
+import {INS} from "./common/ins"
+import type {Interaction, SendParams} from "./common/types"
+import {ensureLedgerAppVersionCompatible} from "./getVersion"
+
+const send = (params: {
+    p1: number,
+    p2: number,
+    data: Buffer,
+    expectedResponseLength?: number
+}): SendParams => ({ins: INS.GET_ACCOUNT_PUBLIC_KEY, ...params})
+
+
+const enum P1 {
+    UNUSED = 0x00,
+}
+
+const enum P2 {
+    UNUSED = 0x00,
+}
+
+export function* getAccountPublicKey(
+    version: Version,
+    path: ValidBIP32Path,
+): Interaction<GetAccountPublicKeyResponse> {
+    ensureLedgerAppVersionCompatible(version)
+
+    const response = yield send({
+        p1: P1.UNUSED,
+        p2: P2.UNUSED,
+        data: path_to_buf(path),
+        expectedResponseLength: PUBLIC_KEY_LENGTH + CHAIN_CODE_LENGTH,
+    })
+
+    const [publicKey, chainCode, rest] = chunkBy(response, [PUBLIC_KEY_LENGTH, CHAIN_CODE_LENGTH])
+    assert(rest.length === 0, "invalid response length")
+
+    return {
+        publicKeyHex: publicKey.toString("hex"),
+        chainCodeHex: chainCode.toString("hex"),
+    }
+}
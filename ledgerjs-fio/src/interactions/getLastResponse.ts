@@ -0,0 +1,70 @@
+import type {Uint32_t} from "../types/internal"
+import {assert} from "../utils/assert"
+import {BufferWriter} from "../utils/bufferWriter"
+import {chunkBy} from "../utils/ioHelpers"
+import {buf_to_uint32} from "../utils/serialize"
+import {INS} from "./common/ins"
+import type {Interaction, SendParams} from "./common/types"
+
+const send = (params: {
+    p1: number,
+    p2: number,
+    data: Buffer,
+    expectedResponseLength?: number
+}): SendParams => ({ins: INS.GET_LAST_RESPONSE, ...params})
+
+const enum P1 {
+    STATUS = 0x01,
+    FETCH = 0x02,
+}
+
+const P2_UNUSED = 0x00
+
+// nonce, sequence and INS
+export const LAST_RESPONSE_STATUS_LENGTH = 4 + 4 + 1
+const HEADER_LENGTH = LAST_RESPONSE_STATUS_LENGTH
+
+// the response the device kept last, the nonce changes when the app restarts
+export type LastResponseStatus = {
+    nonce: Uint32_t
+    sequence: Uint32_t
+    ins: number
+}
+
+export function parseLastResponseStatus(header: Buffer): LastResponseStatus {
+    const [nonce, sequence, ins] = chunkBy(header, [4, 4, 1])
+    return {
+        nonce: buf_to_uint32(nonce),
+        sequence: buf_to_uint32(sequence),
+        ins: ins[0],
+    }
+}
+
+export function* getLastResponseStatus(): Interaction<LastResponseStatus> {
+    const response = yield send({
+        p1: P1.STATUS,
+        p2: P2_UNUSED,
+        data: Buffer.alloc(0),
+        expectedResponseLength: HEADER_LENGTH,
+    })
+    return parseLastResponseStatus(response)
+}
+
+/**
+ * Fetches the response which the device kept right after `status` was read,
+ * i.e. the response of the next call with the given INS.
+ * The device refuses if it kept a different one.
+ */
+export function* fetchNextResponse(status: LastResponseStatus, ins: INS): Interaction<Buffer> {
+    const sequence = (status.sequence + 1) as Uint32_t
+    const response = yield send({
+        p1: P1.FETCH,
+        p2: P2_UNUSED,
+        data: new BufferWriter(4 + 4).uint32(status.nonce).uint32(sequence).toBuffer(),
+    })
+    assert(response.length >= HEADER_LENGTH, "invalid response length")
+    const header = parseLastResponseStatus(response.slice(0, HEADER_LENGTH))
+    assert(header.nonce === status.nonce && header.sequence === sequence, "unexpected response")
+    assert(header.ins === ins, "response of another call")
+    return response.slice(HEADER_LENGTH)
+}
@@ -0,0 +1,37 @@
+import type {Profile, ProfilePhase, ProfileRecord, Version} from "../types/public"
+import {assert} from "../utils/assert"
+import {INS} from "./common/ins"
+import type {Interaction} from "./common/types"
+
+const PHASE_END_FLAG = 0x80
+const RECORD_LENGTH = 7
+const HEADER_LENGTH = 5
+
+export function* getProfile(_version: Version, reset: boolean): Interaction<Profile> {
+    const P1_READ = 0x00
+    const P1_READ_AND_RESET = 0x01
+    const P2_UNUSED = 0x00
+    const response = yield {
+        ins: INS.GET_PROFILE,
+        p1: reset ? P1_READ_AND_RESET : P1_READ,
+        p2: P2_UNUSED,
+        data: Buffer.alloc(0),
+    }
+
+    assert(response.length >= HEADER_LENGTH, "response too short")
+    const totalRecorded = response.readUInt32BE(0)
+    const count = response[4]
+    assert(response.length === HEADER_LENGTH + count * RECORD_LENGTH, "invalid response length")
+
+    const records: Array<ProfileRecord> = []
+    for (let offset = HEADER_LENGTH; offset < response.length; offset += RECORD_LENGTH) {
+        records.push({
+            ins: response[offset],
+            phase: (response[offset + 1] & ~PHASE_END_FLAG) as ProfilePhase,
+            isEnd: (response[offset + 1] & PHASE_END_FLAG) !== 0,
+            value: response[offset + 2],
+            ticker: response.readUInt32BE(offset + 3),
+        })
+    }
+    return {totalRecorded, records}
+}
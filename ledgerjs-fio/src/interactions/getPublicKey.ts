@@ -1,13 +1,15 @@
 import type {GetPublicKeyResponse} from "../fio"
-import type {ValidBIP32Path} from "../types/internal"
-import {WIF_PUBLIC_KEY_LENGTH} from "../types/internal"
+import type {Uint32_t, ValidBIP32Path} from "../types/internal"
+import {COMPRESSED_PUBLIC_KEY_LENGTH, MAX_PUBLIC_KEYS_PER_RESPONSE, WIF_PUBLIC_KEY_LENGTH} from "../types/internal"
 import {PUBLIC_KEY_LENGTH} from "../types/internal"
 import type {Version} from "../types/public"
 import {assert} from "../utils/assert"
+import {BufferWriter} from "../utils/bufferWriter"
 import {chunkBy} from "../utils/ioHelpers"
 import {path_to_buf} from "../utils/serialize"
 import {INS} from "./common/ins"
 import type {Interaction, SendParams} from "./common/types"
+import {fetchNextResponse, getLastResponseStatus} from "./getLastResponse"
 import {ensureLedgerAppVersionCompatible} from "./getVersion"
 
 const send = (params: {
@@ -15,12 +17,15 @@ const send = (params: {
     p2: number,
     data: Buffer,
     expectedResponseLength?: number
+    recover?: () => Interaction<Buffer>
 }): SendParams => ({ins: INS.GET_EXT_PUBLIC_KEY, ...params})
 
 
 const enum P1 {
     SHOW = 0x01,
     DO_NOT_SHOW = 0x02,
+    BATCH_INIT = 0x03,
+    BATCH_NEXT = 0x04,
 }
 
 const enum P2 {
@@ -36,11 +41,15 @@ export function* getPublicKey(
 
     const pathData = path_to_buf(path)
 
+    // the user would have to confirm the export again if the response got lost
+    const lastResponse = show_or_not ? yield* getLastResponseStatus() : null
+
     const response = yield send({
         p1: show_or_not ? P1.SHOW : P1.DO_NOT_SHOW,
         p2: P2.UNUSED,
         data: pathData,
         expectedResponseLength: PUBLIC_KEY_LENGTH + WIF_PUBLIC_KEY_LENGTH,
+        ...(lastResponse ? {recover: () => fetchNextResponse(lastResponse, INS.GET_EXT_PUBLIC_KEY)} : {}),
     })
 
     const [publicKey, publicKeyWIF, rest] = chunkBy(response, [PUBLIC_KEY_LENGTH, WIF_PUBLIC_KEY_LENGTH])
@@ -51,3 +60,44 @@ export function* getPublicKey(
         publicKeyWIF: publicKeyWIF.toString(),
     }
 }
+
+function parseCompressedKeys(response: Buffer, expectedCount: number): Array<string> {
+    assert(response.length === expectedCount * COMPRESSED_PUBLIC_KEY_LENGTH, "invalid response length")
+
+    const keys: Array<string> = []
+    for (let i = 0; i < expectedCount; i++) {
+        const start = i * COMPRESSED_PUBLIC_KEY_LENGTH
+        keys.push(response.slice(start, start + COMPRESSED_PUBLIC_KEY_LENGTH).toString("hex"))
+    }
+    return keys
+}
+
+// Starts a batch export and returns the first chunk of compressed public keys.
+export function* getPublicKeysInit(
+    version: Version,
+    path: ValidBIP32Path,
+    count: Uint32_t
+): Interaction<Array<string>> {
+    ensureLedgerAppVersionCompatible(version)
+
+    const response = yield send({
+        p1: P1.BATCH_INIT,
+        p2: P2.UNUSED,
+        data: new BufferWriter(1 + 4 * path.length + 4).path(path).uint32(count).toBuffer(),
+    })
+
+    return parseCompressedKeys(response, Math.min(count, MAX_PUBLIC_KEYS_PER_RESPONSE))
+}
+
+// Returns the next chunk of an ongoing batch export.
+export function* getPublicKeysNext(
+    remaining: number
+): Interaction<Array<string>> {
+    const response = yield send({
+        p1: P1.BATCH_NEXT,
+        p2: P2.UNUSED,
+        data: Buffer.alloc(0),
+    })
+
+    return parseCompressedKeys(response, Math.min(remaining, MAX_PUBLIC_KEYS_PER_RESPONSE))
+}
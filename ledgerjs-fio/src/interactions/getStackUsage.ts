@@ -0,0 +1,34 @@
+import type {InstructionStackUsage, StackUsage, Version} from "../types/public"
+import {assert} from "../utils/assert"
+import {INS} from "./common/ins"
+import type {Interaction} from "./common/types"
+
+const ENTRY_LENGTH = 5
+const HEADER_LENGTH = 3
+
+export function* getStackUsage(_version: Version, reset: boolean): Interaction<StackUsage> {
+    const P1_READ = 0x00
+    const P1_READ_AND_RESET = 0x01
+    const P2_UNUSED = 0x00
+    const response = yield {
+        ins: INS.GET_STACK_USAGE,
+        p1: reset ? P1_READ_AND_RESET : P1_READ,
+        p2: P2_UNUSED,
+        data: Buffer.alloc(0),
+    }
+
+    assert(response.length >= HEADER_LENGTH, "response too short")
+    const stackSize = response.readUInt16BE(0)
+    const count = response[2]
+    assert(response.length === HEADER_LENGTH + count * ENTRY_LENGTH, "invalid response length")
+
+    const instructions: Array<InstructionStackUsage> = []
+    for (let offset = HEADER_LENGTH; offset < response.length; offset += ENTRY_LENGTH) {
+        instructions.push({
+            ins: response[offset],
+            maxUsed: response.readUInt16BE(offset + 1),
+            minFree: response.readUInt16BE(offset + 3),
+        })
+    }
+    return {stackSize, instructions}
+}
@@ -36,12 +36,13 @@ export function* getVersion(): Interaction<Version> {
 
 export function getCompatibility(version: Version): DeviceCompatibility {
     // We restrict forward compatibility only to backward-compatible semver changes
-    const v0_0 = isLedgerAppVersionAtLeast(version, 0, 0) &&
+    // 0.1 added the raw signing mode, which signTransaction relies on
+    const v0_1 = isLedgerAppVersionAtLeast(version, 0, 1) &&
                  isLedgerAppVersionAtMost(version, 0, Infinity)
 
     return {
-        isCompatible: v0_0,
-        recommendedVersion: v0_0 ? null : '0.0',
+        isCompatible: v0_1,
+        recommendedVersion: v0_1 ? null : '0.1',
     }
 }
 
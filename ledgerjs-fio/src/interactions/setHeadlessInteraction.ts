@@ -0,0 +1,13 @@
+import type {HeadlessInteraction, Version} from "../types/public"
+import {INS} from "./common/ins"
+import type {Interaction} from "./common/types"
+
+export function* setHeadlessInteraction(_version: Version, interaction: HeadlessInteraction): Interaction<void> {
+    yield {
+        ins: INS.SET_HEADLESS_INTERACTION,
+        p1: interaction,
+        p2: 0x00,
+        data: Buffer.alloc(0),
+        expectedResponseLength: 0,
+    }
+}
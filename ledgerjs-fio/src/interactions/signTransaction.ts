@@ -1,23 +1,23 @@
-import type {HexString, ParsedTransaction, ParsedTransferFIOTokensData, Uint8_t, ValidBIP32Path} from "../types/internal"
-
-import {InvalidDataReason} from "../errors"
+import type {HexString, ParsedAction, ParsedTransaction, ParsedTransferFIOTokensData, Uint8_t, Uint16_t, Uint32_t, ValidBIP32Path} from "../types/internal"
+import {MAX_APDU_DATA_LENGTH} from "../types/internal"
 import type {SignedTransactionData, Version} from "../types/public"
 import {HARDENED} from "../types/public"
 import {assert} from "../utils/assert"
+import {BufferWriter, string_length, varuint32_length} from "../utils/bufferWriter"
 import {chunkBy} from "../utils/ioHelpers"
-import {validate} from "../utils/parse"
-import {buf_to_hex, date_to_buf, path_to_buf, uint8_to_buf, uint16_to_buf, uint32_to_buf, uint64_to_buf} from "../utils/serialize"
+import {buf_to_hex, buf_to_uint64, date_to_uint32} from "../utils/serialize"
 import {INS} from "./common/ins"
 import type {Interaction, SendParams} from "./common/types"
+import type {LastResponseStatus} from "./getLastResponse"
+import {fetchNextResponse, LAST_RESPONSE_STATUS_LENGTH, parseLastResponseStatus} from "./getLastResponse"
 import {ensureLedgerAppVersionCompatible} from "./getVersion"
 
 const enum P1 {
-    STAGE_INIT = 0x01,
-    STAGE_HEADER = 0x02,
-    STAGE_ACTION_HEADER = 0x03,
-    STAGE_ACTION_AUTHORIZATION = 0x04,
-    STAGE_ACTION_DATA = 0x05,
+    STAGE_RAW_INIT = 0x06,
+    STAGE_RAW_CHUNK = 0x07,
     STAGE_WITNESSES = 0x10,
+    STAGE_TEMPLATE_INIT = 0x30,
+    STAGE_TEMPLATE_TX = 0x31,
 }
 
 const send = (params: {
@@ -25,101 +25,131 @@ const send = (params: {
     p2: number,
     data: Buffer,
     expectedResponseLength?: number
+    recover?: () => Interaction<Buffer>
 }): SendParams => ({ins: INS.SIGN_TX, ...params})
 
+const enum P2 {
+    UNUSED = 0x00,
+    // witness path is sent with the chainId, the device derives the key while the user reviews the tx
+    EARLY_WITNESS = 0x01,
+    // the user confirms the tx even while a signing session is active
+    OUTSIDE_SESSION = 0x02,
+}
 
-export function* signTransaction(version: Version, parsedPath: ValidBIP32Path, chainId: HexString, tx: ParsedTransaction): Interaction<SignedTransactionData> {
-    ensureLedgerAppVersionCompatible(version)
+const CHAIN_ID_LENGTH = 32
+const PACKED_TX_LENGTH_LENGTH = 2
+// expiration, ref block num and ref block prefix
+const TEMPLATE_TX_HEADER_LENGTH = 10
+// the rest of the header and the action up to its data
+const TEMPLATE_TX_SHARED_LENGTH = 4 + 1 + 16 + 1 + 8 + 8
 
-    //Initialize and send chainId
-    {
-        const P2_UNUSED = 0x00
-        yield send({
-            p1: P1.STAGE_INIT,
-            p2: P2_UNUSED,
-            data: Buffer.from(chainId, "hex"),
-            expectedResponseLength: 0,
-        })
-    }
-    //Send expiration, ref block num, ref block prefix
-    {
-        const P2_UNUSED = 0x00
-        yield send({
-            p1: P1.STAGE_HEADER,
-            p2: P2_UNUSED,
-            data: Buffer.concat([date_to_buf(tx.expiration), uint16_to_buf(tx.ref_block_num), uint32_to_buf(tx.ref_block_prefix)]),
-            expectedResponseLength: 0,
-        })
-    }
-    //Send action account, name, acount, permission level
-    {
-        const P2_UNUSED = 0x00
-        yield send({
-            p1: P1.STAGE_ACTION_HEADER,
-            p2: P2_UNUSED,
-            data: Buffer.from(tx.actions[0].contractAccountName, "hex"),
-            expectedResponseLength: 0,
-        })
-    }
-    //Send action authorization
-    {
-        const P2_UNUSED = 0x00
-        yield send({
-            p1: P1.STAGE_ACTION_AUTHORIZATION,
-            p2: P2_UNUSED,
-            data: Buffer.concat([
-                Buffer.from(tx.actions[0].authorization[0].actor, "hex"),
-                Buffer.from(tx.actions[0].authorization[0].permission, "hex"),
-            ]),
-            expectedResponseLength: 0,
-        })
+function actionDataLength(data: ParsedTransferFIOTokensData): number {
+    return string_length(data.payee_public_key) + 8 + 8 + 8 + string_length(data.tpid)
+}
+
+function actionLength(action: ParsedAction): number {
+    const dataLength = actionDataLength(action.data)
+    return 8 + 8 + 1 + 8 + 8 + varuint32_length(dataLength) + dataLength
+}
+
+function writeAction(writer: BufferWriter, action: ParsedAction) {
+    const actionData: ParsedTransferFIOTokensData = action.data
+    writer
+        .hex(action.contractAccountName)
+        .varuint32(1 as Uint8_t) // authorizations
+        .hex(action.authorization[0].actor)
+        .hex(action.authorization[0].permission)
+        .varuint32(actionDataLength(actionData) as Uint32_t)
+        .string(actionData.payee_public_key)
+        .uint64le(actionData.amount)
+        .uint64le(actionData.max_fee)
+        .hex(actionData.actor)
+        .string(actionData.tpid)
+}
+
+// Canonical EOSIO packed_trx serialization, this is exactly what Ledger hashes
+export function serializeTransaction(tx: ParsedTransaction): Buffer {
+    const length = 4 + 2 + 4 + 1 + 1 + 1 + 1
+        + varuint32_length(tx.actions.length)
+        + tx.actions.reduce((sum, action) => sum + actionLength(action), 0)
+        + 1
+    const writer = new BufferWriter(length)
+        .uint32le(date_to_uint32(tx.expiration))
+        .uint16le(tx.ref_block_num)
+        .uint32le(tx.ref_block_prefix)
+        .varuint32(0 as Uint8_t) // max_net_usage_words
+        .uint8(0 as Uint8_t) // max_cpu_usage_ms
+        .varuint32(0 as Uint8_t) // delay_sec
+        .varuint32(0 as Uint8_t) // context_free_actions
+        .varuint32(tx.actions.length as Uint32_t)
+    for (const action of tx.actions) {
+        writeAction(writer, action)
     }
+    return writer
+        .varuint32(0 as Uint8_t) // transaction_extensions
+        .toBuffer()
+}
 
-    //prepare to send action data
-    const actionData: ParsedTransferFIOTokensData = tx.actions[0].data
-    const SIMPLE_LENGTH_VARIABLE_LENGTH = 1
-    const AMOUNT_TYPE_LENGTH = 8
-    const NAME_VARIABLE_LENGTH = 8
-    const actionDataLength: number =
-        SIMPLE_LENGTH_VARIABLE_LENGTH + actionData.payee_public_key.length //pubkey lenght, pubkey
-        + 2*AMOUNT_TYPE_LENGTH + NAME_VARIABLE_LENGTH  //amount, max_fee, actor
-        + SIMPLE_LENGTH_VARIABLE_LENGTH + actionData.tpid.length //tpid length, tpid
+export function* signTransaction(
+    version: Version,
+    parsedPath: ValidBIP32Path,
+    chainId: HexString,
+    tx: ParsedTransaction,
+    outsideSession: boolean,
+): Interaction<SignedTransactionData> {
+    ensureLedgerAppVersionCompatible(version)
 
-    validate(actionDataLength < 128, InvalidDataReason.ACTION_DATA_TOO_LONG)
+    const packedTx = serializeTransaction(tx)
+    assert(packedTx.length <= 0xffff, "transaction too long")
 
-    //Send action data
+    //Send chainId, witness path, total length and as much of the transaction as fits
+    let lastResponse: LastResponseStatus
     {
-        const P2_UNUSED = 0x00
-        yield send({
-            p1: P1.STAGE_ACTION_DATA,
-            p2: P2_UNUSED,
-            data: Buffer.concat([
-                uint8_to_buf(actionDataLength as Uint8_t),
-                uint8_to_buf(actionData.payee_public_key.length as Uint8_t),
-                Buffer.from(actionData.payee_public_key),
-                uint8_to_buf(0 as Uint8_t), //we add trailing zero to the string to help ledger displaying
-                uint64_to_buf(actionData.amount),
-                uint64_to_buf(actionData.max_fee),
-                Buffer.from(actionData.actor, "hex"),
-                uint8_to_buf(actionData.tpid.length as Uint8_t),
-                Buffer.from(actionData.tpid),
-                uint8_to_buf(0 as Uint8_t), //we add trailing zero to the string to help ledger displaying
-            ]),
-            expectedResponseLength: 0,
+        const firstChunkLength = Math.min(
+            packedTx.length,
+            MAX_APDU_DATA_LENGTH - CHAIN_ID_LENGTH - (1 + 4 * parsedPath.length) - PACKED_TX_LENGTH_LENGTH,
+        )
+        // tells us how to recover the witness if it gets lost
+        const response = yield send({
+            p1: P1.STAGE_RAW_INIT,
+            p2: P2.EARLY_WITNESS | (outsideSession ? P2.OUTSIDE_SESSION : 0),
+            data: new BufferWriter(MAX_APDU_DATA_LENGTH)
+                .hex(chainId)
+                .path(parsedPath)
+                .uint16(packedTx.length as Uint16_t)
+                .bytes(packedTx.slice(0, firstChunkLength))
+                .toBuffer(),
+            expectedResponseLength: LAST_RESPONSE_STATUS_LENGTH,
         })
+        lastResponse = parseLastResponseStatus(response)
+
+        //Send the rest of the transaction
+        for (let offset = firstChunkLength; offset < packedTx.length; offset += MAX_APDU_DATA_LENGTH) {
+            yield send({
+                p1: P1.STAGE_RAW_CHUNK,
+                p2: P2.UNUSED,
+                data: packedTx.slice(offset, offset + MAX_APDU_DATA_LENGTH),
+                expectedResponseLength: 0,
+            })
+        }
     }
 
-    //Send witnesses
-    const P2_UNUSED = 0x00
+    return yield* getWitness(lastResponse)
+}
+
+function* getWitness(lastResponse: LastResponseStatus): Interaction<SignedTransactionData> {
+    //Get witnesses, the path was already sent
     const response = yield send({
         p1: P1.STAGE_WITNESSES,
-        p2: P2_UNUSED,
-        data: path_to_buf(parsedPath),
-        expectedResponseLength: 65 + 32,
+        p2: P2.UNUSED,
+        data: Buffer.alloc(0),
+        // the user would have to confirm the transaction again if the signature got lost
+        recover: () => fetchNextResponse(lastResponse, INS.SIGN_TX),
     })
 
     const [witnessSignature, hash, rest] = chunkBy(response, [65, 32])
-    assert(rest.length === 0, "invalid response length")
+    // remaining budget follows if signed within a signing session
+    assert(rest.length === 0 || rest.length === 8, "invalid response length")
 
     return {
         txHashHex: buf_to_hex(hash),
@@ -127,5 +157,73 @@ export function* signTransaction(version: Version, parsedPath: ValidBIP32Path, c
             path: [44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0],
             witnessSignatureHex: buf_to_hex(witnessSignature),
         },
+        ...(rest.length > 0 ? {remainingSessionBudget: buf_to_uint64(rest)} : {}),
     }
 }
+
+/**
+ * Identifies the template a transaction can be signed with, null if it does not fit into one.
+ * Transactions with the same template differ only in header and action data.
+ */
+export function getSignTransactionTemplate(parsedPath: ValidBIP32Path, chainId: HexString, tx: ParsedTransaction): string | null {
+    if (tx.actions.length !== 1) return null
+
+    const packedTx = serializeTransaction(tx)
+    const sharedEnd = TEMPLATE_TX_HEADER_LENGTH + TEMPLATE_TX_SHARED_LENGTH
+    if (packedTx.length - sharedEnd + TEMPLATE_TX_HEADER_LENGTH > MAX_APDU_DATA_LENGTH) return null
+
+    return new BufferWriter(MAX_APDU_DATA_LENGTH)
+        .hex(chainId)
+        .bytes(packedTx.slice(TEMPLATE_TX_HEADER_LENGTH, sharedEnd))
+        .path(parsedPath)
+        .toBuffer()
+        .toString("hex")
+}
+
+/**
+ * Signs a single-action transaction sending just its variable parts,
+ * the rest was declared as a template before (optionally in this call).
+ */
+export function* signTemplateTransaction(
+    version: Version,
+    parsedPath: ValidBIP32Path,
+    chainId: HexString,
+    tx: ParsedTransaction,
+    declareTemplate: boolean,
+    outsideSession: boolean,
+): Interaction<SignedTransactionData> {
+    ensureLedgerAppVersionCompatible(version)
+    assert(tx.actions.length === 1, "template transactions have a single action")
+    const action = tx.actions[0]
+
+    if (declareTemplate) {
+        yield send({
+            p1: P1.STAGE_TEMPLATE_INIT,
+            p2: P2.UNUSED,
+            data: new BufferWriter(MAX_APDU_DATA_LENGTH)
+                .hex(chainId)
+                .hex(action.contractAccountName)
+                .hex(action.authorization[0].actor)
+                .hex(action.authorization[0].permission)
+                .path(parsedPath)
+                .toBuffer(),
+            expectedResponseLength: 0,
+        })
+    }
+
+    const packedTx = serializeTransaction(tx)
+    assert(packedTx.length - TEMPLATE_TX_SHARED_LENGTH <= MAX_APDU_DATA_LENGTH, "transaction too long for a template")
+    const data = new BufferWriter(MAX_APDU_DATA_LENGTH)
+        .bytes(packedTx.slice(0, TEMPLATE_TX_HEADER_LENGTH))
+        .bytes(packedTx.slice(TEMPLATE_TX_HEADER_LENGTH + TEMPLATE_TX_SHARED_LENGTH))
+        .toBuffer()
+    // tells us how to recover the witness if it gets lost
+    const response = yield send({
+        p1: P1.STAGE_TEMPLATE_TX,
+        p2: outsideSession ? P2.OUTSIDE_SESSION : P2.UNUSED,
+        data,
+        expectedResponseLength: LAST_RESPONSE_STATUS_LENGTH,
+    })
+
+    return yield* getWitness(parseLastResponseStatus(response))
+}
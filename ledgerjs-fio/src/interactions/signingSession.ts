@@ -0,0 +1,97 @@
+import type {ParsedSigningSession, Uint32_t} from "../types/internal"
+import {MAX_APDU_DATA_LENGTH} from "../types/internal"
+import type {SigningSessionStatus, Version} from "../types/public"
+import {assert} from "../utils/assert"
+import {BufferWriter} from "../utils/bufferWriter"
+import {chunkBy} from "../utils/ioHelpers"
+import {buf_to_uint32, buf_to_uint64} from "../utils/serialize"
+import {INS} from "./common/ins"
+import type {Interaction, SendParams} from "./common/types"
+import {ensureLedgerAppVersionCompatible} from "./getVersion"
+
+const enum P1 {
+    STAGE_INIT = 0x01,
+    STAGE_PAYEE = 0x02,
+    STAGE_CONFIRM = 0x03,
+    STATUS = 0x10,
+    END = 0x11,
+}
+
+const P2_UNUSED = 0x00
+
+const STATUS_RESPONSE_LENGTH = 1 + 8 + 4
+
+const send = (params: {
+    p1: number,
+    p2: number,
+    data: Buffer,
+    expectedResponseLength?: number
+}): SendParams => ({ins: INS.SIGNING_SESSION, ...params})
+
+function parseStatus(response: Buffer): SigningSessionStatus {
+    const [active, remainingBudget, remainingLifetime] = chunkBy(response, [1, 8, 4])
+    return {
+        active: active[0] === 1,
+        remainingBudget: buf_to_uint64(remainingBudget),
+        remainingLifetimeSeconds: buf_to_uint32(remainingLifetime),
+    }
+}
+
+export function* startSigningSession(version: Version, session: ParsedSigningSession): Interaction<SigningSessionStatus> {
+    ensureLedgerAppVersionCompatible(version)
+
+    yield send({
+        p1: P1.STAGE_INIT,
+        p2: P2_UNUSED,
+        data: new BufferWriter(MAX_APDU_DATA_LENGTH)
+            .hex(session.chainId)
+            .uint64(session.spendingCap)
+            .uint64(session.maxFee)
+            .uint32(session.lifetimeSeconds as Uint32_t)
+            .path(session.path)
+            .toBuffer(),
+        expectedResponseLength: 0,
+    })
+
+    for (const payee of session.payees) {
+        yield send({
+            p1: P1.STAGE_PAYEE,
+            p2: P2_UNUSED,
+            data: Buffer.from(payee, "ascii"),
+            expectedResponseLength: 0,
+        })
+    }
+
+    const response = yield send({
+        p1: P1.STAGE_CONFIRM,
+        p2: P2_UNUSED,
+        data: Buffer.alloc(0),
+        expectedResponseLength: STATUS_RESPONSE_LENGTH,
+    })
+    const status = parseStatus(response)
+    assert(status.active, "session not started")
+    return status
+}
+
+export function* getSigningSessionStatus(version: Version): Interaction<SigningSessionStatus> {
+    ensureLedgerAppVersionCompatible(version)
+
+    const response = yield send({
+        p1: P1.STATUS,
+        p2: P2_UNUSED,
+        data: Buffer.alloc(0),
+        expectedResponseLength: STATUS_RESPONSE_LENGTH,
+    })
+    return parseStatus(response)
+}
+
+export function* endSigningSession(version: Version): Interaction<void> {
+    ensureLedgerAppVersionCompatible(version)
+
+    yield send({
+        p1: P1.END,
+        p2: P2_UNUSED,
+        data: Buffer.alloc(0),
+        expectedResponseLength: 0,
+    })
+}
@@ -0,0 +1,253 @@
+import type Transport from "@ledgerhq/hw-transport"
+
+import {ErrorBase, NoDeviceAvailable} from "./errors"
+import type {GetPublicKeyRequest, GetPublicKeyResponse, SignTransactionRequest, SignTransactionResponse} from "./fio"
+import {Fio} from "./fio"
+import {HARDENED} from "./types/public"
+
+/**
+ * [[FioPool]] options
+ * @category Pool
+ */
+export type FioPoolOptions = {
+    /** Lists the descriptors of the connected devices, e.g. `TransportNodeHid.list` */
+    list: () => Promise<Array<string>>
+    /** Opens the transport of a listed device, e.g. `TransportNodeHid.open` */
+    open: (descriptor: string) => Promise<Transport<string>>
+    /** Period of the health checks and re-enumeration, 10 s by default, 0 disables them */
+    healthCheckIntervalMs?: number
+}
+
+/**
+ * Restricts the devices allowed to serve a [[FioPool]] request
+ * @category Pool
+ */
+export type PoolRouting = {
+    /** Only devices with this seed fingerprint ([[PoolDeviceStats.seed]]), any device if not given */
+    seed?: string
+}
+
+/**
+ * State and metrics of a device of a [[FioPool]]
+ * @category Pool
+ */
+export type PoolDeviceStats = {
+    descriptor: string
+    /** Ledger device identifier, see [[Fio.getSerial]] */
+    serial: string
+    /** Seed fingerprint, the public key of `44'/235'/0'/0/0`, shared by devices with the same seed */
+    seed: string
+    /** Requests queued or running on the device */
+    queueDepth: number
+    completed: number
+    failed: number
+}
+
+type PoolDevice = PoolDeviceStats & {
+    transport: Transport<string>
+    fio: Fio
+    /** Settles when the last queued request finishes */
+    tail: Promise<void>
+    /** `completed` at the previous health check */
+    completedAtLastCheck: number
+}
+
+const SEED_FINGERPRINT_PATH = [44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0]
+const DEFAULT_HEALTH_CHECK_INTERVAL_MS = 10000
+
+const noop = () => {}
+
+/**
+ * Spreads requests over several devices. Each request goes to the least busy device
+ * (holding the requested seed), requests to the same device are queued.
+ * Devices are identified by their serial and seed fingerprint when they get connected.
+ * Unplugged devices and those failing the periodic health check are dropped,
+ * newly connected ones are picked up by the re-enumeration.
+ *
+ * @example
+ * ```
+ * const pool = new FioPool({list: TransportNodeHid.list, open: TransportNodeHid.open});
+ * await pool.start();
+ * const {witness} = await pool.signTransaction({path, chainId, tx});
+ * ```
+ * @category Pool
+ */
+export class FioPool {
+    private devices: Array<PoolDevice> = []
+    private refreshing: Promise<void> | null = null
+    private timer: ReturnType<typeof setInterval> | null = null
+
+    constructor(private options: FioPoolOptions) {}
+
+    /**
+     * Enumerates the connected devices and starts the periodic health checks.
+     */
+    async start(): Promise<void> {
+        await this.refresh()
+        const interval = this.options.healthCheckIntervalMs ?? DEFAULT_HEALTH_CHECK_INTERVAL_MS
+        if (interval > 0 && this.timer == null) {
+            this.timer = setInterval(() => {
+                this.refresh().catch(noop)
+            }, interval)
+            // the pool alone should not keep the process running
+            this.timer.unref?.()
+        }
+    }
+
+    /**
+     * Stops the health checks and closes the transports once their queued requests finish.
+     */
+    async close(): Promise<void> {
+        if (this.timer != null) {
+            clearInterval(this.timer)
+            this.timer = null
+        }
+        const devices = this.devices
+        this.devices = []
+        await Promise.all(devices.map((device) => device.tail.then(() => device.transport.close()).catch(noop)))
+    }
+
+    /**
+     * Checks the health of the known devices and connects the new ones.
+     * Busy devices are not checked if they completed a request since the previous check.
+     * Runs periodically after [[start]], concurrent calls share a single run.
+     */
+    refresh(): Promise<void> {
+        if (this.refreshing == null) {
+            this.refreshing = this._refresh().finally(() => {
+                this.refreshing = null
+            })
+        }
+        return this.refreshing
+    }
+
+    /**
+     * Metrics of the connected devices.
+     */
+    stats(): Array<PoolDeviceStats> {
+        return this.devices.map(({descriptor, serial, seed, queueDepth, completed, failed}) => ({
+            descriptor, serial, seed, queueDepth, completed, failed,
+        }))
+    }
+
+    /**
+     * [[Fio.getPublicKey]] on the least busy device.
+     */
+    getPublicKey(request: GetPublicKeyRequest, routing: PoolRouting = {}): Promise<GetPublicKeyResponse> {
+        return this.dispatch(routing, (fio) => fio.getPublicKey(request))
+    }
+
+    /**
+     * [[Fio.signTransaction]] on the least busy device.
+     */
+    signTransaction(request: SignTransactionRequest, routing: PoolRouting = {}): Promise<SignTransactionResponse> {
+        return this.dispatch(routing, (fio) => fio.signTransaction(request))
+    }
+
+    private async _refresh(): Promise<void> {
+        const descriptors = await this.options.list()
+        const known = this.devices.map((device) => device.descriptor)
+
+        await Promise.all([
+            ...this.devices.map(async (device) => {
+                if (!descriptors.includes(device.descriptor)) {
+                    this.remove(device)
+                    return
+                }
+                if (await this.isHealthy(device)) return
+                this.remove(device)
+                // e.g. the app was restarted, so the device may work again right away
+                await this.add(device.descriptor).catch(noop)
+            }),
+            // the new devices do not wait for the health checks
+            ...descriptors
+                .filter((descriptor) => !known.includes(descriptor))
+                // e.g. the device is locked or another app is open, the next refresh tries again
+                .map((descriptor) => this.add(descriptor).catch(noop)),
+        ])
+    }
+
+    private async isHealthy(device: PoolDevice): Promise<boolean> {
+        const completedRecently = device.completed > device.completedAtLastCheck
+        device.completedAtLastCheck = device.completed
+        // a check would wait behind the queued requests, those which completed show that the device works
+        if (device.queueDepth > 0 && completedRecently) return true
+        try {
+            // also notices that the app was closed or replaced
+            await this.run(device, (fio) => fio.getVersion())
+            return true
+        } catch {
+            return false
+        }
+    }
+
+    private async add(descriptor: string): Promise<void> {
+        const transport = await this.options.open(descriptor)
+        try {
+            const fio = new Fio(transport)
+            const {serial} = await fio.getSerial()
+            const {publicKeyHex: seed} = await fio.getPublicKey({path: SEED_FINGERPRINT_PATH, show_or_not: false})
+
+            // the same device reconnected under another descriptor
+            this.devices.filter((device) => device.serial === serial).forEach((device) => this.remove(device))
+
+            const device: PoolDevice = {
+                descriptor, serial, seed, transport, fio,
+                queueDepth: 0,
+                completed: 0,
+                failed: 0,
+                tail: Promise.resolve(),
+                completedAtLastCheck: 0,
+            }
+            transport.on("disconnect", () => this.remove(device))
+            this.devices.push(device)
+        } catch (e) {
+            await transport.close().catch(noop)
+            throw e
+        }
+    }
+
+    private remove(device: PoolDevice) {
+        const index = this.devices.indexOf(device)
+        if (index < 0) return
+        this.devices.splice(index, 1)
+        device.tail.then(() => device.transport.close()).catch(noop)
+    }
+
+    private pick({seed}: PoolRouting): PoolDevice {
+        const candidates = this.devices.filter((device) => seed == null || device.seed === seed)
+        if (candidates.length === 0) {
+            throw new NoDeviceAvailable(seed == null ? "No device connected" : `No device holds the seed ${seed}`)
+        }
+        // an idle one if there is any
+        return candidates.reduce((best, device) => device.queueDepth < best.queueDepth ? device : best)
+    }
+
+    // a transport serves one request at a time, the others wait in its queue
+    private run<T>(device: PoolDevice, call: (fio: Fio) => Promise<T>): Promise<T> {
+        device.queueDepth++
+        const result = device.tail.then(() => call(device.fio))
+        device.tail = result.then(noop, noop)
+        return result.finally(() => {
+            device.queueDepth--
+        })
+    }
+
+    private async dispatch<T>(routing: PoolRouting, call: (fio: Fio) => Promise<T>): Promise<T> {
+        const device = this.pick(routing)
+        try {
+            const result = await this.run(device, call)
+            device.completed++
+            return result
+        } catch (e) {
+            device.failed++
+            // the device answered with an error or the request was invalid, anything else means the link is gone
+            if (!(e instanceof ErrorBase)) {
+                this.remove(device)
+            }
+            throw e
+        }
+    }
+}
+
+export default FioPool
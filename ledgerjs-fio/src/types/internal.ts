@@ -16,6 +16,24 @@ export type Uint8_t = number & { __type: 'uint8_t' }
 // Our types
 export const PUBLIC_KEY_LENGTH = 65
 export const WIF_PUBLIC_KEY_LENGTH = 53
+export const COMPRESSED_PUBLIC_KEY_LENGTH = 33
+export const CHAIN_CODE_LENGTH = 32
+export const MAX_PUBLIC_KEYS = 1000
+export const MAX_PUBLIC_KEYS_PER_RESPONSE = 7
+export const MAX_APDU_DATA_LENGTH = 255
+export const MAX_ACTIONS = 50
+export const MAX_SESSION_PAYEES = 4
+export const MAX_SESSION_LIFETIME_SECONDS = 24 * 60 * 60
+export const MAX_BENCHMARK_ITERATIONS = 10000
+
+export type ParsedSigningSession = {
+    chainId: HexString
+    path: ValidBIP32Path
+    spendingCap: Uint64_str
+    maxFee: Uint64_str
+    lifetimeSeconds: Uint32_t
+    payees: Array<string>
+}
 
 export type ParsedTransferFIOTokensData = {
     payee_public_key: string
@@ -92,6 +92,17 @@ export type Serial = {
  */
 export type BIP32Path = Array<number>
 
+/**
+ * Public key and chain code of the FIO account node `44'/235'/0'`.
+ * @category Basic types
+ * @see [[Fio.getAccountPublicKey]]
+ */
+export type AccountPublicKey = {
+    /** Uncompressed public key */
+    publicKeyHex: string
+    chainCodeHex: string
+}
+
 
 /**
  * Transaction witness.
@@ -124,9 +135,127 @@ export type SignedTransactionData = {
      * List of witnesses. Caller should assemble full transaction to be submitted to the network.
      */
     witness: Witness
+    /**
+     * Budget left in the signing session (see [[Fio.startSigningSession]]) after this transaction,
+     * undefined if the transaction was confirmed by the user
+     */
+    remainingSessionBudget?: string
+};
+
+/**
+ * Status of the signing session, see [[Fio.startSigningSession]]
+ * @category Basic types
+ */
+export type SigningSessionStatus = {
+    active: boolean
+    /** Amounts and max fees (in SUFs) which can still be signed */
+    remainingBudget: string
+    /** Approximate, the device counts UI ticks which stop while it derives keys and signs */
+    remainingLifetimeSeconds: number
 };
 
 
+/**
+ * How the device answers its prompts without the buttons (DEVEL app build with HEADLESS only)
+ * @category Basic types
+ * @see [[Fio.setHeadlessInteraction]]
+ */
+export enum HeadlessInteraction {
+    /** Wait for the buttons */
+    MANUAL = 0x00,
+    /** Confirm everything, the default */
+    CONFIRM = 0x01,
+    /** Reject prompts, paginated texts are still confirmed */
+    REJECT = 0x02,
+}
+
+/**
+ * Kernels timed by [[Fio.benchmark]] (DEVEL app build only)
+ * @category Basic types
+ */
+export enum BenchmarkKernel {
+    /** BIP32 derivation of 44'/235'/0'/0/0 */
+    BIP32_DERIVATION = 0x00,
+    /** Public key from the private key, `cx_ecfp_generate_pair` */
+    GENERATE_PAIR = 0x01,
+    /** Signature with a precomputed nonce, `cx_ecdsa_sign` */
+    ECDSA_SIGN = 0x02,
+    /** Deterministic nonce, `rng_rfc6979` */
+    RNG_RFC6979 = 0x03,
+    SHA_256_64_BYTES = 0x04,
+    SHA_256_256_BYTES = 0x05,
+    /** Over a compressed public key */
+    RIPEMD_160 = 0x06,
+    /** Of a compressed public key with checksum */
+    BASE58 = 0x07,
+}
+
+/**
+ * Phases of the handlers recorded by the profiler, see [[Fio.getProfile]]
+ * @category Basic types
+ */
+export enum ProfilePhase {
+    PARSE = 0x01,
+    HASH = 0x02,
+    POLICY = 0x03,
+    DERIVE = 0x04,
+    /** Value at the end is the number of signing attempts, more than 1 if `check_canonical` rejected a signature */
+    SIGN = 0x05,
+    /** Value at the end is 1 if the user confirmed, 0 if rejected */
+    UI = 0x06,
+    IO_SEND = 0x07,
+}
+
+/**
+ * Beginning or end of a phase recorded by the profiler
+ * @category Basic types
+ * @see [[Fio.getProfile]]
+ */
+export type ProfileRecord = {
+    /** Instruction being processed, 0xff if none */
+    ins: number
+    phase: ProfilePhase
+    isEnd: boolean
+    /** Meaning depends on the phase, e.g. the policy at the end of POLICY */
+    value: number
+    /** Ticker count of the device (100 ms), it advances only between APDUs */
+    ticker: number
+}
+
+/**
+ * Deepest stack use of an instruction, see [[Fio.getStackUsage]]
+ * @category Basic types
+ */
+export type InstructionStackUsage = {
+    /** 0xff for the time outside of any instruction, e.g. in the menu */
+    ins: number
+    /** High watermark in bytes, including the UI steps of the instruction */
+    maxUsed: number
+    /** Stack which was never reached */
+    minFree: number
+}
+
+/**
+ * Stack usage read by [[Fio.getStackUsage]]
+ * @category Basic types
+ */
+export type StackUsage = {
+    /** Bytes between the stack canary and the stack pointer at boot */
+    stackSize: number
+    instructions: Array<InstructionStackUsage>
+}
+
+/**
+ * Records read by [[Fio.getProfile]]
+ * @category Basic types
+ */
+export type Profile = {
+    /** All records since the last reset, including those overwritten in the ring buffer */
+    totalRecorded: number
+    /** Oldest first */
+    records: Array<ProfileRecord>
+}
+
 /**
  * Represents Transfer FIO Tokens trnsfiopubkey data.
  * @category Basic types
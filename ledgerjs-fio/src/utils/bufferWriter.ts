@@ -0,0 +1,159 @@
+import type {FixlenHexString, HexString, Uint8_t, Uint16_t, Uint32_t, Uint64_str} from "../types/internal"
+import {assert} from './assert'
+import {isHexString, isUint8, isUint16, isUint32, isUint64str, isValidPath} from "./parse"
+
+const UINT32_RANGE = 0x100000000
+
+/**
+ * Splits a decimal uint64 string into its high and low 32 bits.
+ * Both stay below 2^36 while parsing, so plain numbers are exact
+ * and we do not depend on the platform supporting BigInt.
+ */
+export function uint64_to_uint32_pair(value: Uint64_str): [number, number] {
+    assert(isUint64str(value), 'invalid uint64_str')
+
+    let high = 0
+    let low = 0
+    for (let i = 0; i < value.length; i++) {
+        low = low * 10 + (value.charCodeAt(i) - 0x30)
+        const carry = Math.floor(low / UINT32_RANGE)
+        low -= carry * UINT32_RANGE
+        high = high * 10 + carry
+    }
+    assert(high < UINT32_RANGE, "excessive data")
+    return [high, low]
+}
+
+export function varuint32_length(value: number): number {
+    let length = 1
+    while (value >= 0x80) {
+        value = Math.floor(value / 0x80)
+        length++
+    }
+    return length
+}
+
+/** Length of a varuint32 prefixed utf8 string */
+export function string_length(value: string): number {
+    const length = Buffer.byteLength(value, "utf8")
+    return varuint32_length(length) + length
+}
+
+/**
+ * Serializes straight into a single buffer allocated up front,
+ * integers are big endian unless the name says otherwise.
+ * The capacity must cover everything written.
+ */
+export class BufferWriter {
+    private data: Buffer
+    private offset = 0
+
+    constructor(capacity: number) {
+        this.data = Buffer.allocUnsafe(capacity)
+    }
+
+    get length(): number {
+        return this.offset
+    }
+
+    private reserve(length: number): number {
+        const start = this.offset
+        assert(start + length <= this.data.length, "buffer capacity exceeded")
+        this.offset += length
+        return start
+    }
+
+    uint8(value: Uint8_t): this {
+        assert(isUint8(value), 'invalid uint8')
+        this.data.writeUInt8(value, this.reserve(1))
+        return this
+    }
+
+    uint16(value: Uint16_t | Uint8_t): this {
+        assert(isUint16(value), 'invalid uint16')
+        this.data.writeUInt16BE(value, this.reserve(2))
+        return this
+    }
+
+    uint32(value: Uint32_t | Uint16_t | Uint8_t): this {
+        assert(isUint32(value), 'invalid uint32')
+        this.data.writeUInt32BE(value, this.reserve(4))
+        return this
+    }
+
+    uint64(value: Uint64_str): this {
+        const [high, low] = uint64_to_uint32_pair(value)
+        const start = this.reserve(8)
+        this.data.writeUInt32BE(high, start)
+        this.data.writeUInt32BE(low, start + 4)
+        return this
+    }
+
+    // Little endian and varuint32 encodings used by EOSIO packed transactions
+
+    uint16le(value: Uint16_t): this {
+        assert(isUint16(value), 'invalid uint16')
+        this.data.writeUInt16LE(value, this.reserve(2))
+        return this
+    }
+
+    uint32le(value: Uint32_t): this {
+        assert(isUint32(value), 'invalid uint32')
+        this.data.writeUInt32LE(value, this.reserve(4))
+        return this
+    }
+
+    uint64le(value: Uint64_str): this {
+        const [high, low] = uint64_to_uint32_pair(value)
+        const start = this.reserve(8)
+        this.data.writeUInt32LE(low, start)
+        this.data.writeUInt32LE(high, start + 4)
+        return this
+    }
+
+    varuint32(value: Uint32_t | Uint16_t | Uint8_t): this {
+        assert(isUint32(value), 'invalid uint32')
+        let rest: number = value
+        do {
+            let byte = rest & 0x7f
+            rest = Math.floor(rest / 0x80)
+            if (rest > 0) byte |= 0x80
+            this.data[this.reserve(1)] = byte
+        } while (rest > 0)
+        return this
+    }
+
+    /** varuint32 length followed by the utf8 bytes */
+    string(value: string): this {
+        const length = Buffer.byteLength(value, "utf8")
+        this.varuint32(length as Uint32_t)
+        this.data.write(value, this.reserve(length), length, "utf8")
+        return this
+    }
+
+    hex(value: HexString | FixlenHexString<any>): this {
+        assert(isHexString(value), "invalid hex string")
+        const length = value.length / 2
+        this.data.write(value, this.reserve(length), length, "hex")
+        return this
+    }
+
+    bytes(value: Buffer): this {
+        value.copy(this.data, this.reserve(value.length))
+        return this
+    }
+
+    path(path: Array<number>): this {
+        assert(isValidPath(path), "invalid bip32 path")
+        this.uint8(path.length as Uint8_t)
+        for (const index of path) {
+            this.data.writeUInt32BE(index, this.reserve(4))
+        }
+        return this
+    }
+
+    /** The written bytes, sharing memory with the writer */
+    toBuffer(): Buffer {
+        return this.data.slice(0, this.offset)
+    }
+}
@@ -0,0 +1,95 @@
+// @ts-ignore
+import BigInteger from "bigi"
+// @ts-ignore
+import bs58 from "bs58"
+import {createHash, createHmac} from "crypto"
+// @ts-ignore
+import ecurve from "ecurve"
+
+import {InvalidDataReason} from "../errors"
+import {CHAIN_CODE_LENGTH, PUBLIC_KEY_LENGTH} from "../types/internal"
+import type {AccountPublicKey} from "../types/public"
+import {HARDENED} from "../types/public"
+import {assert} from "./assert"
+import {parseHexStringOfLength, validate} from "./parse"
+import {hex_to_buf} from "./serialize"
+
+const secp256k1 = ecurve.getCurveByName("secp256k1")
+
+export const WIF_PREFIX = "FIO"
+
+export function compressed_public_key_to_wif(compressedKey: Buffer): string {
+    assert(compressedKey.length === 33, "invalid compressed public key")
+    const checksum = createHash("ripemd160").update(compressedKey).digest().slice(0, 4)
+    return WIF_PREFIX + bs58.encode(Buffer.concat([compressedKey, checksum]))
+}
+
+type Node = {
+    point: any
+    chainCode: Buffer
+}
+
+// BIP32 CKDpub, i.e. non-hardened child of a public node
+function deriveChild(parent: Node, index: number): Node {
+    assert(index >= 0 && index < HARDENED, "cannot derive hardened child from public key")
+
+    const data = Buffer.alloc(37)
+    parent.point.getEncoded(true).copy(data, 0)
+    data.writeUInt32BE(index, 33)
+    const I = createHmac("sha512", parent.chainCode).update(data).digest()
+
+    const IL = BigInteger.fromBuffer(I.slice(0, 32))
+    // probability below 2^-127, the spec says to proceed with the next index
+    assert(IL.compareTo(secp256k1.n) < 0, "invalid child key")
+
+    const point = secp256k1.G.multiply(IL).add(parent.point)
+    assert(!secp256k1.isInfinity(point), "invalid child key")
+
+    return {point, chainCode: I.slice(32)}
+}
+
+/**
+ * Derives FIO address keys `44'/235'/0'/chain/address` from the account public key
+ * exported by [[Fio.getAccountPublicKey]] without talking to the device.
+ *
+ * @example
+ * ```
+ * const deriver = new PublicKeyDeriver(await fio.getAccountPublicKey({path: [HARDENED + 44, HARDENED + 235, HARDENED + 0]}))
+ * const {publicKeyWIF} = deriver.deriveAddressKey(0, 5)
+ * ```
+ */
+export class PublicKeyDeriver {
+    private account: Node
+    // chain nodes are shared by all addresses on the chain
+    private chains: Map<number, Node> = new Map()
+
+    constructor({publicKeyHex, chainCodeHex}: AccountPublicKey) {
+        const errMsg = InvalidDataReason.INVALID_ACCOUNT_PUBLIC_KEY
+        const parsedPublicKey = parseHexStringOfLength(publicKeyHex, PUBLIC_KEY_LENGTH, errMsg)
+        const parsedChainCode = parseHexStringOfLength(chainCodeHex, CHAIN_CODE_LENGTH, errMsg)
+
+        const point = ecurve.Point.decodeFrom(secp256k1, hex_to_buf(parsedPublicKey))
+        validate(secp256k1.isOnCurve(point), errMsg)
+        this.account = {point, chainCode: hex_to_buf(parsedChainCode)}
+    }
+
+    private chainNode(chain: number): Node {
+        let node = this.chains.get(chain)
+        if (node == null) {
+            node = deriveChild(this.account, chain)
+            this.chains.set(chain, node)
+        }
+        return node
+    }
+
+    /**
+     * Returns the key in the same format as [[Fio.getPublicKey]]
+     */
+    deriveAddressKey(chain: number, address: number): {publicKeyHex: string, publicKeyWIF: string} {
+        const {point} = deriveChild(this.chainNode(chain), address)
+        return {
+            publicKeyHex: point.getEncoded(false).toString("hex"),
+            publicKeyWIF: compressed_public_key_to_wif(point.getEncoded(true)),
+        }
+    }
+}
@@ -6,6 +6,7 @@ import type {
     HexString,
     NameString,
     ParsedActionAuthorisation,
+    ParsedSigningSession,
     ParsedTransaction,
     Uint8_t,
     Uint16_t,
@@ -15,7 +16,8 @@ import type {
     VarlenAsciiString,
 } from "../types/internal"
 import type {ParsedAction, ParsedTransferFIOTokensData} from "../types/internal"
-import type {ActionAuthorisation, bigint_like, Transaction} from "../types/public"
+import {MAX_ACTIONS, MAX_SESSION_LIFETIME_SECONDS, MAX_SESSION_PAYEES} from "../types/internal"
+import type {Action, ActionAuthorisation, bigint_like, Transaction} from "../types/public"
 
 export const MAX_UINT_64_STR = "18446744073709551615"
 
@@ -212,16 +214,7 @@ export function parseAuthorization(authorization: ActionAuthorisation, errMsg: I
     }
 }
 
-export function parseTransaction(chainId: string, tx: Transaction): ParsedTransaction {
-    // validate tx (Transaction)
-    validate(isString(tx.expiration), InvalidDataReason.INVALID_EXPIRATION)
-    validate(isBigIntLike(tx.ref_block_num), InvalidDataReason.INVALID_REF_BLOCK_NUM)
-    validate(isBigIntLike(tx.ref_block_prefix), InvalidDataReason.INVALID_REF_BLOCK_PREFIX)
-    validate(tx.context_free_actions.length == 0, InvalidDataReason.CONTEXT_FREE_ACTIONS_NOT_SUPPORTED)
-
-    validate(tx.actions.length == 1, InvalidDataReason.MULTIPLE_ACTIONS_NOT_SUPPORTED)
-    const action = tx.actions[0]
-
+export function parseAction(action: Action): ParsedAction {
     // validate action
     validate(isString(action.account), InvalidDataReason.INVALID_ACCOUNT)
     validate(isString(action.name), InvalidDataReason.INVALID_NAME)
@@ -239,7 +232,6 @@ export function parseTransaction(chainId: string, tx: Transaction): ParsedTransa
     validate(isBigIntLike(action.data.amount), InvalidDataReason.INVALID_AMOUNT)
     validate(isBigIntLike(action.data.max_fee), InvalidDataReason.INVALID_MAX_FEE)
     validate(isString(action.data.tpid), InvalidDataReason.INVALID_TPID)
-    validate(action.data.tpid.length <= 20, InvalidDataReason.INVALID_TPID) 
     validate(isString(action.data.actor), InvalidDataReason.INVALID_ACTOR)
 
     const parsedActionData: ParsedTransferFIOTokensData = {
@@ -250,19 +242,58 @@ export function parseTransaction(chainId: string, tx: Transaction): ParsedTransa
         tpid: action.data.tpid,
     }
 
-    const parsedAction: ParsedAction = {
+    return {
         contractAccountName: parseContractAccountName(action.account, action.name,
             InvalidDataReason.ACTION_NOT_SUPPORTED),
         authorization: [parseAuthorization(authorization, InvalidDataReason.INVALID_ACTION_AUTHORIZATION)],
         data: parsedActionData,
     }
+}
+
+export function parseTransaction(chainId: string, tx: Transaction): ParsedTransaction {
+    // validate tx (Transaction)
+    validate(isString(tx.expiration), InvalidDataReason.INVALID_EXPIRATION)
+    validate(isBigIntLike(tx.ref_block_num), InvalidDataReason.INVALID_REF_BLOCK_NUM)
+    validate(isBigIntLike(tx.ref_block_prefix), InvalidDataReason.INVALID_REF_BLOCK_PREFIX)
+    validate(tx.context_free_actions.length == 0, InvalidDataReason.CONTEXT_FREE_ACTIONS_NOT_SUPPORTED)
+
+    validate(isArray(tx.actions), InvalidDataReason.INVALID_NUMBER_OF_ACTIONS)
+    validate(tx.actions.length >= 1 && tx.actions.length <= MAX_ACTIONS, InvalidDataReason.INVALID_NUMBER_OF_ACTIONS)
 
     return {
         expiration: tx.expiration,
         ref_block_num: parseUint16_t(tx.ref_block_num, InvalidDataReason.INVALID_REF_BLOCK_NUM),
         ref_block_prefix: parseUint32_t(tx.ref_block_prefix, InvalidDataReason.INVALID_REF_BLOCK_PREFIX),
         context_free_actions: [],
-        actions: [parsedAction],
+        actions: tx.actions.map((action) => parseAction(action)),
         transaction_extensions: null,
     }
 }
+
+export function parseSigningSession(
+    chainId: unknown,
+    path: unknown,
+    spendingCap: unknown,
+    maxFee: unknown,
+    lifetimeSeconds: unknown,
+    payees: unknown,
+): ParsedSigningSession {
+    validate(isArray(payees) && payees.length <= MAX_SESSION_PAYEES, InvalidDataReason.INVALID_NUMBER_OF_PAYEES)
+    const parsedPayees = payees.map((payee) => {
+        validate(isString(payee) && payee.length > 0 && payee.length <= 64, InvalidDataReason.INVALID_PAYEE_PUBKEY)
+        return payee
+    })
+    validate(
+        isUint32(lifetimeSeconds) && lifetimeSeconds > 0 && lifetimeSeconds <= MAX_SESSION_LIFETIME_SECONDS,
+        InvalidDataReason.INVALID_SESSION_LIFETIME,
+    )
+
+    return {
+        chainId: parseHexString(chainId, InvalidDataReason.INVALID_CHAIN_ID),
+        path: parseBIP32Path(path, InvalidDataReason.INVALID_PATH),
+        spendingCap: parseUint64_str(spendingCap, {min: "1"}, InvalidDataReason.INVALID_SPENDING_CAP),
+        maxFee: parseUint64_str(maxFee, {}, InvalidDataReason.INVALID_MAX_FEE),
+        lifetimeSeconds,
+        payees: parsedPayees,
+    }
+}
@@ -2,9 +2,10 @@ import basex from "base-x"
 
 import type {FixlenHexString, HexString, Uint8_t, Uint16_t, Uint32_t, Uint64_str} from "../types/internal"
 import {assert} from './assert'
-import {isHexString, isUint8, isUint16, isUint32, isUint64str, isValidPath} from "./parse"
+import {BufferWriter} from "./bufferWriter"
+import {isHexString, isUint8, isUint16, isUint32, isValidPath} from "./parse"
 
-// We use bs10 as an easy way to parse/encode amount strings
+// We use bs10 as an easy way to encode amount strings
 const bs10 = basex("0123456789")
 
 export function uint8_to_buf(value: Uint8_t): Buffer {
@@ -43,13 +44,15 @@ export function buf_to_uint32(data: Buffer): Uint32_t {
 }
 
 export function uint64_to_buf(value: Uint64_str): Buffer {
-    assert(isUint64str(value), 'invalid uint64_str')
+    return new BufferWriter(8).uint64(value).toBuffer()
+}
 
-    const data = bs10.decode(value)
-    assert(data.length <= 8, "excessive data")
+export function buf_to_uint64(data: Buffer): Uint64_str {
+    assert(data.length === 8, "invalid uint64 buffer")
 
-    const padding = Buffer.alloc(8 - data.length)
-    return Buffer.concat([padding, data])
+    // bs10 encodes each leading zero byte as "0"
+    const value = bs10.encode(data).replace(/^0+/, "")
+    return (value === "" ? "0" : value) as Uint64_str
 }
 
 export function hex_to_buf(data: HexString | FixlenHexString<any>): Buffer {
@@ -75,8 +78,49 @@ export function path_to_buf(path: Array<number>): Buffer {
     return data
 }
 
-export function date_to_buf(date: string): Buffer {
+// Little endian and varuint32 encodings used by EOSIO packed transactions
+
+export function uint16le_to_buf(value: Uint16_t): Buffer {
+    assert(isUint16(value), 'invalid uint16')
+
+    const data = Buffer.alloc(2)
+    data.writeUInt16LE(value, 0)
+    return data
+}
+
+export function uint32le_to_buf(value: Uint32_t): Buffer {
+    assert(isUint32(value), 'invalid uint32')
+
+    const data = Buffer.alloc(4)
+    data.writeUInt32LE(value, 0)
+    return data
+}
+
+export function uint64le_to_buf(value: Uint64_str): Buffer {
+    return new BufferWriter(8).uint64le(value).toBuffer()
+}
+
+export function varuint32_to_buf(value: Uint32_t | Uint16_t | Uint8_t): Buffer {
+    assert(isUint32(value), 'invalid uint32')
+
+    const bytes = []
+    let rest: number = value
+    do {
+        let byte = rest & 0x7f
+        rest = Math.floor(rest / 0x80)
+        if (rest > 0) byte |= 0x80
+        bytes.push(byte)
+    } while (rest > 0)
+    return Buffer.from(bytes)
+}
+
+export function string_to_buf(value: string): Buffer {
+    const data = Buffer.from(value, "utf8")
+    return Buffer.concat([varuint32_to_buf(data.length as Uint32_t), data])
+}
+
+export function date_to_uint32(date: string): Uint32_t {
     const parsedDate: number = Date.parse(date + 'Z')
     assert(!Number.isNaN(parsedDate), "Invalid timepoint")
-    return uint32_to_buf(Math.round(parsedDate / 1000) as Uint32_t)
-}
\ No newline at end of file
+    return Math.round(parsedDate / 1000) as Uint32_t
+}
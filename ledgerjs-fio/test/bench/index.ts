@@ -0,0 +1,132 @@
+// Measures per-interaction latency and sustained throughput of the app.
+// Needs the DEVEL build with HEADLESS (prompts are confirmed automatically),
+// ideally running in Speculos (LEDGER_TRANSPORT=speculos, see test_utils.ts).
+// LEDGER_TRANSPORT=simulator measures the SDK alone against the simulated device.
+//
+//   yarn bench                     all benchmarks, 100 iterations each
+//   BENCH_ITERATIONS=1000 yarn bench
+//   BENCH_OUT=results.json yarn bench
+import {mkdirSync, writeFileSync} from "fs"
+import {dirname} from "path"
+import {performance} from "perf_hooks"
+
+import type Fio from "../../src/fio"
+import {HARDENED, HeadlessInteraction} from "../../src/fio"
+import type {Transaction} from "../../src/types/public"
+import {getFio, useSimulator} from "../test_utils"
+import type {LatencyStats} from "./stats"
+import {latencyStats} from "./stats"
+
+const iterations = parseInt(process.env.BENCH_ITERATIONS || "100")
+const out = process.env.BENCH_OUT || `bench-results/bench-${new Date().toISOString().replace(/[:.]/g, "-")}.json`
+
+const path = [44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0]
+const testnetChainId = "b20901380af44ef59c5918439a1f9a41d83669020319a80574b804a5f95cbd7e"
+
+const tx: Transaction = {
+    expiration: "2021-08-28T12:50:36.686",
+    ref_block_num: 0x1122,
+    ref_block_prefix: 0x33445566,
+    context_free_actions: [],
+    actions: [{
+        account: "fio.token",
+        name: "trnsfiopubky",
+        authorization: [{
+            actor: "aftyershcu22",
+            permission: "active",
+        }],
+        data: {
+            payee_public_key: "FIO8PRe4WRZJj5mkem6qVGKyvNFgPsNnjNN6kPhh6EaCpzCVin5Jj",
+            amount: "20",
+            max_fee: 0x11223344,
+            tpid: "rewards@wallet",
+            actor: "aftyershcu22",
+        },
+    }],
+    transaction_extensions: [],
+}
+
+type Benchmark = {
+    name: string
+    run: (fio: Fio, i: number) => Promise<unknown>
+}
+
+const benchmarks: Array<Benchmark> = [
+    {
+        name: "getVersion",
+        run: (fio) => fio.getVersion(),
+    },
+    {
+        name: "getPublicKey",
+        run: (fio) => fio.getPublicKey({path, show_or_not: false}),
+    },
+    {
+        name: "getPublicKey (shown)",
+        run: (fio) => fio.getPublicKey({path, show_or_not: true}),
+    },
+    {
+        name: "signTransaction",
+        // a different transaction each time, as a batch payout would have
+        run: (fio, i) => fio.signTransaction({
+            path,
+            chainId: testnetChainId,
+            tx: {...tx, ref_block_num: i & 0xffff},
+        }),
+    },
+]
+
+async function measure(fio: Fio, benchmark: Benchmark): Promise<LatencyStats> {
+    // warm up, the first call pays for the key derivation
+    await benchmark.run(fio, 0)
+
+    const latencies: Array<number> = []
+    const start = performance.now()
+    for (let i = 0; i < iterations; i++) {
+        const t0 = performance.now()
+        await benchmark.run(fio, i)
+        latencies.push(performance.now() - t0)
+    }
+    const totalMs = performance.now() - start
+    return latencyStats(latencies, totalMs)
+}
+
+async function main() {
+    const fio = await getFio()
+    try {
+        const {version} = await fio.getVersion()
+        // the simulator confirms everything by itself
+        if (!useSimulator) {
+            if (!version.flags.isDebug) {
+                throw new Error("the benchmark needs the DEVEL build of the app (with HEADLESS)")
+            }
+            await fio.setHeadlessInteraction(HeadlessInteraction.CONFIRM)
+        }
+
+        const results: {[name: string]: LatencyStats} = {}
+        for (const benchmark of benchmarks) {
+            const stats = await measure(fio, benchmark)
+            results[benchmark.name] = stats
+            console.log(
+                `${benchmark.name.padEnd(24)} p50 ${stats.p50Ms.toFixed(1)} ms, ` +
+                `p99 ${stats.p99Ms.toFixed(1)} ms, ${stats.perMinute.toFixed(0)}/min`,
+            )
+        }
+
+        mkdirSync(dirname(out), {recursive: true})
+        writeFileSync(out, JSON.stringify({
+            date: new Date().toISOString(),
+            transport: process.env.LEDGER_TRANSPORT || "hid",
+            appVersion: `${version.major}.${version.minor}.${version.patch}`,
+            iterations,
+            results,
+        }, null, 2))
+        console.log(`Results saved to ${out}`)
+    } finally {
+        await (fio as any).t.close()
+    }
+}
+
+main().catch((e) => {
+    console.error(e)
+    process.exit(1)
+})
@@ -0,0 +1,94 @@
+// Measures the host side of signTransaction: serialization time and Buffer
+// allocations per transaction, no device needed.
+//
+//   yarn bench-serialize
+//   BENCH_ITERATIONS=100000 yarn bench-serialize
+import {performance} from "perf_hooks"
+
+import {InvalidDataReason} from "../../src/errors"
+import {HARDENED} from "../../src/fio"
+import {getSignTransactionTemplate, serializeTransaction} from "../../src/interactions/signTransaction"
+import type {Transaction} from "../../src/types/public"
+import {parseBIP32Path, parseTransaction} from "../../src/utils/parse"
+import {latencyStats} from "./stats"
+
+const iterations = parseInt(process.env.BENCH_ITERATIONS || "10000")
+
+const path = parseBIP32Path([44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0], InvalidDataReason.INVALID_PATH)
+const testnetChainId = "b20901380af44ef59c5918439a1f9a41d83669020319a80574b804a5f95cbd7e"
+
+const action = {
+    account: "fio.token",
+    name: "trnsfiopubky",
+    authorization: [{
+        actor: "aftyershcu22",
+        permission: "active",
+    }],
+    data: {
+        payee_public_key: "FIO8PRe4WRZJj5mkem6qVGKyvNFgPsNnjNN6kPhh6EaCpzCVin5Jj",
+        amount: "123456789012345678",
+        max_fee: 0x11223344,
+        tpid: "rewards@wallet",
+        actor: "aftyershcu22",
+    },
+}
+
+const tx: Transaction = {
+    expiration: "2021-08-28T12:50:36.686",
+    ref_block_num: 0x1122,
+    ref_block_prefix: 0x33445566,
+    context_free_actions: [],
+    actions: [action],
+    transaction_extensions: [],
+}
+
+const cases: Array<{name: string, tx: Transaction}> = [
+    {name: "1 action", tx},
+    {name: "10 actions", tx: {...tx, actions: Array(10).fill(action)}},
+]
+
+// counts the calls of the Buffer factories while `run` executes
+function countAllocations(run: () => void): number {
+    const factories = ["alloc", "allocUnsafe", "allocUnsafeSlow", "from", "concat"] as const
+    const originals = factories.map((name) => Buffer[name])
+    let count = 0
+    factories.forEach((name, i) => {
+        (Buffer as any)[name] = (...args: Array<any>) => {
+            count++
+            return (originals[i] as any).apply(Buffer, args)
+        }
+    })
+    try {
+        run()
+    } finally {
+        factories.forEach((name, i) => {
+            (Buffer as any)[name] = originals[i]
+        })
+    }
+    return count
+}
+
+for (const {name, tx} of cases) {
+    const parsedTx = parseTransaction(testnetChainId, tx)
+    // what signTransaction does on the host before the first APDU
+    const serialize = () => {
+        getSignTransactionTemplate(path, testnetChainId, parsedTx)
+        serializeTransaction(parsedTx)
+    }
+
+    serialize()
+    const allocations = countAllocations(serialize)
+
+    const latencies: Array<number> = []
+    const start = performance.now()
+    for (let i = 0; i < iterations; i++) {
+        const t0 = performance.now()
+        serialize()
+        latencies.push(performance.now() - t0)
+    }
+    const stats = latencyStats(latencies, performance.now() - start)
+    console.log(
+        `${name.padEnd(12)} ${allocations} Buffer allocations, ` +
+        `p50 ${(stats.p50Ms * 1000).toFixed(1)} us, p99 ${(stats.p99Ms * 1000).toFixed(1)} us`,
+    )
+}
@@ -0,0 +1,27 @@
+export type LatencyStats = {
+    iterations: number
+    p50Ms: number
+    p99Ms: number
+    meanMs: number
+    // sustained rate over the whole run, including the host side
+    perMinute: number
+}
+
+// nearest-rank percentile of sorted samples
+export function percentile(sorted: Array<number>, p: number): number {
+    if (sorted.length === 0) return NaN
+    const rank = Math.ceil(p / 100 * sorted.length)
+    return sorted[Math.min(Math.max(rank, 1), sorted.length) - 1]
+}
+
+export function latencyStats(latenciesMs: Array<number>, totalMs: number): LatencyStats {
+    const sorted = [...latenciesMs].sort((a, b) => a - b)
+    const sum = sorted.reduce((acc, x) => acc + x, 0)
+    return {
+        iterations: sorted.length,
+        p50Ms: percentile(sorted, 50),
+        p99Ms: percentile(sorted, 99),
+        meanMs: sorted.length ? sum / sorted.length : NaN,
+        perMinute: totalMs > 0 ? sorted.length / totalMs * 60000 : NaN,
+    }
+}
@@ -0,0 +1,42 @@
+import chai, {expect} from "chai"
+import chaiAsPromised from 'chai-as-promised'
+
+import type Fio from "../../src/fio"
+import {DeviceStatusError, PublicKeyDeriver} from "../../src/fio"
+import {str_to_path} from "../../src/utils/address"
+import {getFio} from "../test_utils"
+import {testsPublicKey} from "./__fixtures__/getPublicKey"
+
+chai.use(chaiAsPromised)
+
+describe("getAccountPublicKey", async () => {
+    let fio: Fio = {} as Fio
+
+    beforeEach(async () => {
+        fio = await getFio()
+    })
+
+    afterEach(async () => {
+        await (fio as any).t.close()
+    })
+
+    it("derives the same keys as the device", async () => {
+        const accountKey = await fio.getAccountPublicKey({path: str_to_path("44'/235'/0'")})
+        const deriver = new PublicKeyDeriver(accountKey)
+
+        for (const {path, expected} of testsPublicKey) {
+            const [chain, address] = str_to_path(path).slice(3)
+            expect(deriver.deriveAddressKey(chain, address).publicKeyHex).to.equal(expected.publicKey)
+        }
+    })
+
+    it("rejects non-account paths", async () => {
+        const promise = fio.getAccountPublicKey({path: str_to_path("44'/235'/0'/0/0")})
+        await expect(promise).to.be.rejectedWith(DeviceStatusError, "Action rejected by Ledger's security policy")
+    })
+
+    it("rejects other accounts", async () => {
+        const promise = fio.getAccountPublicKey({path: str_to_path("44'/235'/1'")})
+        await expect(promise).to.be.rejectedWith(DeviceStatusError, "Action rejected by Ledger's security policy")
+    })
+})
@@ -2,9 +2,10 @@ import chai, {expect} from "chai"
 import chaiAsPromised from 'chai-as-promised'
 
 import type Fio from "../../src/fio"
-import {DeviceStatusError} from "../../src/fio"
+import type {GetPublicKeysItem} from "../../src/fio"
+import {DeviceStatusError, InvalidData} from "../../src/fio"
 import {str_to_path} from "../../src/utils/address"
-import {getFio} from "../test_utils"
+import {getFio, pressButtons} from "../test_utils"
 import type {TestCase} from "./__fixtures__/getPublicKey"
 import {testsPublicKey} from "./__fixtures__/getPublicKey"
 
@@ -41,11 +42,22 @@ describe("getPublicKey", async () => {
     })
 
     describe("Should successfully show a single extended public key", async () => {
+        // walks through the screens, the right button also confirms the final prompt
+        const approve = async <T>(promise: Promise<T>): Promise<T> => {
+            let done = false
+            promise.then(() => { done = true }, () => { done = true })
+            while (!done) {
+                await new Promise(resolve => setTimeout(resolve, 200))
+                if (!done) await pressButtons(fio, "Rr")
+            }
+            return promise
+        }
+
         const test = async (tests: TestCase[]) => {
             for (const {path, expected} of tests) {
-                const response = await fio.getPublicKey(
+                const response = await approve(fio.getPublicKey(
                     {path: str_to_path(path), show_or_not: true}
-                )
+                ))
 
                 expect(response.publicKeyHex).to.equal(expected.publicKey)
             }
@@ -83,4 +95,64 @@ describe("getPublicKey", async () => {
         })
     })
 
+    describe("Should successfully export a batch of public keys", () => {
+        const collect = async (path: string, count: number) => {
+            const items: GetPublicKeysItem[] = []
+            for await (const item of fio.getPublicKeys({path: str_to_path(path), count})) {
+                items.push(item)
+            }
+            return items
+        }
+
+        it('matches single key export', async () => {
+            // 10 keys span two response chunks
+            const items = await collect("44'/235'/0'/0/0", 10)
+            expect(items.length).to.equal(10)
+
+            for (const [i, item] of items.entries()) {
+                expect(item.path).to.deep.equal(str_to_path(`44'/235'/0'/0/${i}`))
+                const single = await fio.getPublicKey({path: item.path, show_or_not: false})
+                expect(item.publicKeyHex).to.equal(Ecc.PublicKey(single.publicKeyWIF).toBuffer().toString('hex'))
+            }
+        })
+
+        it('fio', async () => {
+            for (const {path, expected} of testsPublicKey) {
+                const [item] = await collect(path, 1)
+                expect(Ecc.PublicKey.fromBuffer(Buffer.from(item.publicKeyHex, 'hex')).toUncompressed().toBuffer().toString('hex'))
+                    .to.equal(expected.publicKey)
+            }
+        })
+
+        it('can be abandoned midway', async () => {
+            for await (const item of fio.getPublicKeys({path: str_to_path("44'/235'/0'/0/0"), count: 20})) {
+                expect(item.publicKeyHex.length).to.equal(66)
+                break
+            }
+            // the device is still in the batch, so this gets ERR_STILL_IN_CALL and is retried
+            const response = await fio.getPublicKey({path: str_to_path("44'/235'/0'/0/0"), show_or_not: false})
+            expect(response.publicKeyHex).to.equal(testsPublicKey[0].expected.publicKey)
+        })
+    })
+
+    describe("Should reject invalid batch requests", () => {
+        const first = async (path: string, count: number) => {
+            for await (const item of fio.getPublicKeys({path: str_to_path(path), count})) {
+                return item
+            }
+            return null
+        }
+
+        it('zero keys', async () => {
+            await expect(first("44'/235'/0'/0/0", 0)).to.be.rejectedWith(InvalidData)
+        })
+
+        it('too many keys', async () => {
+            await expect(first("44'/235'/0'/0/0", 1001)).to.be.rejectedWith(InvalidData)
+        })
+
+        it('path contains non-zero chain', async () => {
+            await expect(first("44'/235'/0'/1/0", 5)).to.be.rejectedWith(DeviceStatusError)
+        })
+    })
 })
@@ -18,7 +18,7 @@ describe("getVersion", async () => {
         const {version, compatibility} = await fio.getVersion()
 
         expect(version.major).to.equal(0)
-        expect(version.minor).to.equal(0)
+        expect(version.minor).to.equal(1)
         expect(compatibility.isCompatible).to.be.true
         expect(compatibility.recommendedVersion).to.be.null
     })
@@ -44,17 +44,15 @@ async function buildTxAndSignatureFioJs(network: string, tx: Transaction, pubkey
     // Get the addaddress action type
     const actionAddaddress = networkInfo[network].typesFioAddress.get('trnsfiopubky')
 
-    // Serialize the actions[] "data" field (This example assumes a single action, though transactions may hold an array of actions.)
-    const buffer = new ser.SerialBuffer({textEncoder, textDecoder})
-    actionAddaddress.serialize(buffer, tx.actions[0].data)
-    const serializedData = arrayToHex(buffer.asUint8Array())
-
-    // Get the actions parameter from the transaction and replace the data field with the serialized data field
-    var serializedAction = tx.actions[0] as any
-    serializedAction = {
-        ...serializedAction,
-        data: serializedData,
-    }
+    // Serialize the actions[] "data" field and replace it with the serialized data
+    const serializedActions = tx.actions.map((action) => {
+        const buffer = new ser.SerialBuffer({textEncoder, textDecoder})
+        actionAddaddress.serialize(buffer, action.data)
+        return {
+            ...action,
+            data: arrayToHex(buffer.asUint8Array()),
+        }
+    })
 
     const rawTransaction = {
         ...tx,
@@ -62,7 +60,7 @@ async function buildTxAndSignatureFioJs(network: string, tx: Transaction, pubkey
         max_cpu_usage_ms: 0x00,
         delay_sec: 0x00,
         context_free_actions: [],
-        actions: [serializedAction],     //Actions have to be an array
+        actions: serializedActions,
         transaction_extensions: [],
     }
 
@@ -208,6 +206,26 @@ describe("signTransaction", async () => {
         expect(signatureLedger.verify(fullMsg, publicKey)).to.be.false
     })
 
+    it("Sign testnet transaction with more actions", async () => {
+        const network = "TESTNET"
+        const secondAction = {
+            ...basicTx.actions[0],
+            data: {...basicTx.actions[0].data, amount: "30", tpid: ""},
+        }
+        const tx: Transaction = {...basicTx, actions: [basicTx.actions[0], secondAction, basicTx.actions[0]]}
+
+        // Lets sign the transaction with fiojs
+        const {fullMsg, hash} = await buildTxAndSignatureFioJs(network, tx, publicKey)
+
+        // Lets sign the transaction with ledger
+        const chainId = networkInfo[network].chainId
+        const ledgerResponse = await fio.signTransaction({path, chainId, tx})
+        const signatureLedger = Signature.fromHex(ledgerResponse.witness.witnessSignatureHex)
+
+        expect(ledgerResponse.txHashHex).to.be.equal(hash)
+        expect(signatureLedger.verify(fullMsg, publicKey)).to.be.true
+    })
+
     it("Invalid transaction: actor dont match", async () => {
         const network = "MAINNET"
         const action = {...basicTx.actions[0], name: "name.error"}
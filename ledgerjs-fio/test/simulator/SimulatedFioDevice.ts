@@ -0,0 +1,463 @@
+import Transport from "@ledgerhq/hw-transport"
+import {randomBytes} from "crypto"
+
+import {HARDENED} from "../../src/types/public"
+import {SimulatedDeviceError, SW, VALIDATE} from "./errors"
+import {compressPublicKey, DEFAULT_MNEMONIC, KeyStore, mnemonicToSeed, publicKeyToWif, sha256, signHash} from "./keys"
+import {parsePackedTx} from "./txParser"
+
+// An in-process FIO app speaking the APDU protocol of ledger-app-fio,
+// for SDK development and load tests without a device.
+//
+// Implements INS 0x00 (version), 0x01 (serial), 0x02 (last response),
+// 0x10 (public keys) and 0x20 (sign transaction) in the raw and template
+// modes used by the SDK. The field-by-field signing (P1 0x01-0x05, 0x08)
+// is answered with ERR_INVALID_REQUEST_PARAMETERS, other INS with ERR_UNKNOWN_INS.
+// Screens cost no time, prompts are answered by `options.prompt`.
+
+const CLA = 0xd7
+
+const MAX_PUBLIC_KEYS = 1000
+const MAX_PUBLIC_KEYS_PER_RESPONSE = 7
+const BIP44_MAX_PATH_ELEMENTS = 10
+const CHAIN_ID_LENGTH = 32
+const TEMPLATE_TX_HEADER_LENGTH = 10
+
+const KNOWN_CHAIN_IDS = [
+    "b20901380af44ef59c5918439a1f9a41d83669020319a80574b804a5f95cbd7e", // testnet
+    "21dcae42c0182200e93f954a074011f9048a7624c6fe81d3c9541a614a88bd1c", // mainnet
+]
+
+export type SimulatedFioDeviceOptions = {
+    /** BIP39 mnemonic, the default one of Speculos if not given */
+    mnemonic?: string
+    version?: {major: number, minor: number, patch: number, isDebug: boolean}
+    /** 7 bytes in hex, to tell several simulated devices apart */
+    serial?: string
+    /** Delay of each APDU round trip, 0 by default */
+    apduLatencyMs?: number | (() => number)
+    /** Time the user needs to answer a prompt, 0 by default */
+    userLatencyMs?: number | (() => number)
+    /** Answers the prompts, true confirms, everything is confirmed by default */
+    prompt?: (text: string) => boolean
+}
+
+type SignTxState = {
+    stage: "INIT" | "RAW_TX" | "WITNESS" | "NONE"
+    chainId: Buffer
+    packedTx: Buffer
+    rawBytesRemaining: number
+    // set if the path was sent at the start (early witness or template)
+    witnessPath: Array<number> | null
+}
+
+type Template = {
+    chainId: Buffer
+    shared: Buffer
+    witnessPath: Array<number>
+}
+
+type Handler = (p1: number, p2: number, data: Buffer, isNewCall: boolean) => Promise<Buffer> | Buffer
+
+type Batch = {
+    path: Array<number>
+    remainingKeys: number
+}
+
+function delay(latency: number | (() => number) | undefined): Promise<void> {
+    const ms = typeof latency === "function" ? latency() : (latency ?? 0)
+    return ms > 0 ? new Promise((resolve) => setTimeout(resolve, ms)) : Promise.resolve()
+}
+
+function statusWord(sw: number): Buffer {
+    const buf = Buffer.alloc(2)
+    buf.writeUInt16BE(sw)
+    return buf
+}
+
+// bip44_parseFromWire
+function parsePath(data: Buffer): {path: Array<number>, size: number} {
+    VALIDATE(data.length >= 1, SW.ERR_INVALID_DATA)
+    const length = data[0]
+    VALIDATE(length <= BIP44_MAX_PATH_ELEMENTS, SW.ERR_INVALID_DATA)
+    VALIDATE(length * 4 + 1 <= data.length, SW.ERR_INVALID_DATA)
+    const path = []
+    for (let i = 0; i < length; i++) {
+        path.push(data.readUInt32BE(1 + 4 * i))
+    }
+    return {path, size: 1 + 4 * length}
+}
+
+// 44'/235'/0'/0/address, as required by the witness and the key export policies
+function isAddressPath(path: Array<number>): boolean {
+    return path.length === 5 &&
+        path[0] === 44 + HARDENED &&
+        path[1] === 235 + HARDENED &&
+        path[2] === 0 + HARDENED &&
+        path[3] === 0
+}
+
+export class SimulatedFioDevice extends Transport<string> {
+    private keys: KeyStore
+    private currentIns: number | null = null
+
+    private signTx: SignTxState | null = null
+    private template: Template | null = null
+    private batch: Batch | null = null
+    private lastResponse = {
+        nonce: randomBytes(4).readUInt32BE() || 1,
+        sequence: 0,
+        ins: 0,
+        data: Buffer.alloc(0),
+    }
+
+    /** Number of APDUs exchanged so far */
+    apduCount = 0
+
+    constructor(private options: SimulatedFioDeviceOptions = {}) {
+        super()
+        this.keys = new KeyStore(mnemonicToSeed(options.mnemonic ?? DEFAULT_MNEMONIC))
+    }
+
+    async exchange(apdu: Buffer): Promise<Buffer> {
+        this.apduCount++
+        await delay(this.options.apduLatencyMs)
+        try {
+            const response = await this.handleApdu(apdu)
+            return Buffer.concat([response, statusWord(SW.SUCCESS)])
+        } catch (e) {
+            if (!(e instanceof SimulatedDeviceError)) throw e
+            // errors respond automatically and reset the call in progress
+            this.currentIns = null
+            return statusWord(e.sw)
+        }
+    }
+
+    async close(): Promise<void> {
+        return
+    }
+
+    private async handleApdu(apdu: Buffer): Promise<Buffer> {
+        VALIDATE(apdu.length >= 5, SW.ERR_MALFORMED_REQUEST_HEADER)
+        const [cla, ins, p1, p2, lc] = apdu
+        VALIDATE(apdu.length === 5 + lc, SW.ERR_MALFORMED_REQUEST_HEADER)
+        VALIDATE(cla === CLA, SW.ERR_BAD_CLA)
+        const data = apdu.slice(5)
+
+        const handler = this.lookupHandler(ins)
+        VALIDATE(handler != null, SW.ERR_UNKNOWN_INS)
+
+        let isNewCall = false
+        if (this.currentIns == null) {
+            isNewCall = true
+            this.currentIns = ins
+        } else {
+            VALIDATE(ins === this.currentIns, SW.ERR_STILL_IN_CALL)
+        }
+        return await handler.call(this, p1, p2, data, isNewCall)
+    }
+
+    private lookupHandler(ins: number): Handler | null {
+        switch (ins) {
+        case 0x00: return this.getVersion
+        case 0x01: return this.getSerial
+        case 0x02: return this.getLastResponse
+        case 0x10: return this.getPublicKey
+        case 0x20: return this.signTransaction
+        default: return null
+        }
+    }
+
+    // the instruction is finished, the next APDU starts a new call
+    private idle() {
+        this.currentIns = null
+    }
+
+    private async userConfirms(text: string): Promise<boolean> {
+        await delay(this.options.userLatencyMs)
+        return this.options.prompt ? this.options.prompt(text) : true
+    }
+
+    private saveLastResponse(data: Buffer) {
+        this.lastResponse.sequence++
+        this.lastResponse.ins = this.currentIns ?? 0
+        this.lastResponse.data = Buffer.from(data)
+    }
+
+    // ============================== INS 0x00-0x02 ==============================
+
+    private async getVersion(p1: number, p2: number, data: Buffer): Promise<Buffer> {
+        VALIDATE(p1 === 0 && p2 === 0, SW.ERR_INVALID_REQUEST_PARAMETERS)
+        VALIDATE(data.length === 0, SW.ERR_INVALID_DATA)
+        const version = this.options.version ?? {major: 0, minor: 1, patch: 0, isDebug: false}
+        this.idle()
+        return Buffer.from([version.major, version.minor, version.patch, version.isDebug ? 1 : 0])
+    }
+
+    private async getSerial(p1: number, p2: number, data: Buffer): Promise<Buffer> {
+        VALIDATE(p1 === 0 && p2 === 0, SW.ERR_INVALID_REQUEST_PARAMETERS)
+        VALIDATE(data.length === 0, SW.ERR_INVALID_REQUEST_PARAMETERS)
+        this.idle()
+        return Buffer.from(this.options.serial ?? "53494d46494f00", "hex")
+    }
+
+    private lastResponseStatus(): Buffer {
+        const header = Buffer.alloc(9)
+        header.writeUInt32BE(this.lastResponse.nonce, 0)
+        header.writeUInt32BE(this.lastResponse.sequence, 4)
+        header[8] = this.lastResponse.ins
+        return header
+    }
+
+    private async getLastResponse(p1: number, p2: number, data: Buffer): Promise<Buffer> {
+        VALIDATE(p2 === 0, SW.ERR_INVALID_REQUEST_PARAMETERS)
+        const header = this.lastResponseStatus()
+
+        switch (p1) {
+        case 0x01:
+            VALIDATE(data.length === 0, SW.ERR_INVALID_REQUEST_PARAMETERS)
+            this.idle()
+            return header
+        case 0x02:
+            VALIDATE(data.length === 8, SW.ERR_INVALID_DATA)
+            VALIDATE(this.lastResponse.sequence > 0, SW.ERR_INVALID_STATE)
+            VALIDATE(data.readUInt32BE(0) === this.lastResponse.nonce, SW.ERR_INVALID_STATE)
+            VALIDATE(data.readUInt32BE(4) === this.lastResponse.sequence, SW.ERR_INVALID_STATE)
+            this.idle()
+            return Buffer.concat([header, this.lastResponse.data])
+        default:
+            throw new SimulatedDeviceError(SW.ERR_INVALID_REQUEST_PARAMETERS)
+        }
+    }
+
+    // ============================== INS 0x10 ==============================
+
+    private async getPublicKey(p1: number, p2: number, data: Buffer, isNewCall: boolean): Promise<Buffer> {
+        VALIDATE(p2 === 0, SW.ERR_INVALID_REQUEST_PARAMETERS)
+
+        if (p1 === 0x04) {
+            VALIDATE(!isNewCall, SW.ERR_INVALID_STATE)
+            VALIDATE(this.batch != null, SW.ERR_INVALID_STATE)
+            VALIDATE(data.length === 0, SW.ERR_INVALID_DATA)
+            return this.nextBatchChunk()
+        }
+        // an abandoned batch export is treated like an unfinished call of another instruction
+        VALIDATE(isNewCall || this.batch == null, SW.ERR_STILL_IN_CALL)
+        VALIDATE(isNewCall, SW.ERR_INVALID_STATE)
+        this.batch = null
+
+        if (p1 === 0x03) {
+            const {path, size} = parsePath(data)
+            VALIDATE(data.length === size + 4, SW.ERR_INVALID_DATA)
+            const numKeys = data.readUInt32BE(size)
+            // policyForGetPublicKeysBatch, unusual ranges are only warned about
+            VALIDATE(isAddressPath(path), SW.ERR_REJECTED_BY_POLICY)
+            VALIDATE(numKeys > 0 && numKeys <= MAX_PUBLIC_KEYS, SW.ERR_REJECTED_BY_POLICY)
+            VALIDATE(path[4] + numKeys <= HARDENED, SW.ERR_REJECTED_BY_POLICY)
+            this.batch = {path, remainingKeys: numKeys}
+            return this.nextBatchChunk()
+        }
+
+        VALIDATE(p1 === 0x01 || p1 === 0x02, SW.ERR_INVALID_REQUEST_PARAMETERS)
+        const {path, size} = parsePath(data)
+        VALIDATE(size === data.length, SW.ERR_INVALID_DATA)
+        // policyForGetPublicKey, an unusual address is only warned about
+        VALIDATE(isAddressPath(path), SW.ERR_REJECTED_BY_POLICY)
+
+        const {publicKey} = this.keys.derive(path)
+        if (p1 === 0x01 && !await this.userConfirms("Confirm export public key?")) {
+            throw new SimulatedDeviceError(SW.ERR_REJECTED_BY_USER)
+        }
+        const response = Buffer.concat([publicKey, Buffer.from(publicKeyToWif(publicKey))])
+        this.saveLastResponse(response)
+        this.idle()
+        return response
+    }
+
+    private nextBatchChunk(): Buffer {
+        const batch = this.batch!
+        const numKeys = Math.min(batch.remainingKeys, MAX_PUBLIC_KEYS_PER_RESPONSE)
+        const keys = []
+        for (let i = 0; i < numKeys; i++) {
+            keys.push(compressPublicKey(this.keys.derive(batch.path).publicKey))
+            batch.remainingKeys--
+            batch.path = [...batch.path.slice(0, 4), batch.path[4] + 1]
+        }
+        if (batch.remainingKeys === 0) {
+            this.batch = null
+            this.idle()
+        }
+        return Buffer.concat(keys)
+    }
+
+    // ============================== INS 0x20 ==============================
+
+    private async signTransaction(p1: number, p2: number, data: Buffer, isNewCall: boolean): Promise<Buffer> {
+        if (isNewCall) {
+            this.signTx = {
+                stage: "INIT",
+                chainId: Buffer.alloc(0),
+                packedTx: Buffer.alloc(0),
+                rawBytesRemaining: 0,
+                witnessPath: null,
+            }
+        }
+        const ctx = this.signTx!
+
+        switch (p1) {
+        case 0x06: return this.signTxRawInit(ctx, p2, data)
+        case 0x07: return this.signTxRawChunk(ctx, p2, data)
+        case 0x10: return this.signTxWitness(ctx, p2, data)
+        case 0x30: return this.signTxTemplateInit(ctx, p2, data)
+        case 0x31: return this.signTxTemplateTx(ctx, p2, data)
+        default:
+            throw new SimulatedDeviceError(SW.ERR_INVALID_REQUEST_PARAMETERS)
+        }
+    }
+
+    private checkChain(chainId: Buffer) {
+        // policyForSignTxInit
+        VALIDATE(KNOWN_CHAIN_IDS.includes(chainId.toString("hex")), SW.ERR_REJECTED_BY_POLICY)
+    }
+
+    private startEarlyWitness(ctx: SignTxState, path: Array<number>) {
+        // no key is derived for a path which is going to be rejected anyway
+        VALIDATE(isAddressPath(path), SW.ERR_REJECTED_BY_POLICY)
+        ctx.witnessPath = path
+    }
+
+    // hashes and parses the chunk, the tx is parsed again as a whole
+    private addRawChunk(ctx: SignTxState, chunk: Buffer): Buffer {
+        VALIDATE(chunk.length <= ctx.rawBytesRemaining, SW.ERR_INVALID_DATA)
+        ctx.packedTx = Buffer.concat([ctx.packedTx, chunk])
+        ctx.rawBytesRemaining -= chunk.length
+
+        const parsed = parsePackedTx(ctx.packedTx)
+        if (ctx.rawBytesRemaining === 0) {
+            VALIDATE(parsed != null, SW.ERR_INVALID_DATA)
+            ctx.stage = "WITNESS"
+        }
+        return Buffer.alloc(0)
+    }
+
+    private signTxRawInit(ctx: SignTxState, p2: number, data: Buffer): Buffer {
+        VALIDATE(ctx.stage === "INIT", SW.ERR_INVALID_STATE)
+        // early witness, outside session (there are no signing sessions here)
+        VALIDATE((p2 & ~0x03) === 0, SW.ERR_INVALID_REQUEST_PARAMETERS)
+
+        VALIDATE(data.length >= CHAIN_ID_LENGTH, SW.ERR_INVALID_DATA)
+        ctx.chainId = data.slice(0, CHAIN_ID_LENGTH)
+        let parsedSize = CHAIN_ID_LENGTH
+        if (p2 & 0x01) {
+            const {path, size} = parsePath(data.slice(parsedSize))
+            parsedSize += size
+            this.startEarlyWitness(ctx, path)
+        }
+        VALIDATE(parsedSize + 2 <= data.length, SW.ERR_INVALID_DATA)
+        ctx.rawBytesRemaining = data.readUInt16BE(parsedSize)
+        parsedSize += 2
+        VALIDATE(ctx.rawBytesRemaining > 0, SW.ERR_INVALID_DATA)
+
+        this.checkChain(ctx.chainId)
+        ctx.stage = "RAW_TX"
+        this.addRawChunk(ctx, data.slice(parsedSize))
+        // the host needs it to recover the witness
+        return this.lastResponseStatus()
+    }
+
+    private signTxRawChunk(ctx: SignTxState, p2: number, data: Buffer): Buffer {
+        VALIDATE(ctx.stage === "RAW_TX", SW.ERR_INVALID_STATE)
+        VALIDATE(p2 === 0x00, SW.ERR_INVALID_REQUEST_PARAMETERS)
+        VALIDATE(data.length > 0, SW.ERR_INVALID_DATA)
+        return this.addRawChunk(ctx, data)
+    }
+
+    private signTxTemplateInit(ctx: SignTxState, p2: number, data: Buffer): Buffer {
+        VALIDATE(ctx.stage === "INIT", SW.ERR_INVALID_STATE)
+        VALIDATE(p2 === 0x00, SW.ERR_INVALID_REQUEST_PARAMETERS)
+
+        // the previous template is dropped even if the new one is invalid
+        this.template = null
+
+        const fixedLength = CHAIN_ID_LENGTH + 16 + 8 + 8
+        VALIDATE(data.length >= fixedLength, SW.ERR_INVALID_DATA)
+        const {path, size} = parsePath(data.slice(fixedLength))
+        VALIDATE(fixedLength + size === data.length, SW.ERR_INVALID_DATA)
+
+        const chainId = data.slice(0, CHAIN_ID_LENGTH)
+        this.checkChain(chainId)
+        // only the parser knows the action, an unknown one is rejected by it
+        const contractAccountName = data.slice(CHAIN_ID_LENGTH, CHAIN_ID_LENGTH + 16)
+        VALIDATE(contractAccountName.toString("hex") === "0000980ad20ca85be0e1d195ba85e7cd", SW.ERR_REJECTED_BY_POLICY)
+        VALIDATE(isAddressPath(path), SW.ERR_REJECTED_BY_POLICY)
+
+        this.template = {
+            chainId,
+            // max_net_usage_words, max_cpu_usage_ms, delay_sec, context_free_actions,
+            // one action with a single authorization
+            shared: Buffer.concat([
+                Buffer.from([0, 0, 0, 0, 1]),
+                contractAccountName,
+                Buffer.from([1]),
+                data.slice(CHAIN_ID_LENGTH + 16, fixedLength),
+            ]),
+            witnessPath: path,
+        }
+        ctx.stage = "NONE"
+        this.idle()
+        return Buffer.alloc(0)
+    }
+
+    private signTxTemplateTx(ctx: SignTxState, p2: number, data: Buffer): Buffer {
+        VALIDATE(ctx.stage === "INIT", SW.ERR_INVALID_STATE)
+        VALIDATE(p2 === 0x00 || p2 === 0x02, SW.ERR_INVALID_REQUEST_PARAMETERS)
+        VALIDATE(this.template != null, SW.ERR_INVALID_STATE)
+        const template = this.template
+
+        // the rest is action data and transaction extensions
+        VALIDATE(TEMPLATE_TX_HEADER_LENGTH < data.length, SW.ERR_INVALID_DATA)
+        const prefix = Buffer.concat([data.slice(0, TEMPLATE_TX_HEADER_LENGTH), template.shared])
+        const variable = data.slice(TEMPLATE_TX_HEADER_LENGTH)
+        VALIDATE(prefix.length + variable.length <= 0xffff, SW.ERR_INVALID_DATA)
+
+        ctx.chainId = template.chainId
+        ctx.rawBytesRemaining = prefix.length + variable.length
+        ctx.stage = "RAW_TX"
+        this.addRawChunk(ctx, prefix)
+        this.startEarlyWitness(ctx, template.witnessPath)
+        this.addRawChunk(ctx, variable)
+        return this.lastResponseStatus()
+    }
+
+    private async signTxWitness(ctx: SignTxState, p2: number, data: Buffer): Promise<Buffer> {
+        VALIDATE(ctx.stage === "WITNESS", SW.ERR_INVALID_STATE)
+        VALIDATE(p2 === 0x00, SW.ERR_INVALID_REQUEST_PARAMETERS)
+
+        let path = ctx.witnessPath
+        if (path != null) {
+            // the path was already sent in INIT
+            VALIDATE(data.length === 0, SW.ERR_INVALID_DATA)
+        } else {
+            const parsed = parsePath(data)
+            VALIDATE(parsed.size === data.length, SW.ERR_INVALID_DATA)
+            path = parsed.path
+        }
+        // policyForSignTxWitness
+        VALIDATE(isAddressPath(path), SW.ERR_REJECTED_BY_POLICY)
+
+        // chain id, packed_trx and 32 zero bytes of context free data
+        const hash = sha256(ctx.chainId, ctx.packedTx, Buffer.alloc(32))
+        const signature = signHash(hash, this.keys.derive(path).privateKey)
+
+        if (!await this.userConfirms("Sign transaction?")) {
+            throw new SimulatedDeviceError(SW.ERR_REJECTED_BY_USER)
+        }
+        const response = Buffer.concat([signature, hash])
+        this.saveLastResponse(response)
+        ctx.stage = "NONE"
+        this.idle()
+        return response
+    }
+}
+
+export default SimulatedFioDevice
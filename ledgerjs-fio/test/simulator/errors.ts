@@ -0,0 +1,25 @@
+// Status words of ledger-app-fio/src/errors.h
+export const SW = {
+    SUCCESS: 0x9000,
+    ERR_MALFORMED_REQUEST_HEADER: 0x6e01,
+    ERR_BAD_CLA: 0x6e02,
+    ERR_UNKNOWN_INS: 0x6e03,
+    ERR_STILL_IN_CALL: 0x6e04,
+    ERR_INVALID_REQUEST_PARAMETERS: 0x6e05,
+    ERR_INVALID_STATE: 0x6e06,
+    ERR_INVALID_DATA: 0x6e07,
+    ERR_REJECTED_BY_USER: 0x6e09,
+    ERR_REJECTED_BY_POLICY: 0x6e10,
+    ERR_DEVICE_LOCKED: 0x6e11,
+}
+
+// An error which the app responds with (and which resets the call in progress)
+export class SimulatedDeviceError extends Error {
+    constructor(public sw: number) {
+        super(`device error 0x${sw.toString(16)}`)
+    }
+}
+
+export function VALIDATE(cond: boolean, sw: number): asserts cond {
+    if (!cond) throw new SimulatedDeviceError(sw)
+}
@@ -0,0 +1,83 @@
+// @ts-ignore
+import BigInteger from "bigi"
+import {createHash, createHmac, pbkdf2Sync} from "crypto"
+// @ts-ignore
+import ecurve from "ecurve"
+
+import {HARDENED} from "../../src/types/public"
+import {compressed_public_key_to_wif} from "../../src/utils/keyDerivation"
+
+const PrivateKey = require("@fioprotocol/fiojs/dist/ecc/key_private")
+const Signature = require("@fioprotocol/fiojs/dist/ecc/signature")
+
+const secp256k1 = ecurve.getCurveByName("secp256k1")
+
+// the default seed of Speculos
+export const DEFAULT_MNEMONIC =
+    "glory promote mansion idle axis finger extra february uncover one trip resource " +
+    "lawn turtle enact monster seven myth punch hobby comfort wild raise skin"
+
+export type DerivedNode = {
+    privateKey: Buffer
+    // uncompressed
+    publicKey: Buffer
+    chainCode: Buffer
+}
+
+export function mnemonicToSeed(mnemonic: string, passphrase = ""): Buffer {
+    return pbkdf2Sync(Buffer.from(mnemonic.normalize("NFKD")), "mnemonic" + passphrase, 2048, 64, "sha512")
+}
+
+// BIP32 CKDpriv along the path, as os_perso_derive_node_bip32 does on the device
+export class KeyStore {
+    private cache: Map<string, DerivedNode> = new Map()
+
+    constructor(private seed: Buffer) {}
+
+    derive(path: Array<number>): DerivedNode {
+        const cacheKey = path.join("/")
+        const cached = this.cache.get(cacheKey)
+        if (cached) return cached
+
+        let I = createHmac("sha512", "Bitcoin seed").update(this.seed).digest()
+        let k = BigInteger.fromBuffer(I.slice(0, 32))
+        let chainCode = I.slice(32)
+        for (const index of path) {
+            const indexBuf = Buffer.alloc(4)
+            indexBuf.writeUInt32BE(index >>> 0)
+            const data = index >= HARDENED
+                ? Buffer.concat([Buffer.alloc(1), k.toBuffer(32), indexBuf])
+                : Buffer.concat([secp256k1.G.multiply(k).getEncoded(true), indexBuf])
+            I = createHmac("sha512", chainCode).update(data).digest()
+            k = BigInteger.fromBuffer(I.slice(0, 32)).add(k).mod(secp256k1.n)
+            chainCode = I.slice(32)
+        }
+
+        const node = {
+            privateKey: k.toBuffer(32),
+            publicKey: secp256k1.G.multiply(k).getEncoded(false),
+            chainCode,
+        }
+        this.cache.set(cacheKey, node)
+        return node
+    }
+}
+
+export function compressPublicKey(publicKey: Buffer): Buffer {
+    return ecurve.Point.decodeFrom(secp256k1, publicKey).getEncoded(true)
+}
+
+export function publicKeyToWif(publicKey: Buffer): string {
+    return compressed_public_key_to_wif(compressPublicKey(publicKey))
+}
+
+export function sha256(...data: Array<Buffer>): Buffer {
+    const hash = createHash("sha256")
+    data.forEach((d) => hash.update(d))
+    return hash.digest()
+}
+
+// canonical signature of the hash, i || r || s as sent by the device
+export function signHash(hash: Buffer, privateKey: Buffer): Buffer {
+    return Signature.signHash(hash, PrivateKey(privateKey)).toBuffer()
+}
@@ -0,0 +1,125 @@
+import {SW, VALIDATE} from "./errors"
+
+// Validates packed_trx the way ledger-app-fio/src/txParser.c does.
+// The device parses the stream as it comes, here the bytes received so far
+// are parsed again on each chunk, with the same errors.
+
+// fio.token trnsfiopubky
+const TRNSFIOPUBKY = Buffer.from("0000980ad20ca85be0e1d195ba85e7cd", "hex")
+
+const MAX_TX_ACTIONS = 50
+const MAX_PUBKEY_LENGTH = 55 - 1 // without the terminating zero
+const VARUINT32_MAX_SHIFT = 28
+
+export type ParsedAction = {
+    payee: string
+    amount: bigint
+    maxFee: bigint
+}
+
+export type ParsedTx = {
+    actions: Array<ParsedAction>
+}
+
+// thrown when the data ends in the middle of the transaction
+class Incomplete extends Error {}
+
+class Reader {
+    offset = 0
+    constructor(private data: Buffer) {}
+
+    bytes(length: number): Buffer {
+        if (this.offset + length > this.data.length) throw new Incomplete()
+        const result = this.data.slice(this.offset, this.offset + length)
+        this.offset += length
+        return result
+    }
+
+    varuint32(): number {
+        let value = 0
+        for (let shift = 0; ; shift += 7) {
+            VALIDATE(shift <= VARUINT32_MAX_SHIFT, SW.ERR_INVALID_DATA)
+            const byte = this.bytes(1)[0]
+            // the last byte may only carry the remaining 4 bits
+            VALIDATE(shift < VARUINT32_MAX_SHIFT || byte <= 0x0f, SW.ERR_INVALID_DATA)
+            value += (byte & 0x7f) * 2 ** shift
+            if ((byte & 0x80) === 0) return value
+        }
+    }
+
+    text(length: number): string {
+        const text = this.bytes(length)
+        for (const c of text) {
+            VALIDATE(c >= 32 && c <= 126, SW.ERR_INVALID_DATA)
+        }
+        return text.toString("ascii")
+    }
+
+    get remaining() {
+        return this.data.length - this.offset
+    }
+}
+
+function parseAction(r: Reader, actions: Array<ParsedAction>) {
+    const contractAccountName = r.bytes(16)
+    // action data of unknown actions cannot be parsed
+    VALIDATE(contractAccountName.equals(TRNSFIOPUBKY), SW.ERR_REJECTED_BY_POLICY)
+
+    VALIDATE(r.varuint32() === 1, SW.ERR_INVALID_DATA) // authorizations
+    const authorizationActor = r.bytes(8)
+    r.bytes(8) // permission
+
+    const dataLength = r.varuint32()
+    const dataStart = r.offset
+    const checkDataLength = () => VALIDATE(r.offset - dataStart <= dataLength, SW.ERR_INVALID_DATA)
+
+    const pubkeyLength = r.varuint32()
+    checkDataLength()
+    VALIDATE(pubkeyLength <= MAX_PUBKEY_LENGTH, SW.ERR_INVALID_DATA)
+    const payee = r.text(pubkeyLength)
+    checkDataLength()
+    const amount = r.bytes(8).readBigUInt64LE()
+    checkDataLength()
+    const maxFee = r.bytes(8).readBigUInt64LE()
+    checkDataLength()
+    const dataActor = r.bytes(8)
+    checkDataLength()
+    const tpidLength = r.varuint32()
+    checkDataLength()
+    r.text(tpidLength)
+    checkDataLength()
+    // declared action data length has to match its content
+    VALIDATE(r.offset - dataStart === dataLength, SW.ERR_INVALID_DATA)
+
+    // policyForSignTxActionData
+    VALIDATE(authorizationActor.equals(dataActor), SW.ERR_REJECTED_BY_POLICY)
+
+    actions.push({payee, amount, maxFee})
+}
+
+// Returns null if the transaction is not complete yet
+export function parsePackedTx(data: Buffer): ParsedTx | null {
+    const r = new Reader(data)
+    const actions: Array<ParsedAction> = []
+    try {
+        r.bytes(4 + 2 + 4) // expiration, ref_block_num, ref_block_prefix
+        VALIDATE(r.varuint32() === 0, SW.ERR_INVALID_DATA) // max_net_usage_words
+        VALIDATE(r.bytes(1)[0] === 0, SW.ERR_INVALID_DATA) // max_cpu_usage_ms
+        VALIDATE(r.varuint32() === 0, SW.ERR_INVALID_DATA) // delay_sec
+        VALIDATE(r.varuint32() === 0, SW.ERR_INVALID_DATA) // context_free_actions
+
+        const numActions = r.varuint32()
+        VALIDATE(numActions >= 1 && numActions <= MAX_TX_ACTIONS, SW.ERR_INVALID_DATA)
+        for (let i = 0; i < numActions; i++) {
+            parseAction(r, actions)
+        }
+
+        VALIDATE(r.varuint32() === 0, SW.ERR_INVALID_DATA) // transaction_extensions
+    } catch (e) {
+        if (e instanceof Incomplete) return null
+        throw e
+    }
+    // no trailing data allowed
+    VALIDATE(r.remaining === 0, SW.ERR_INVALID_DATA)
+    return {actions}
+}
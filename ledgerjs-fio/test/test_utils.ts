@@ -2,8 +2,31 @@
 import TransportNodeHid from "@ledgerhq/hw-transport-node-hid"
 
 import Fio from "../src/fio"
+import {SimulatedFioDevice} from "./simulator/SimulatedFioDevice"
+
+// LEDGER_TRANSPORT=speculos runs the tests against a local Speculos emulator
+// started with e.g. `speculos.py --apdu-port 9999 --button-port 42000 bin/app.elf`,
+// @ledgerhq/hw-transport-node-speculos is not a dependency and has to be installed for it
+const useSpeculos = process.env.LEDGER_TRANSPORT === "speculos"
+// LEDGER_TRANSPORT=simulator runs them against the in-process SimulatedFioDevice,
+// SIMULATOR_LATENCY_MS emulates the round trip of an APDU
+export const useSimulator = process.env.LEDGER_TRANSPORT === "simulator"
 
 export async function getTransport() {
+    if (useSimulator) {
+        return new SimulatedFioDevice({
+            mnemonic: process.env.SIMULATOR_MNEMONIC,
+            apduLatencyMs: parseInt(process.env.SIMULATOR_LATENCY_MS || "0"),
+        })
+    }
+    if (useSpeculos) {
+        const SpeculosTransport = require("@ledgerhq/hw-transport-node-speculos").default
+        return await SpeculosTransport.open({
+            host: process.env.SPECULOS_HOST || "127.0.0.1",
+            apduPort: parseInt(process.env.SPECULOS_APDU_PORT || "9999"),
+            buttonPort: parseInt(process.env.SPECULOS_BUTTON_PORT || "42000"),
+        })
+    }
     return await TransportNodeHid.create(1000)
 }
 
@@ -14,3 +37,12 @@ export async function getFio() {
     (fio as any).t = transport
     return fio
 }
+
+/**
+ * Presses the buttons of the emulator, e.g. "Rr" (press and release right) or "LRlr" (both).
+ * Does nothing on a physical device, the human has to do it.
+ */
+export async function pressButtons(fio: Fio, script: string) {
+    if (!useSpeculos) return
+    await (fio as any).t.button(script)
+}
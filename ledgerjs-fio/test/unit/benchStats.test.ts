@@ -0,0 +1,21 @@
+import {expect} from "chai"
+
+import {latencyStats, percentile} from "../bench/stats"
+
+describe("benchStats", () => {
+    it("takes nearest-rank percentiles", () => {
+        const sorted = [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]
+        expect(percentile(sorted, 50)).to.equal(5)
+        expect(percentile(sorted, 99)).to.equal(10)
+        expect(percentile(sorted, 0)).to.equal(1)
+        expect(percentile([], 50)).to.be.NaN
+    })
+
+    it("computes the sustained rate over the whole run", () => {
+        const stats = latencyStats([30, 10, 20], 60000)
+        expect(stats.p50Ms).to.equal(20)
+        expect(stats.p99Ms).to.equal(30)
+        expect(stats.meanMs).to.equal(20)
+        expect(stats.perMinute).to.equal(3)
+    })
+})
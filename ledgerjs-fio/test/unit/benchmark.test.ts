@@ -0,0 +1,65 @@
+import chai, {expect} from "chai"
+import chaiAsPromised from "chai-as-promised"
+
+import {BenchmarkKernel, Fio, InvalidData} from "../../src/fio"
+import {SimulatedFioDevice} from "../simulator/SimulatedFioDevice"
+
+chai.use(chaiAsPromised)
+
+const INS_BENCHMARK = 0xf3
+const OVERHEAD_MS = 20
+const MS_PER_ITERATION = 2
+
+// answers the benchmark INS of the DEVEL build, each iteration takes MS_PER_ITERATION
+class BenchmarkDevice extends SimulatedFioDevice {
+    requests: Array<{kernel: number, iterations: number}> = []
+
+    async exchange(apdu: Buffer): Promise<Buffer> {
+        if (apdu[1] !== INS_BENCHMARK) {
+            return super.exchange(apdu)
+        }
+        const kernel = apdu[2]
+        const iterations = apdu.readUInt32BE(5)
+        this.requests.push({kernel, iterations})
+        await new Promise((resolve) => setTimeout(resolve, OVERHEAD_MS + iterations * MS_PER_ITERATION))
+
+        const response = Buffer.alloc(7)
+        response.writeUInt8(kernel, 0)
+        response.writeUInt32BE(iterations, 1)
+        response.writeUInt16BE(0x9000, 5)
+        return response
+    }
+}
+
+describe("benchmark", () => {
+    it("subtracts the transport overhead", async () => {
+        const device = new BenchmarkDevice()
+        const fio = new Fio(device)
+
+        const result = await fio.benchmark({kernel: BenchmarkKernel.SHA_256_64_BYTES, iterations: 50})
+        expect(device.requests).to.deep.equal([
+            {kernel: BenchmarkKernel.SHA_256_64_BYTES, iterations: 0},
+            {kernel: BenchmarkKernel.SHA_256_64_BYTES, iterations: 50},
+        ])
+        expect(result.kernel).to.equal(BenchmarkKernel.SHA_256_64_BYTES)
+        expect(result.iterations).to.equal(50)
+        // timers are not exact, but the overhead must not be counted
+        expect(result.msPerOp).to.be.within(MS_PER_ITERATION * 0.75, MS_PER_ITERATION * 1.5)
+    })
+
+    it("validates the request", async () => {
+        const device = new BenchmarkDevice()
+        const fio = new Fio(device)
+
+        await expect(fio.benchmark({kernel: 0x42 as BenchmarkKernel, iterations: 10}))
+            .to.be.rejectedWith(InvalidData)
+        // the reverse mapping of the enum holds the names too
+        await expect(fio.benchmark({kernel: "BASE58" as unknown as BenchmarkKernel, iterations: 10}))
+            .to.be.rejectedWith(InvalidData)
+        await expect(fio.benchmark({kernel: BenchmarkKernel.BASE58, iterations: 0}))
+            .to.be.rejectedWith(InvalidData)
+        await expect(fio.benchmark({kernel: BenchmarkKernel.BASE58, iterations: 10001}))
+            .to.be.rejectedWith(InvalidData)
+        expect(device.requests).to.be.empty
+    })
+})
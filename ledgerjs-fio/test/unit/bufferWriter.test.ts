@@ -0,0 +1,44 @@
+import {expect} from "chai"
+
+import type {Uint32_t, Uint64_str} from "../../src/types/internal"
+import {BufferWriter, string_length, varuint32_length} from "../../src/utils/bufferWriter"
+
+const hex = (writer: BufferWriter) => writer.toBuffer().toString("hex")
+
+describe("BufferWriter", () => {
+    it("writes uint64 strings exactly", () => {
+        const cases: Array<[string, string]> = [
+            ["0", "0000000000000000"],
+            ["20", "0000000000000014"],
+            ["4294967295", "00000000ffffffff"],
+            ["4294967296", "0000000100000000"],
+            ["9007199254740993", "0020000000000001"],
+            ["1234567890123456789", "112210f47de98115"],
+            ["18446744073709551615", "ffffffffffffffff"],
+        ]
+        for (const [value, expected] of cases) {
+            expect(hex(new BufferWriter(8).uint64(value as Uint64_str))).to.equal(expected)
+            expect(hex(new BufferWriter(8).uint64le(value as Uint64_str)))
+                .to.equal(Buffer.from(expected, "hex").reverse().toString("hex"))
+        }
+    })
+
+    it("rejects values out of the uint64 range", () => {
+        expect(() => new BufferWriter(8).uint64("18446744073709551616" as Uint64_str)).to.throw()
+    })
+
+    it("writes varuint32 in as many bytes as it announces", () => {
+        for (const value of [0, 0x7f, 0x80, 0x3fff, 0x4000, 0xffffffff]) {
+            const writer = new BufferWriter(5).varuint32(value as Uint32_t)
+            expect(writer.length).to.equal(varuint32_length(value))
+        }
+        expect(hex(new BufferWriter(5).varuint32(300 as Uint32_t))).to.equal("ac02")
+        expect(hex(new BufferWriter(string_length("tpid")).string("tpid"))).to.equal("0474706964")
+    })
+
+    it("refuses to write past its capacity", () => {
+        const writer = new BufferWriter(5).uint32(1 as Uint32_t)
+        expect(() => writer.uint16(1)).to.throw()
+        expect(hex(writer)).to.equal("00000001")
+    })
+})
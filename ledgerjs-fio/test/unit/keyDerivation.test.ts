@@ -0,0 +1,49 @@
+import {expect} from "chai"
+
+import {InvalidData} from "../../src/errors"
+import {PublicKeyDeriver} from "../../src/utils/keyDerivation"
+
+// account node 44'/235'/0' of "abandon abandon ... about"
+const accountPublicKey = {
+    publicKeyHex: "0474d88195367ea0c4415faf0988dfdce8250abe4ce29368dc378ddfd6f116544c1b5e08cce8edba905eb6809810b7bcef80075103fc2fba447fa01f5da6d90869",
+    chainCodeHex: "73938768a3f36543ad7657e4ddc66377d5d5de797241651a33d346325e200573",
+}
+
+describe("keyDerivation", () => {
+    it("derives address keys from the account key", () => {
+        const deriver = new PublicKeyDeriver(accountPublicKey)
+
+        const testCases = [
+            {
+                address: 0,
+                publicKeyHex: "04a9a222bc3b1a5a58ada17d10069b3961ebd0f917d4b2106031a061915ca9cc24a06941e0a4c0d5e266850ff980ad349ab8b027c93bf4aead1984168ad43e30ab",
+                publicKeyWIF: "FIO87wawwaniQzqWPmNaCqGkiUNmCAhq9PiGUVNKKjRMTYgoBfKYa",
+            },
+            {
+                address: 1,
+                publicKeyWIF: "FIO59AorMxC915xCELuAxpzKxWhE7UMdUcMapMsvBfFHcx3XufhKJ",
+            },
+            {
+                address: 2000,
+                publicKeyHex: "0484e52dfea57b8f1787488a356374cd8e8515b8ad8db3dd4f9088d8e42ed2fb6d571e8894cccbdbf15e1bd84f8b4362f52d1b5b712b9775c0a51cdd5ee9a9e8ca",
+                publicKeyWIF: "FIO5u1z2SmACBSiskJveWrDtSyfGoVDNYqUbSAVm5sDSLGBSkLx4Z",
+            },
+        ]
+
+        for (const {address, publicKeyHex, publicKeyWIF} of testCases) {
+            const key = deriver.deriveAddressKey(0, address)
+            if (publicKeyHex) expect(key.publicKeyHex).to.equal(publicKeyHex)
+            expect(key.publicKeyWIF).to.equal(publicKeyWIF)
+        }
+    })
+
+    it("rejects invalid account keys", () => {
+        expect(() => new PublicKeyDeriver({...accountPublicKey, chainCodeHex: "00"})).to.throw(InvalidData)
+        expect(() => new PublicKeyDeriver({...accountPublicKey, publicKeyHex: "04" + "00".repeat(64)})).to.throw()
+    })
+
+    it("rejects hardened addresses", () => {
+        const deriver = new PublicKeyDeriver(accountPublicKey)
+        expect(() => deriver.deriveAddressKey(0, 0x80000000)).to.throw()
+    })
+})
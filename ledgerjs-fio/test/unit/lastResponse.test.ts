@@ -0,0 +1,63 @@
+import chai, {expect} from "chai"
+import chaiAsPromised from "chai-as-promised"
+
+import {DeviceStatusCodes, DeviceStatusError, InvalidDataReason} from "../../src/errors"
+import {interact} from "../../src/fio"
+import type {SendParams} from "../../src/interactions/common/types"
+import {getPublicKey} from "../../src/interactions/getPublicKey"
+import {HARDENED} from "../../src/types/public"
+import {parseBIP32Path} from "../../src/utils/parse"
+
+chai.use(chaiAsPromised)
+
+const version = {major: 0, minor: 1, patch: 0, flags: {isDebug: false}}
+const path = parseBIP32Path([44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0], InvalidDataReason.INVALID_PATH)
+
+const publicKey = Buffer.alloc(65, 0x04)
+const publicKeyWIF = "FIO8PRe4WRZJj5mkem6qVGKyvNFgPsNnjNN6kPhh6EaCpzCVin5Jj"
+const keyResponse = Buffer.concat([publicKey, Buffer.from(publicKeyWIF)])
+
+// nonce 7, sequence 3, INS of get public key
+const statusHeader = Buffer.from("00000007" + "00000003" + "10", "hex")
+const fetchedHeader = Buffer.from("00000007" + "00000004" + "10", "hex")
+
+// a device whose response to the export gets lost on the way to the host
+function lossyDevice(fetch: (data: Buffer) => Buffer) {
+    const sent: Array<SendParams> = []
+    const send = async (params: SendParams): Promise<Buffer> => {
+        sent.push(params)
+        if (params.ins === 0x02 && params.p1 === 0x01) return statusHeader
+        if (params.ins === 0x02 && params.p1 === 0x02) return fetch(params.data)
+        throw new Error("disconnected")
+    }
+    return {send, sent}
+}
+
+describe("lastResponse", () => {
+    it("recovers a lost public key without asking the user again", async () => {
+        const {send, sent} = lossyDevice(() => Buffer.concat([fetchedHeader, keyResponse]))
+
+        const response = await interact(getPublicKey(version, path, true), send)
+
+        expect(response.publicKeyWIF).to.equal(publicKeyWIF)
+        expect(sent.map(({ins, p1}) => [ins, p1])).to.deep.equal([[0x02, 0x01], [0x10, 0x01], [0x02, 0x02]])
+        expect(sent[2].data.toString("hex")).to.equal("00000007" + "00000004")
+    })
+
+    it("throws the original error if the device kept another response", async () => {
+        const {send} = lossyDevice(() => {
+            throw new DeviceStatusError(DeviceStatusCodes.ERR_INVALID_STATE)
+        })
+
+        await expect(interact(getPublicKey(version, path, true), send))
+            .to.be.rejectedWith("disconnected")
+    })
+
+    it("does not recover exports which were not shown", async () => {
+        const {send, sent} = lossyDevice(() => Buffer.concat([fetchedHeader, keyResponse]))
+
+        await expect(interact(getPublicKey(version, path, false), send))
+            .to.be.rejectedWith("disconnected")
+        expect(sent).to.have.length(1)
+    })
+})
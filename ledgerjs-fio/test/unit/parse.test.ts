@@ -1,8 +1,11 @@
 import {expect} from "chai"
 
 import {InvalidDataReason} from "../../src/errors"
+import {MAX_ACTIONS, MAX_SESSION_LIFETIME_SECONDS, MAX_SESSION_PAYEES} from "../../src/types/internal"
 import type {Transaction} from "../../src/types/public"
-import {parseTransaction} from "../../src/utils/parse"
+import {HARDENED} from "../../src/types/public"
+import {parseSigningSession, parseTransaction} from "../../src/utils/parse"
+import {buf_to_uint64} from "../../src/utils/serialize"
 
 const chainId = "" //XXX
 
@@ -67,14 +70,27 @@ describe("parse", () => {
             const noActions = JSON.parse(JSON.stringify(validTx))
             noActions.actions = []
             expect(() => parseTransaction(chainId, noActions))
-                .to.throw(InvalidDataReason.MULTIPLE_ACTIONS_NOT_SUPPORTED)
+                .to.throw(InvalidDataReason.INVALID_NUMBER_OF_ACTIONS)
         })
 
-        it("fail to parse when there is more than one action", () => {
+        it("successfully parse more than one action", () => {
             const moreThanOneAction = JSON.parse(JSON.stringify(validTx))
             moreThanOneAction.actions.push(moreThanOneAction.actions[0])
-            expect(() => parseTransaction(chainId, moreThanOneAction))
-                .to.throw(InvalidDataReason.MULTIPLE_ACTIONS_NOT_SUPPORTED)
+            expect(parseTransaction(chainId, moreThanOneAction).actions).to.have.length(2)
+        })
+
+        it("fail to parse too many actions", () => {
+            const tooManyActions = JSON.parse(JSON.stringify(validTx))
+            tooManyActions.actions = Array(MAX_ACTIONS + 1).fill(validTx.actions[0])
+            expect(() => parseTransaction(chainId, tooManyActions))
+                .to.throw(InvalidDataReason.INVALID_NUMBER_OF_ACTIONS)
+        })
+
+        it("fail to parse invalid action in a later position", () => {
+            const invalidSecondAction = JSON.parse(JSON.stringify(validTx))
+            invalidSecondAction.actions.push({...validTx.actions[0], name: "name.error"})
+            expect(() => parseTransaction(chainId, invalidSecondAction))
+                .to.throw(InvalidDataReason.ACTION_NOT_SUPPORTED)
         })
 
         it("fail to parse invalid account", () => {
@@ -148,6 +164,13 @@ describe("parse", () => {
                 .to.throw(InvalidDataReason.INVALID_TPID)
         })
 
+        it("successfully parse a long tpid", () => {
+            // the tpid is not displayed, so its length is not limited
+            const longTpid = JSON.parse(JSON.stringify(validTx))
+            longTpid.actions[0].data.tpid = "a".repeat(200)
+            expect(() => parseTransaction(chainId, longTpid)).to.not.throw()
+        })
+
         it("fail to parse invalid actor in action data", () => {
             const invalidActionDataActor = JSON.parse(JSON.stringify(validTx))
             invalidActionDataActor.actions[0].data.actor = null
@@ -155,4 +178,40 @@ describe("parse", () => {
                 .to.throw(InvalidDataReason.INVALID_ACTOR)
         })
     })
+
+    describe("parseSigningSession", () => {
+        const path = [44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0]
+        const payee = validTx.actions[0].data.payee_public_key
+        const parse = (spendingCap: unknown, lifetimeSeconds: unknown, payees: unknown) =>
+            parseSigningSession("00".repeat(32), path, spendingCap, 1000, lifetimeSeconds, payees)
+
+        it("successfully parse valid session", () => {
+            const session = parse("5000000000", 3600, [payee])
+            expect(session.spendingCap).to.equal("5000000000")
+            expect(session.payees).to.deep.equal([payee])
+        })
+
+        it("fail to parse zero spending cap", () => {
+            expect(() => parse(0, 3600, [])).to.throw(InvalidDataReason.INVALID_SPENDING_CAP)
+        })
+
+        it("fail to parse invalid lifetime", () => {
+            expect(() => parse(1, 0, [])).to.throw(InvalidDataReason.INVALID_SESSION_LIFETIME)
+            expect(() => parse(1, MAX_SESSION_LIFETIME_SECONDS + 1, []))
+                .to.throw(InvalidDataReason.INVALID_SESSION_LIFETIME)
+        })
+
+        it("fail to parse too many payees", () => {
+            expect(() => parse(1, 3600, Array(MAX_SESSION_PAYEES + 1).fill(payee)))
+                .to.throw(InvalidDataReason.INVALID_NUMBER_OF_PAYEES)
+        })
+    })
+
+    describe("buf_to_uint64", () => {
+        it("reads big endian values", () => {
+            expect(buf_to_uint64(Buffer.from("0000000000000000", "hex"))).to.equal("0")
+            expect(buf_to_uint64(Buffer.from("0000000000000100", "hex"))).to.equal("256")
+            expect(buf_to_uint64(Buffer.from("ffffffffffffffff", "hex"))).to.equal("18446744073709551615")
+        })
+    })
 })
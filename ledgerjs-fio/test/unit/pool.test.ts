@@ -0,0 +1,127 @@
+import chai, {expect} from "chai"
+import chaiAsPromised from "chai-as-promised"
+
+import {FioPool, HARDENED, NoDeviceAvailable} from "../../src/fio"
+import {SimulatedFioDevice} from "../simulator/SimulatedFioDevice"
+
+chai.use(chaiAsPromised)
+
+const path = [44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0]
+const OTHER_MNEMONIC =
+    "abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon abandon about"
+
+// the transport stops working after `unplug`
+class UnpluggableDevice extends SimulatedFioDevice {
+    unplugged = false
+
+    async exchange(apdu: Buffer): Promise<Buffer> {
+        if (this.unplugged) throw new Error("cannot write to HID device")
+        return super.exchange(apdu)
+    }
+}
+
+function createPool(mnemonics: {[descriptor: string]: string | undefined}) {
+    const connected = Object.keys(mnemonics)
+    const devices: {[descriptor: string]: UnpluggableDevice} = {}
+    const pool = new FioPool({
+        list: async () => connected,
+        open: async (descriptor) => {
+            devices[descriptor] = new UnpluggableDevice({
+                mnemonic: mnemonics[descriptor],
+                serial: Buffer.alloc(7, descriptor).toString("hex"),
+                apduLatencyMs: 5,
+            })
+            return devices[descriptor]
+        },
+        healthCheckIntervalMs: 0,
+    })
+    return {pool, connected, devices}
+}
+
+// devices get connected in parallel, in no particular order
+function sortedStats(pool: FioPool) {
+    return pool.stats().sort((x, y) => x.descriptor.localeCompare(y.descriptor))
+}
+
+describe("FioPool", () => {
+    it("spreads requests over idle devices", async () => {
+        const {pool} = createPool({a: undefined, b: undefined})
+        await pool.start()
+
+        await Promise.all(Array.from({length: 6}, () => pool.getPublicKey({path, show_or_not: false})))
+
+        const stats = sortedStats(pool)
+        expect(stats.map((s) => s.completed)).to.deep.equal([3, 3])
+        expect(stats.map((s) => s.queueDepth)).to.deep.equal([0, 0])
+        expect(stats[0].seed).to.equal(stats[1].seed)
+        await pool.close()
+    })
+
+    it("routes requests to the devices holding the seed", async () => {
+        const {pool} = createPool({a: undefined, b: OTHER_MNEMONIC})
+        await pool.start()
+        const [a, b] = sortedStats(pool)
+        expect(a.seed).not.to.equal(b.seed)
+
+        const responses = await Promise.all(Array.from({length: 4}, () => pool.getPublicKey(
+            {path, show_or_not: false},
+            {seed: b.seed},
+        )))
+
+        expect(responses.map((r) => r.publicKeyHex)).to.deep.equal(Array(4).fill(b.seed))
+        expect(sortedStats(pool).map((s) => s.completed)).to.deep.equal([0, 4])
+        await expect(pool.getPublicKey({path, show_or_not: false}, {seed: "00"}))
+            .to.be.rejectedWith(NoDeviceAvailable)
+        await pool.close()
+    })
+
+    it("drops unplugged devices and picks up new ones", async () => {
+        const {pool, connected, devices} = createPool({a: undefined})
+        await pool.start()
+
+        devices.a.unplugged = true
+        await expect(pool.getPublicKey({path, show_or_not: false})).to.be.rejectedWith("cannot write")
+        expect(pool.stats()).to.have.length(0)
+        await expect(pool.getPublicKey({path, show_or_not: false})).to.be.rejectedWith(NoDeviceAvailable)
+
+        connected.splice(0, 1, "b")
+        await pool.refresh()
+        expect(pool.stats().map((s) => s.descriptor)).to.deep.equal(["b"])
+        await pool.getPublicKey({path, show_or_not: false})
+        await pool.close()
+    })
+
+    it("does not hold up the refresh behind busy devices", async () => {
+        const {pool, connected} = createPool({a: undefined})
+        await pool.start()
+        await pool.getPublicKey({path, show_or_not: false})
+
+        const requests = Promise.all(Array.from({length: 10}, () => pool.getPublicKey({path, show_or_not: false})))
+        connected.push("b")
+        await pool.refresh()
+
+        // a completed a request since the last check, so it is not checked while busy
+        const [a, b] = sortedStats(pool)
+        expect(a.queueDepth).to.be.above(0)
+        expect(b.descriptor).to.equal("b")
+        await requests
+        await pool.close()
+    })
+
+    it("reconnects devices failing the health check", async () => {
+        const {pool, devices} = createPool({a: undefined, b: undefined})
+        await pool.start()
+        await Promise.all([
+            pool.getPublicKey({path, show_or_not: false}),
+            pool.getPublicKey({path, show_or_not: false}),
+        ])
+
+        const broken = devices.b
+        broken.unplugged = true
+        await pool.refresh()
+
+        expect(devices.b).not.to.equal(broken)
+        expect(sortedStats(pool).map((s) => s.completed)).to.deep.equal([1, 0])
+        await pool.close()
+    })
+})
@@ -0,0 +1,45 @@
+import chai, {expect} from "chai"
+import chaiAsPromised from "chai-as-promised"
+
+import {interact} from "../../src/fio"
+import type {SendParams} from "../../src/interactions/common/types"
+import {getProfile} from "../../src/interactions/getProfile"
+import {ProfilePhase} from "../../src/types/public"
+
+chai.use(chaiAsPromised)
+
+const version = {major: 0, minor: 1, patch: 0, flags: {isDebug: true}}
+
+// 9 records so far, the last two are kept: a signature which needed two attempts
+const response = Buffer.from(
+    "00000009" + "02" +
+    "20" + "05" + "00" + "00000012" +
+    "20" + "85" + "02" + "00000012",
+    "hex",
+)
+
+describe("getProfile", () => {
+    it("parses the records", async () => {
+        const sent: Array<SendParams> = []
+        const send = async (params: SendParams) => {
+            sent.push(params)
+            return response
+        }
+
+        const profile = await interact(getProfile(version, true), send)
+        expect(sent).to.have.length(1)
+        expect(sent[0]).to.include({ins: 0xf4, p1: 0x01, p2: 0x00})
+        expect(profile).to.deep.equal({
+            totalRecorded: 9,
+            records: [
+                {ins: 0x20, phase: ProfilePhase.SIGN, isEnd: false, value: 0, ticker: 0x12},
+                {ins: 0x20, phase: ProfilePhase.SIGN, isEnd: true, value: 2, ticker: 0x12},
+            ],
+        })
+    })
+
+    it("rejects a truncated response", async () => {
+        const send = async () => response.slice(0, response.length - 1)
+        await expect(interact(getProfile(version, false), send)).to.be.rejected
+    })
+})
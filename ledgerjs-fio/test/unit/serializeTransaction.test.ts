@@ -0,0 +1,96 @@
+import {expect} from "chai"
+
+import {InvalidDataReason} from "../../src/errors"
+import {getSignTransactionTemplate, serializeTransaction} from "../../src/interactions/signTransaction"
+import type {Transaction} from "../../src/types/public"
+import {HARDENED} from "../../src/types/public"
+import {parseBIP32Path, parseTransaction} from "../../src/utils/parse"
+
+const chainId = ""
+
+const tx: Transaction = {
+    expiration: "2021-08-28T12:50:36.686",
+    ref_block_num: 0x1122,
+    ref_block_prefix: 0x33445566,
+    context_free_actions: [],
+    actions: [{
+        account: "fio.token",
+        name: "trnsfiopubky",
+        authorization: [{
+            actor: "aftyershcu22",
+            permission: "active",
+        }],
+        data: {
+            payee_public_key: "FIO8PRe4WRZJj5mkem6qVGKyvNFgPsNnjNN6kPhh6EaCpzCVin5Jj",
+            amount: "20",
+            max_fee: 0x11223344,
+            tpid: "rewards@wallet",
+            actor: "aftyershcu22",
+        },
+    }],
+    transaction_extensions: null,
+}
+
+// canonical EOSIO serialization of the transaction above
+const headerHex =
+    "1c312a61221166554433" +
+    "00000000"
+const actionHex =
+    "0000980ad20ca85be0e1d195ba85e7cd" +
+    "01" + "2084460d5fe5f332" + "00000000a8ed3232" +
+    "5d" +
+    "35" + "46494f385052653457525a4a6a356d6b656d367156474b79764e466750734e6e6a4e4e366b50686836456143707a4356696e354a6a" +
+    "1400000000000000" + "4433221100000000" +
+    "2084460d5fe5f332" +
+    "0e" + "726577617264734077616c6c6574"
+const secondActionHex =
+    "0000980ad20ca85be0e1d195ba85e7cd" +
+    "01" + "2084460d5fe5f332" + "00000000a8ed3232" +
+    "4f" +
+    "35" + "46494f385052653457525a4a6a356d6b656d367156474b79764e466750734e6e6a4e4e366b50686836456143707a4356696e354a6a" +
+    "1e00000000000000" + "0500000000000000" +
+    "2084460d5fe5f332" +
+    "00"
+
+describe("serializeTransaction", () => {
+    it("produces canonical packed_trx", () => {
+        const packedTx = serializeTransaction(parseTransaction(chainId, tx))
+        expect(packedTx.toString("hex")).to.equal(headerHex + "01" + actionHex + "00")
+    })
+
+    it("serializes all actions", () => {
+        const secondAction = {
+            ...tx.actions[0],
+            data: {...tx.actions[0].data, amount: "30", max_fee: 5, tpid: ""},
+        }
+        const packedTx = serializeTransaction(parseTransaction(chainId, {...tx, actions: [tx.actions[0], secondAction]}))
+        expect(packedTx.toString("hex")).to.equal(headerHex + "02" + actionHex + secondActionHex + "00")
+    })
+})
+
+describe("getSignTransactionTemplate", () => {
+    const path = parseBIP32Path([44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0], InvalidDataReason.INVALID_PATH)
+    const template = (t: Transaction) => getSignTransactionTemplate(path, chainId, parseTransaction(chainId, t))
+
+    it("is shared by transfers differing in header and action data", () => {
+        const otherTx = {
+            ...tx,
+            ref_block_num: 0x3344,
+            actions: [{...tx.actions[0], data: {...tx.actions[0].data, amount: "30", tpid: ""}}],
+        }
+        expect(template(tx)).to.not.equal(null)
+        expect(template(otherTx)).to.equal(template(tx))
+    })
+
+    it("depends on authorization", () => {
+        const otherTx = {
+            ...tx,
+            actions: [{...tx.actions[0], authorization: [{actor: "aftyershcu22", permission: "owner"}]}],
+        }
+        expect(template(otherTx)).to.not.equal(template(tx))
+    })
+
+    it("is not used for multiple actions", () => {
+        expect(template({...tx, actions: [tx.actions[0], tx.actions[0]]})).to.equal(null)
+    })
+})
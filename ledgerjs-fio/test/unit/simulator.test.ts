@@ -0,0 +1,201 @@
+import chai, {expect} from "chai"
+import chaiAsPromised from "chai-as-promised"
+
+import {DeviceStatusCodes, DeviceStatusError, DeviceVersionUnsupported, Fio, HARDENED, InvalidData} from "../../src/fio"
+import {serializeTransaction} from "../../src/interactions/signTransaction"
+import type {Transaction} from "../../src/types/public"
+import {parseTransaction} from "../../src/utils/parse"
+import {KeyStore, mnemonicToSeed, publicKeyToWif, sha256} from "../simulator/keys"
+import {DEFAULT_MNEMONIC} from "../simulator/keys"
+import {SimulatedFioDevice} from "../simulator/SimulatedFioDevice"
+
+chai.use(chaiAsPromised)
+
+const PrivateKey = require("@fioprotocol/fiojs/dist/ecc/key_private")
+const Signature = require("@fioprotocol/fiojs/dist/ecc/signature")
+
+const path = [44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0]
+const chainId = "b20901380af44ef59c5918439a1f9a41d83669020319a80574b804a5f95cbd7e"
+const keys = new KeyStore(mnemonicToSeed(DEFAULT_MNEMONIC))
+
+const action = {
+    account: "fio.token",
+    name: "trnsfiopubky",
+    authorization: [{
+        actor: "aftyershcu22",
+        permission: "active",
+    }],
+    data: {
+        payee_public_key: "FIO8PRe4WRZJj5mkem6qVGKyvNFgPsNnjNN6kPhh6EaCpzCVin5Jj",
+        amount: "20",
+        max_fee: 0x11223344,
+        tpid: "rewards@wallet",
+        actor: "aftyershcu22",
+    },
+}
+
+const tx: Transaction = {
+    expiration: "2021-08-28T12:50:36.686",
+    ref_block_num: 0x1122,
+    ref_block_prefix: 0x33445566,
+    context_free_actions: [],
+    actions: [action],
+    transaction_extensions: [],
+}
+
+function expectValidSignature(tx: Transaction, response: {txHashHex: string, witness: {witnessSignatureHex: string}}) {
+    const hash = sha256(Buffer.from(chainId, "hex"), serializeTransaction(parseTransaction(chainId, tx)), Buffer.alloc(32))
+    expect(response.txHashHex).to.equal(hash.toString("hex"))
+
+    const publicKey = PrivateKey(keys.derive(path).privateKey).toPublic()
+    const signature = Signature.fromHex(response.witness.witnessSignatureHex)
+    expect(signature.verifyHash(hash, publicKey)).to.be.true
+}
+
+// the response of the witness gets lost once on the way to the host
+class LossySimulatedFioDevice extends SimulatedFioDevice {
+    lost = false
+
+    async exchange(apdu: Buffer): Promise<Buffer> {
+        const response = await super.exchange(apdu)
+        if (!this.lost && apdu[1] === 0x20 && apdu[2] === 0x10) {
+            this.lost = true
+            throw new Error("disconnected")
+        }
+        return response
+    }
+}
+
+// a signing session which covers no transaction, the simulator has no sessions otherwise
+class SessionSimulatedFioDevice extends SimulatedFioDevice {
+    sessionActive = true
+    // P2 of the calls starting a raw or a template transaction
+    signTxStarts: Array<number> = []
+
+    async exchange(apdu: Buffer): Promise<Buffer> {
+        const [, ins, p1, p2] = apdu
+        if (ins === 0x21 && p1 === 0x10) {
+            return Buffer.concat([Buffer.from([this.sessionActive ? 1 : 0]), Buffer.alloc(8 + 4), Buffer.from([0x90, 0x00])])
+        }
+        if (ins === 0x20 && (p1 === 0x06 || p1 === 0x31)) {
+            this.signTxStarts.push(p2)
+            if (this.sessionActive && !(p2 & 0x02)) return Buffer.from([0x6e, 0x10])
+        }
+        return super.exchange(apdu)
+    }
+}
+
+describe("SimulatedFioDevice", () => {
+    it("exports public keys", async () => {
+        const fio = new Fio(new SimulatedFioDevice())
+
+        const response = await fio.getPublicKey({path, show_or_not: true})
+
+        const {publicKey} = keys.derive(path)
+        expect(response.publicKeyHex).to.equal(publicKey.toString("hex"))
+        expect(response.publicKeyWIF).to.equal(publicKeyToWif(publicKey))
+    })
+
+    it("exports a batch of public keys while keeping the other calls out", async () => {
+        const fio = new Fio(new SimulatedFioDevice())
+
+        const exported = []
+        for await (const item of fio.getPublicKeys({path, count: 10})) {
+            if (exported.length === 0) {
+                await expect(fio.getPublicKey({path, show_or_not: false}))
+                    .to.be.rejectedWith("Ledger Device is busy (lock getPublicKeys)")
+            }
+            exported.push(item)
+        }
+        expect(exported).to.have.length(10)
+        expect(exported[9].path).to.deep.equal([...path.slice(0, -1), 9])
+        expect(exported[9].publicKeyHex).to.equal(keys.derive(exported[9].path).publicKey.toString("hex"))
+
+        // the lock is released with the last key
+        await fio.getPublicKey({path, show_or_not: false})
+    })
+
+    it("rejects batches reaching hardened addresses", async () => {
+        const fio = new Fio(new SimulatedFioDevice())
+
+        const lastPath = [...path.slice(0, -1), HARDENED - 1]
+        await expect(fio.getPublicKeys({path: lastPath, count: 2}).next()).to.be.rejectedWith(InvalidData)
+        const exported = []
+        for await (const item of fio.getPublicKeys({path: lastPath, count: 1})) {
+            exported.push(item)
+        }
+        expect(exported).to.have.length(1)
+    })
+
+    it("signs transactions in the raw and the template mode", async () => {
+        const device = new SimulatedFioDevice()
+        const fio = new Fio(device)
+
+        const multiActionTx = {...tx, actions: [action, action]}
+        expectValidSignature(multiActionTx, await fio.signTransaction({path, chainId, tx: multiActionTx}))
+
+        // the first declares the template, the second reuses it
+        expectValidSignature(tx, await fio.signTransaction({path, chainId, tx}))
+        const apdusBefore = device.apduCount
+        const nextTx = {...tx, ref_block_num: 0x3344}
+        expectValidSignature(nextTx, await fio.signTransaction({path, chainId, tx: nextTx}))
+        // template tx (which returns the last response status), witness
+        expect(device.apduCount - apdusBefore).to.equal(2)
+    })
+
+    it("rejects what the device rejects", async () => {
+        const fio = new Fio(new SimulatedFioDevice({prompt: () => false}))
+
+        await expect(fio.signTransaction({path, chainId, tx}))
+            .to.be.rejectedWith(DeviceStatusError)
+            .and.eventually.have.property("code", DeviceStatusCodes.ERR_REJECTED_BY_USER)
+
+        const unknownChainId = "00".repeat(32)
+        await expect(fio.signTransaction({path, chainId: unknownChainId, tx}))
+            .to.be.rejectedWith(DeviceStatusError)
+            .and.eventually.have.property("code", DeviceStatusCodes.ERR_REJECTED_BY_POLICY)
+    })
+
+    it("confirms transactions the signing session does not cover", async () => {
+        let prompts = 0
+        const device = new SessionSimulatedFioDevice({prompt: () => ++prompts > 0})
+        const fio = new Fio(device)
+
+        const multiActionTx = {...tx, actions: [action, action]}
+        expectValidSignature(multiActionTx, await fio.signTransaction({path, chainId, tx: multiActionTx}))
+        expectValidSignature(tx, await fio.signTransaction({path, chainId, tx}))
+        // raw, then template, each retried outside the session
+        expect(device.signTxStarts).to.deep.equal([0x01, 0x03, 0x00, 0x02])
+        expect(prompts).to.equal(2)
+    })
+
+    it("does not retry policy rejections without a signing session", async () => {
+        const device = new SessionSimulatedFioDevice()
+        const fio = new Fio(device)
+        device.sessionActive = false
+
+        // signed in the raw mode
+        const multiActionTx = {...tx, actions: [action, action]}
+        const unknownChainId = "00".repeat(32)
+        await expect(fio.signTransaction({path, chainId: unknownChainId, tx: multiActionTx}))
+            .to.be.rejectedWith(DeviceStatusError)
+            .and.eventually.have.property("code", DeviceStatusCodes.ERR_REJECTED_BY_POLICY)
+        expect(device.signTxStarts).to.deep.equal([0x01])
+    })
+
+    it("refuses apps older than the raw signing mode", async () => {
+        const fio = new Fio(new SimulatedFioDevice({version: {major: 0, minor: 0, patch: 1, isDebug: false}}))
+
+        const {compatibility} = await fio.getVersion()
+        expect(compatibility).to.deep.equal({isCompatible: false, recommendedVersion: "0.1"})
+        await expect(fio.signTransaction({path, chainId, tx})).to.be.rejectedWith(DeviceVersionUnsupported)
+    })
+
+    it("recovers a lost signature without asking the user again", async () => {
+        let prompts = 0
+        const fio = new Fio(new LossySimulatedFioDevice({prompt: () => ++prompts > 0}))
+
+        expectValidSignature(tx, await fio.signTransaction({path, chainId, tx}))
+        expect(prompts).to.equal(1)
+    })
+})
@@ -0,0 +1,44 @@
+import chai, {expect} from "chai"
+import chaiAsPromised from "chai-as-promised"
+
+import {interact} from "../../src/fio"
+import type {SendParams} from "../../src/interactions/common/types"
+import {getStackUsage} from "../../src/interactions/getStackUsage"
+
+chai.use(chaiAsPromised)
+
+const version = {major: 0, minor: 1, patch: 0, flags: {isDebug: true}}
+
+// 1500 B of stack, the menu and a signed transaction so far
+const response = Buffer.from(
+    "05dc" + "02" +
+    "ff" + "0190" + "044c" +
+    "20" + "0514" + "00c8",
+    "hex",
+)
+
+describe("getStackUsage", () => {
+    it("parses the watermarks", async () => {
+        const sent: Array<SendParams> = []
+        const send = async (params: SendParams) => {
+            sent.push(params)
+            return response
+        }
+
+        const usage = await interact(getStackUsage(version, false), send)
+        expect(sent).to.have.length(1)
+        expect(sent[0]).to.include({ins: 0xf5, p1: 0x00, p2: 0x00})
+        expect(usage).to.deep.equal({
+            stackSize: 1500,
+            instructions: [
+                {ins: 0xff, maxUsed: 400, minFree: 1100},
+                {ins: 0x20, maxUsed: 1300, minFree: 200},
+            ],
+        })
+    })
+
+    it("rejects a truncated response", async () => {
+        const send = async () => response.slice(0, response.length - 2)
+        await expect(interact(getStackUsage(version, false), send)).to.be.rejected
+    })
+})
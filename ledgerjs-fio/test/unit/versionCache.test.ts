@@ -0,0 +1,72 @@
+import chai, {expect} from "chai"
+import chaiAsPromised from "chai-as-promised"
+
+import {DeviceStatusCodes, DeviceStatusError, Fio, HARDENED} from "../../src/fio"
+import {SimulatedFioDevice} from "../simulator/SimulatedFioDevice"
+
+chai.use(chaiAsPromised)
+
+const path = [44 + HARDENED, 235 + HARDENED, 0 + HARDENED, 0, 0]
+const INS_GET_VERSION = 0x00
+
+// counts the version requests, answers as another app while `otherApp` is set
+class CountingDevice extends SimulatedFioDevice {
+    versionRequests = 0
+    otherApp = false
+
+    async exchange(apdu: Buffer): Promise<Buffer> {
+        if (this.otherApp) {
+            return Buffer.from([0x6e, 0x00])
+        }
+        if (apdu[1] === INS_GET_VERSION) {
+            this.versionRequests++
+        }
+        return super.exchange(apdu)
+    }
+}
+
+describe("version cache", () => {
+    it("asks for the version only once", async () => {
+        const device = new CountingDevice()
+        const fio = new Fio(device)
+
+        await fio.getPublicKey({path, show_or_not: false})
+        await fio.getPublicKey({path, show_or_not: false})
+        await fio.getSerial()
+        expect(device.versionRequests).to.equal(1)
+    })
+
+    it("refreshes on an explicit getVersion", async () => {
+        const device = new CountingDevice()
+        const fio = new Fio(device)
+
+        await fio.getVersion()
+        await fio.getVersion()
+        await fio.getSerial()
+        expect(device.versionRequests).to.equal(2)
+    })
+
+    it("forgets the version when the transport disconnects", async () => {
+        const device = new CountingDevice()
+        const fio = new Fio(device)
+
+        await fio.getSerial()
+        device.emit("disconnect")
+        await fio.getSerial()
+        expect(device.versionRequests).to.equal(2)
+    })
+
+    it("forgets the version when another app is opened", async () => {
+        const device = new CountingDevice()
+        const fio = new Fio(device)
+
+        await fio.getSerial()
+        device.otherApp = true
+        await expect(fio.getSerial())
+            .to.be.rejectedWith(DeviceStatusError)
+            .and.eventually.have.property("code", DeviceStatusCodes.ERR_CLA_NOT_SUPPORTED)
+        device.otherApp = false
+        await fio.getSerial()
+        expect(device.versionRequests).to.equal(2)
+    })
+})